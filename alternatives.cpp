@@ -0,0 +1,311 @@
+#include "alternatives.hpp"
+
+#include <set>
+
+#include "thread_pool.hpp"
+
+// Remaining distance along the goal tree: exact on the unmodified grid, so consistent after
+// moves are removed or costs raised
+struct TreeHeuristic
+{
+    const GoalTree &tree;
+    std::array<int, 8> offsets;
+
+    float at(int cell) const { return tree.distance[static_cast<std::size_t>(cell)]; }
+    void successors(int cell, int, int, unsigned mask, float *out) const
+    {
+        for (; mask != 0; mask &= mask - 1)
+        {
+            const int d = __builtin_ctz(mask);
+            out[d] = tree.distance[static_cast<std::size_t>(cell + offsets[static_cast<std::size_t>(d)])];
+        }
+    }
+};
+
+// Yen's spur graph: the root path's cells are removed, and so are the moves out of the spur
+// cell that paths found earlier take after the same root
+struct SpurPruning
+{
+    const Grid &grid;
+    const std::vector<std::uint8_t> &blocked;
+    int spur;
+    unsigned spurMoves;
+    std::array<int, 8> offsets;
+
+    bool keeps(int cell) const { return !blocked[static_cast<std::size_t>(cell)]; }
+
+    unsigned moves(int cell) const
+    {
+        unsigned mask = grid.neighborMask(cell) & (cell == spur ? spurMoves : 0xFFu);
+        for (unsigned m = mask; m != 0; m &= m - 1)
+        {
+            const int d = __builtin_ctz(m);
+            if (!keeps(cell + offsets[static_cast<std::size_t>(d)]))
+                mask &= ~(1u << d);
+        }
+        return mask;
+    }
+};
+
+// Per-worker spur search state, kept across rounds
+struct SpurScratch
+{
+    SearchContext context;
+    std::vector<std::uint8_t> blocked;
+};
+
+// Direction of the move between two adjacent cells of a path
+static int moveDirection(const std::array<int, 8> &offsets, int from, int to)
+{
+    int d = 0;
+    while (d < 7 && offsets[static_cast<std::size_t>(d)] != to - from)
+        ++d;
+    return d;
+}
+
+template <typename Movement>
+static GoalTree buildTreeWith(const Grid &grid, int goal, SearchContext &context)
+{
+    GoalTree tree;
+    tree.goal = goal;
+    tree.distance.assign(static_cast<std::size_t>(grid.cellCount()), std::numeric_limits<float>::max());
+    tree.next.assign(static_cast<std::size_t>(grid.cellCount()), -1);
+    searchGridWith<Movement>(grid, goal, -1, context, ZeroHeuristic());
+    for (int cell = 0; cell < grid.cellCount(); ++cell)
+    {
+        tree.distance[static_cast<std::size_t>(cell)] = context.cost(cell);
+        if (tree.reaches(cell))
+            tree.next[static_cast<std::size_t>(cell)] = context.prev[static_cast<std::size_t>(cell)];
+    }
+    return tree;
+}
+
+GoalTree buildGoalTree(const Grid &grid, MovementModel movement, int goal, SearchContext &context)
+{
+    return withMovement(movement, [&](auto policy)
+                        { return buildTreeWith<decltype(policy)>(grid, goal, context); });
+}
+
+// Cells from cell to the tree's goal
+static void appendTreePath(const GoalTree &tree, int cell, std::vector<int> &cells)
+{
+    for (; cell != -1; cell = tree.next[static_cast<std::size_t>(cell)])
+        cells.push_back(cell);
+}
+
+// Runs the spur searches for spur indices [begin, end) of the last path found. Cells before the
+// spur index are blocked as the root grows, so each range marks its root only once.
+template <typename Movement>
+static void searchSpurs(const Grid &grid, const GoalTree &tree, const std::vector<AlternativePath> &paths, const std::vector<float> &rootCosts,
+                        int begin, int end, SpurScratch &scratch, std::vector<AlternativePath> &found)
+{
+    const std::array<int, 8> offsets = neighborOffsets(grid.width);
+    const std::vector<int> &last = paths.back().cells;
+    scratch.blocked.resize(static_cast<std::size_t>(grid.cellCount()), 0);
+    for (int i = 0; i < begin; ++i)
+        scratch.blocked[static_cast<std::size_t>(last[static_cast<std::size_t>(i)])] = 1;
+
+    for (int i = begin; i < end; ++i)
+    {
+        const int spur = last[static_cast<std::size_t>(i)];
+        unsigned spurMoves = Movement::moves(grid.neighborMask(spur));
+        for (const AlternativePath &path : paths)
+        {
+            if (path.cells.size() > static_cast<std::size_t>(i + 1) && std::equal(last.begin(), last.begin() + i + 1, path.cells.begin()))
+                spurMoves &= ~(1u << moveDirection(offsets, spur, path.cells[static_cast<std::size_t>(i + 1)]));
+        }
+
+        // The tree path is a shortest spur path whenever the spur graph still contains it
+        bool treeOpen = spurMoves >> moveDirection(offsets, spur, tree.next[static_cast<std::size_t>(spur)]) & 1u;
+        for (int cell = tree.next[static_cast<std::size_t>(spur)]; treeOpen && cell != -1; cell = tree.next[static_cast<std::size_t>(cell)])
+            treeOpen = !scratch.blocked[static_cast<std::size_t>(cell)];
+
+        AlternativePath &candidate = found[static_cast<std::size_t>(i)];
+        candidate.cells.assign(last.begin(), last.begin() + i);
+        if (treeOpen)
+        {
+            appendTreePath(tree, spur, candidate.cells);
+            candidate.cost = rootCosts[static_cast<std::size_t>(i)] + tree.distance[static_cast<std::size_t>(spur)];
+        }
+        else
+        {
+            const SpurPruning pruning{grid, scratch.blocked, spur, spurMoves, offsets};
+            const SearchResult result = searchGridPruned<Movement>(grid, spur, tree.goal, scratch.context, TreeHeuristic{tree, offsets}, pruning);
+            if (result.found)
+            {
+                const int length = pathLength(scratch.context, tree.goal);
+                candidate.cells.resize(static_cast<std::size_t>(i + length));
+                writePath(scratch.context, tree.goal, candidate.cells.data() + i, length);
+                candidate.cost = rootCosts[static_cast<std::size_t>(i)] + result.cost;
+            }
+            else
+                candidate.cells.clear();
+        }
+        scratch.blocked[static_cast<std::size_t>(spur)] = 1;
+    }
+    for (int i = 0; i < end; ++i)
+        scratch.blocked[static_cast<std::size_t>(last[static_cast<std::size_t>(i)])] = 0;
+}
+
+template <typename Movement>
+static std::vector<AlternativePath> kShortestWith(const Grid &grid, int start, int goal, int count, unsigned threads)
+{
+    std::vector<AlternativePath> paths;
+    SearchContext treeContext;
+    const GoalTree tree = buildTreeWith<Movement>(grid, goal, treeContext);
+    if (count <= 0 || !tree.reaches(start))
+        return paths;
+    paths.emplace_back();
+    appendTreePath(tree, start, paths.back().cells);
+    paths.back().cost = tree.distance[static_cast<std::size_t>(start)];
+
+    const std::array<int, 8> offsets = neighborOffsets(grid.width);
+    const unsigned workers = std::max(1u, threads);
+    ThreadPool pool(workers);
+    std::vector<SpurScratch> scratch(workers);
+    std::vector<AlternativePath> candidates; // Min-heap on cost
+    auto costlier = [](const AlternativePath &a, const AlternativePath &b)
+    { return a.cost > b.cost; };
+    std::set<std::vector<int>> seen{paths.back().cells};
+
+    while (static_cast<int>(paths.size()) < count)
+    {
+        // Every cell but the goal of the last path is a spur; each worker takes a range of them
+        const std::vector<int> &last = paths.back().cells;
+        const int spurs = static_cast<int>(last.size()) - 1;
+        std::vector<float> rootCosts(static_cast<std::size_t>(std::max(spurs, 1)), 0.0f);
+        for (int i = 1; i < spurs; ++i)
+            rootCosts[static_cast<std::size_t>(i)] = rootCosts[static_cast<std::size_t>(i - 1)] +
+                                                     DIRECTION_COSTS[moveDirection(offsets, last[static_cast<std::size_t>(i - 1)], last[static_cast<std::size_t>(i)])];
+        std::vector<AlternativePath> found(static_cast<std::size_t>(std::max(spurs, 0)));
+        const int chunk = (spurs + static_cast<int>(workers) - 1) / static_cast<int>(workers);
+        for (int begin = 0, worker = 0; begin < spurs; begin += chunk, ++worker)
+        {
+            const int end = std::min(spurs, begin + chunk);
+            pool.submit([&, begin, end, worker]()
+                        { searchSpurs<Movement>(grid, tree, paths, rootCosts, begin, end, scratch[static_cast<std::size_t>(worker)], found); });
+        }
+        pool.wait();
+
+        for (AlternativePath &candidate : found)
+        {
+            if (candidate.cells.empty() || !seen.insert(candidate.cells).second)
+                continue;
+            candidates.push_back(std::move(candidate));
+            std::push_heap(candidates.begin(), candidates.end(), costlier);
+        }
+        if (candidates.empty())
+            break;
+        std::pop_heap(candidates.begin(), candidates.end(), costlier);
+        paths.push_back(std::move(candidates.back()));
+        candidates.pop_back();
+    }
+    return paths;
+}
+
+std::vector<AlternativePath> findKShortestPaths(const Grid &grid, MovementModel movement, int start, int goal, int count, unsigned threads)
+{
+    return withMovement(movement, [&](auto policy)
+                        { return kShortestWith<decltype(policy)>(grid, start, goal, count, threads); });
+}
+
+// A* where entering a cell costs the move times the cell's weight (all weights >= 1)
+template <typename Movement>
+static SearchResult searchWeighted(const Grid &grid, const GoalTree &tree, const std::vector<float> &weights, int start, SearchContext &context)
+{
+    SearchResult result;
+    const std::array<int, 8> offsets = neighborOffsets(grid.width);
+    context.begin(grid.cellCount());
+    context.set(start, 0.0f, -1);
+    context.push(tree.distance[static_cast<std::size_t>(start)], start);
+    while (!context.open.empty())
+    {
+        const int cell = openEntryCell(context.pop());
+        if (!context.close(cell))
+            continue;
+        ++result.expanded;
+        const float cg = context.g[static_cast<std::size_t>(cell)];
+        if (cell == tree.goal)
+        {
+            result.found = true;
+            result.cost = cg;
+            break;
+        }
+        for (unsigned moves = Movement::moves(grid.neighborMask(cell)); moves != 0; moves &= moves - 1)
+        {
+            const int d = __builtin_ctz(moves);
+            const int next = cell + offsets[static_cast<std::size_t>(d)];
+            const float ng = cg + DIRECTION_COSTS[d] * weights[static_cast<std::size_t>(next)];
+            if (ng < context.cost(next))
+            {
+                context.set(next, ng, cell);
+                context.push(ng + tree.distance[static_cast<std::size_t>(next)], next);
+            }
+        }
+    }
+    return result;
+}
+
+template <typename Movement>
+static std::vector<AlternativePath> diverseWith(const Grid &grid, int start, int goal, int count, float penalty)
+{
+    std::vector<AlternativePath> paths;
+    SearchContext context;
+    const GoalTree tree = buildTreeWith<Movement>(grid, goal, context);
+    if (count <= 0 || !tree.reaches(start))
+        return paths;
+
+    // The first path comes straight from the tree; penalized searches may return a path found
+    // before, so they get a few extra attempts
+    const std::array<int, 8> offsets = neighborOffsets(grid.width);
+    std::vector<float> weights(static_cast<std::size_t>(grid.cellCount()), 1.0f);
+    std::set<std::vector<int>> seen;
+    std::vector<int> cells;
+    appendTreePath(tree, start, cells);
+    for (int attempt = 0; attempt < 3 * count && static_cast<int>(paths.size()) < count; ++attempt)
+    {
+        if (attempt > 0)
+        {
+            if (!searchWeighted<Movement>(grid, tree, weights, start, context).found)
+                break;
+            cells.resize(static_cast<std::size_t>(pathLength(context, goal)));
+            writePath(context, goal, cells.data(), static_cast<int>(cells.size()));
+        }
+        if (seen.insert(cells).second)
+        {
+            AlternativePath path;
+            path.cells = cells;
+            for (std::size_t i = 1; i < cells.size(); ++i)
+                path.cost += DIRECTION_COSTS[moveDirection(offsets, cells[i - 1], cells[i])];
+            paths.push_back(std::move(path));
+        }
+        // Every path starts and ends on the same cells, so only the cells between are penalized
+        for (std::size_t i = 1; i + 1 < cells.size(); ++i)
+            weights[static_cast<std::size_t>(cells[i])] *= penalty;
+    }
+    return paths;
+}
+
+std::vector<AlternativePath> findDiversePaths(const Grid &grid, MovementModel movement, int start, int goal, int count, float penalty)
+{
+    return withMovement(movement, [&](auto policy)
+                        { return diverseWith<decltype(policy)>(grid, start, goal, count, penalty); });
+}
+
+float pathCost(const Grid &grid, MovementModel movement, const std::vector<int> &cells)
+{
+    return withMovement(movement, [&](auto policy)
+                        {
+                            float cost = 0.0f;
+                            for (std::size_t i = 1; i < cells.size(); ++i)
+                            {
+                                const int dx = cells[i] % grid.width - cells[i - 1] % grid.width, dy = cells[i] / grid.width - cells[i - 1] / grid.width;
+                                int d = 0;
+                                while (d < 8 && (directions[static_cast<std::size_t>(d)].x != dx || directions[static_cast<std::size_t>(d)].y != dy))
+                                    ++d;
+                                if (d == 8 || !(decltype(policy)::moves(grid.neighborMask(cells[i - 1])) >> d & 1u))
+                                    return -1.0f;
+                                cost += DIRECTION_COSTS[d];
+                            }
+                            return cost; });
+}
@@ -0,0 +1,46 @@
+// Alternative routes between one start and goal, for spreading traffic over several good paths.
+// Yen's algorithm enumerates the K shortest loopless paths exactly; the penalty method is a
+// faster generator of diverse paths that re-searches after inflating the cost of every cell on
+// the paths found so far.
+//
+// Both start with one backward Dijkstra from the goal and keep its tree for the whole query.
+// The tree's distances are exact on the unmodified grid, so they are a consistent heuristic for
+// every later search (which only removes moves or raises costs), and a Yen spur node whose tree
+// path avoids the blocked cells and moves takes that path without searching at all.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "pathfinding.hpp"
+
+struct AlternativePath
+{
+    std::vector<int> cells; // Start to goal inclusive
+    float cost = 0.0f;      // Unpenalized cost
+};
+
+// Shortest-path tree towards one goal: distance to it and the next cell on the way, per cell
+struct GoalTree
+{
+    int goal = -1;
+    std::vector<float> distance; // max() where the goal is unreachable
+    std::vector<int> next;       // -1 at the goal and where it is unreachable
+
+    bool reaches(int cell) const { return distance[static_cast<std::size_t>(cell)] != std::numeric_limits<float>::max(); }
+};
+
+// Dijkstra from goal over the whole reachable area. Moves are symmetric under every movement
+// model, so the tree searched outwards from the goal also leads towards it.
+GoalTree buildGoalTree(const Grid &grid, MovementModel movement, int goal, SearchContext &context);
+
+// Up to count shortest loopless paths in order of cost. The spur searches of each round run on
+// threads workers.
+std::vector<AlternativePath> findKShortestPaths(const Grid &grid, MovementModel movement, int start, int goal, int count, unsigned threads);
+
+// Up to count distinct paths; after each one, the step cost into every cell on it is
+// multiplied by penalty (> 1). The first path is a shortest path.
+std::vector<AlternativePath> findDiversePaths(const Grid &grid, MovementModel movement, int start, int goal, int count, float penalty = 1.4f);
+
+// Cost of moving along cells, or -1 if two consecutive cells are not a legal move
+float pathCost(const Grid &grid, MovementModel movement, const std::vector<int> &cells);
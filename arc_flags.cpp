@@ -0,0 +1,84 @@
+#include "arc_flags.hpp"
+
+#include <cmath>
+
+#include "thread_pool.hpp"
+
+// Flags every region-internal move, then every move on a shortest path to each cell where a
+// move from outside enters the region. A shortest path into the region last enters it at
+// such a cell and stays inside afterwards, so all its moves end up flagged.
+template <typename Movement>
+static void flagRegion(const Grid &grid, const ArcFlags &arcFlags, int region, std::uint8_t *table)
+{
+    const int W = grid.width;
+    const std::array<int, 8> offsets = neighborOffsets(W);
+    std::vector<int> entries;
+    for (int cell = 0; cell < grid.cellCount(); ++cell)
+    {
+        const int x = cell % W, y = cell / W;
+        if (arcFlags.regionOf(x, y) != region)
+            continue;
+        // Moves are symmetric, so the moves out of a cell also name the cells that can step into it
+        unsigned moves = Movement::moves(grid.neighborMask(cell));
+        bool entry = false;
+        for (unsigned m = moves; m != 0; m &= m - 1)
+        {
+            const int d = __builtin_ctz(m);
+            if (arcFlags.regionOf(x + DIRECTION_DX[d], y + DIRECTION_DY[d]) == region)
+                table[cell] = static_cast<std::uint8_t>(table[cell] | 1u << d);
+            else
+                entry = true;
+        }
+        if (entry)
+            entries.push_back(cell);
+    }
+
+    // Distances from an entry cell equal distances to it; a move u -> v is on a shortest path
+    // to it when d(u) = cost + d(v). The tolerance only admits extra flags, never drops one.
+    SearchContext context;
+    for (int entry : entries)
+    {
+        searchGridWith<Movement>(grid, entry, -1, context, ZeroHeuristic());
+        for (int cell = 0; cell < grid.cellCount(); ++cell)
+        {
+            const float distance = context.cost(cell);
+            if (distance == std::numeric_limits<float>::max() || cell == entry)
+                continue;
+            const float tolerance = 1e-4f * (1.0f + distance);
+            for (unsigned m = Movement::moves(grid.neighborMask(cell)); m != 0; m &= m - 1)
+            {
+                const int d = __builtin_ctz(m);
+                if (DIRECTION_COSTS[d] + context.cost(cell + offsets[static_cast<std::size_t>(d)]) <= distance + tolerance)
+                    table[cell] = static_cast<std::uint8_t>(table[cell] | 1u << d);
+            }
+        }
+    }
+}
+
+ArcFlags buildArcFlags(const Grid &grid, MovementModel movement, int regions, unsigned threads)
+{
+    ArcFlags arcFlags;
+    arcFlags.movement = movement;
+    arcFlags.width = grid.width;
+    arcFlags.height = grid.height;
+
+    // Columns in proportion to the map's aspect ratio, so regions come out near-square
+    regions = std::max(1, std::min(regions, grid.cellCount()));
+    const double aspect = static_cast<double>(grid.width) / grid.height;
+    arcFlags.columns = std::max(1, std::min({regions, grid.width, static_cast<int>(std::lround(std::sqrt(regions * aspect)))}));
+    arcFlags.rows = std::max(1, std::min(regions / arcFlags.columns, grid.height));
+    arcFlags.flags.assign(static_cast<std::size_t>(arcFlags.regionCount()) * static_cast<std::size_t>(grid.cellCount()), 0);
+
+    // Each region owns its own table, so workers never share a byte
+    ThreadPool pool(std::min<unsigned>(threads, static_cast<unsigned>(arcFlags.regionCount())));
+    for (int region = 0; region < arcFlags.regionCount(); ++region)
+    {
+        pool.submit([&grid, &arcFlags, region, movement]()
+                    {
+                        std::uint8_t *table = arcFlags.flags.data() + static_cast<std::size_t>(region) * static_cast<std::size_t>(grid.cellCount());
+                        withMovement(movement, [&](auto policy)
+                                     { flagRegion<decltype(policy)>(grid, arcFlags, region, table); }); });
+    }
+    pool.wait();
+    return arcFlags;
+}
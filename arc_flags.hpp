@@ -0,0 +1,58 @@
+// Arc flags for static maps, a lighter alternative to goal bounding. The map is tiled into K
+// rectangular regions and every move out of every cell carries K flags; flag r is set when the
+// move lies on some shortest path into region r. A query looks up the goal's region once and
+// relaxes only flagged moves, which is one AND with the cell's flag byte for that region.
+// The table takes K bytes per cell (8 moves x K bits), so K follows directly from a memory budget.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "pathfinding.hpp"
+
+struct ArcFlags
+{
+    MovementModel movement = MovementModel::CornerCutting;
+    int width = 0, height = 0;
+    int columns = 0, rows = 0;       // Region tiling; regions are numbered row-major
+    std::vector<std::uint8_t> flags; // Per region, one move mask per cell
+
+    int regionCount() const { return columns * rows; }
+    int regionOf(int x, int y) const { return y * rows / height * columns + x * columns / width; }
+    const std::uint8_t *table(int region) const { return flags.data() + static_cast<std::size_t>(region) * static_cast<std::size_t>(width * height); }
+    std::size_t memoryBytes() const { return flags.size(); }
+    bool valid(const Grid &grid, MovementModel model) const
+    {
+        return !flags.empty() && width == grid.width && height == grid.height && movement == model;
+    }
+};
+
+// Largest region count whose table fits in budgetBytes (at least 1)
+inline int arcFlagRegionsForBudget(const Grid &grid, std::size_t budgetBytes)
+{
+    return static_cast<int>(std::max<std::size_t>(1, budgetBytes / static_cast<std::size_t>(std::max(1, grid.cellCount()))));
+}
+
+// Tiles the map into at most regions near-square regions and sets the flags with one backward
+// Dijkstra per region boundary cell; regions are processed in parallel on threads workers.
+// Wall edits invalidate the table; it has to be rebuilt.
+ArcFlags buildArcFlags(const Grid &grid, MovementModel movement, int regions, unsigned threads);
+
+// Keeps the moves flagged for the goal's region
+struct ArcFlagPruning
+{
+    const std::uint8_t *table;
+
+    unsigned moves(int cell) const { return table[cell]; }
+};
+
+// A* over flagged moves only; exact, since every move of some shortest path into the goal's
+// region keeps its flag
+template <typename Movement, typename Trace = NullSearchTrace>
+SearchResult searchArcFlags(const Grid &grid, const ArcFlags &arcFlags, int start, int goal, SearchContext &context,
+                            Trace &&trace = Trace())
+{
+    const std::uint8_t *table = arcFlags.table(arcFlags.regionOf(goal % grid.width, goal / grid.width));
+    return searchGridPruned<Movement>(grid, start, goal, context, typename Movement::Distance(grid, goal), ArcFlagPruning{table},
+                                      std::forward<Trace>(trace));
+}
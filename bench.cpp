@@ -0,0 +1,983 @@
+// Offline benchmarks of the engine's search variants against plain A* on the same queries.
+// Maps come from a text file or a generated warehouse layout (shelf rows, aisles, open staging area).
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "alternatives.hpp"
+#include "arc_flags.hpp"
+#include "clearance.hpp"
+#include "dead_ends.hpp"
+#include "goal_bounds.hpp"
+#include "lattice.hpp"
+#include "multi_target.hpp"
+#include "navmesh.hpp"
+#include "pathfinding.hpp"
+#include "rsr.hpp"
+#include "subgoals.hpp"
+#include "time_costs.hpp"
+#include "topology.hpp"
+#include "voxels.hpp"
+
+struct BenchOptions
+{
+    std::string mode;
+    std::string mapPath; // Generated warehouse if empty
+    int width = 256;
+    int height = 256;
+    int queries = 200;
+    unsigned seed = 1;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    MovementModel movement = MovementModel::CornerCutting;
+    int edits = 0; // Random wall toggles applied before a second round of queries (subgoal, dead-end and clearance modes)
+    int regions = 16;       // Arc flag regions (arcflags mode)
+    std::size_t budget = 0; // Arc flag table bytes; when set, picks the region count instead (arcflags mode)
+    int paths = 4;          // Alternatives per query (alternatives mode)
+    int targets = 100;      // Targets per nearest-target query (targets mode)
+    int depth = 16;         // Layers of the voxel map (voxels mode)
+    std::string boundsPath; // Goal bounds file mapped if it matches the map, else built and written (goalbounds mode)
+};
+
+// Shelf rows two cells deep separated by aisles, cross aisles every 24 columns,
+// and an open staging area along the bottom fifth of the map
+static Grid makeWarehouse(int width, int height)
+{
+    Grid grid(width, height);
+    const int shelvesEnd = height - height / 5;
+    for (int y = 3; y + 1 < shelvesEnd; y += 5)
+    {
+        for (int x = 3; x < width - 3; ++x)
+        {
+            if (x % 24 < 3)
+                continue; // Cross aisle
+            grid.setWall(x, y, true);
+            grid.setWall(x, y + 1, true);
+        }
+    }
+    return grid;
+}
+
+static std::vector<std::pair<int, int>> randomQueries(const Grid &grid, int count, unsigned seed)
+{
+    std::vector<int> freeCells;
+    for (int cell = 0; cell < grid.cellCount(); ++cell)
+    {
+        if (!grid.walls[static_cast<std::size_t>(cell)])
+            freeCells.push_back(cell);
+    }
+    std::vector<std::pair<int, int>> queries;
+    if (freeCells.empty())
+        return queries;
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<std::size_t> pick(0, freeCells.size() - 1);
+    for (int i = 0; i < count; ++i)
+        queries.emplace_back(freeCells[pick(rng)], freeCells[pick(rng)]);
+    return queries;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Totals over a query set for one search variant
+struct BenchTotals
+{
+    std::uint64_t expanded = 0;
+    double seconds = 0.0;
+    int found = 0;
+    std::vector<float> costs;
+};
+
+template <typename Search>
+static BenchTotals runQueries(const std::vector<std::pair<int, int>> &queries, Search &&search)
+{
+    BenchTotals totals;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &query : queries)
+    {
+        SearchResult result = search(query.first, query.second);
+        totals.expanded += result.expanded;
+        totals.found += result.found ? 1 : 0;
+        totals.costs.push_back(result.found ? result.cost : -1.0f);
+    }
+    totals.seconds = secondsSince(start);
+    return totals;
+}
+
+static int countMismatches(const BenchTotals &expected, const BenchTotals &actual)
+{
+    int mismatches = 0;
+    for (std::size_t i = 0; i < expected.costs.size(); ++i)
+    {
+        if (std::abs(expected.costs[i] - actual.costs[i]) > 1e-3f)
+            ++mismatches;
+    }
+    return mismatches;
+}
+
+static void printComparison(const char *name, const BenchTotals &baseline, const BenchTotals &variant, std::size_t queries)
+{
+    double perQuery = queries ? 1.0 / static_cast<double>(queries) : 0.0;
+    std::printf("%-8s expanded/query=%10.1f  us/query=%9.1f\n", "astar", static_cast<double>(baseline.expanded) * perQuery,
+                baseline.seconds * 1e6 * perQuery);
+    std::printf("%-8s expanded/query=%10.1f  us/query=%9.1f\n", name, static_cast<double>(variant.expanded) * perQuery,
+                variant.seconds * 1e6 * perQuery);
+    std::printf("expansion reduction: %.1f%%, speedup: %.2fx, cost mismatches: %d of %zu\n",
+                baseline.expanded ? 100.0 * (1.0 - static_cast<double>(variant.expanded) / static_cast<double>(baseline.expanded)) : 0.0,
+                variant.seconds > 0 ? baseline.seconds / variant.seconds : 0.0, countMismatches(baseline, variant), queries);
+}
+
+static int benchRsr(const Grid &grid, const BenchOptions &options)
+{
+    auto buildStart = std::chrono::steady_clock::now();
+    RectangleDecomposition decomposition = decomposeRectangles(grid, options.threads);
+    double buildSeconds = secondsSince(buildStart);
+    std::size_t interiorCells = 0;
+    for (int cell = 0; cell < grid.cellCount(); ++cell)
+        interiorCells += decomposition.interior(cell) ? 1 : 0;
+    std::printf("rectangles: %zu, interior cells pruned: %zu of %d, decomposition: %.2f ms on %u threads\n",
+                decomposition.rects.size(), interiorCells, grid.cellCount(), buildSeconds * 1e3, options.threads);
+
+    auto queries = randomQueries(grid, options.queries, options.seed);
+    SearchContext context;
+    BenchTotals astar = runQueries(queries, [&](int start, int goal)
+                                   { return searchGrid(grid, Algorithm::AStar, options.movement, start, goal, context); });
+    BenchTotals rsr = runQueries(queries, [&](int start, int goal)
+                                 { return withMovement(options.movement, [&](auto policy)
+                                                       { return searchRsr<decltype(policy)>(grid, decomposition, start, goal, context); }); });
+    printComparison("rsr", astar, rsr, queries.size());
+    return countMismatches(astar, rsr) == 0 ? 0 : 1;
+}
+
+// True if the segment stays on free cells; sampled finely enough that it cannot skip a cell
+static bool segmentClear(const Grid &grid, NavPoint a, NavPoint b)
+{
+    const int samples = static_cast<int>(std::ceil(std::hypot(b.x - a.x, b.y - a.y) * 8.0f)) + 1;
+    for (int i = 0; i <= samples; ++i)
+    {
+        float t = static_cast<float>(i) / static_cast<float>(samples);
+        float x = a.x + (b.x - a.x) * t, y = a.y + (b.y - a.y) * t;
+        // Points exactly on a cell border belong to either side; only walls on both sides block them
+        int x0 = static_cast<int>(std::floor(x - 1e-3f)), x1 = static_cast<int>(std::floor(x + 1e-3f));
+        int y0 = static_cast<int>(std::floor(y - 1e-3f)), y1 = static_cast<int>(std::floor(y + 1e-3f));
+        bool free = false;
+        for (int cy : {y0, y1})
+            for (int cx : {x0, x1})
+                free = free || (grid.inBounds(cx, cy) && !grid.isWall(cx, cy));
+        if (!free)
+            return false;
+    }
+    return true;
+}
+
+static int benchNavMesh(const Grid &grid, const BenchOptions &options)
+{
+    auto buildStart = std::chrono::steady_clock::now();
+    NavMesh mesh = buildNavMesh(grid, options.movement, options.threads);
+    double buildSeconds = secondsSince(buildStart);
+    std::printf("polygons: %d, portals: %zu, mesh: %zu bytes (grid: %d cells), build: %.2f ms on %u threads\n",
+                mesh.polygonCount(), mesh.portals.size(), mesh.memoryBytes(), grid.cellCount(), buildSeconds * 1e3, options.threads);
+
+    auto queries = randomQueries(grid, options.queries, options.seed);
+    SearchContext context;
+    std::vector<NavPoint> path;
+    int blocked = 0;
+    BenchTotals astar = runQueries(queries, [&](int start, int goal)
+                                   { return searchGrid(grid, Algorithm::AStar, options.movement, start, goal, context); });
+    BenchTotals navmesh = runQueries(queries, [&](int start, int goal)
+                                     { return findNavMeshPath(mesh, start, goal, context, path); });
+    for (const auto &query : queries)
+    {
+        findNavMeshPath(mesh, query.first, query.second, context, path);
+        for (std::size_t i = 1; i < path.size(); ++i)
+            blocked += segmentClear(grid, path[i - 1], path[i]) ? 0 : 1;
+    }
+
+    double perQuery = queries.empty() ? 0.0 : 1.0 / static_cast<double>(queries.size());
+    double gridLength = 0.0, meshLength = 0.0;
+    for (std::size_t i = 0; i < queries.size(); ++i)
+    {
+        if (astar.costs[i] >= 0.0f && navmesh.costs[i] >= 0.0f)
+        {
+            gridLength += astar.costs[i];
+            meshLength += navmesh.costs[i];
+        }
+    }
+    std::printf("%-8s expanded/query=%10.1f  us/query=%9.1f\n", "astar", static_cast<double>(astar.expanded) * perQuery, astar.seconds * 1e6 * perQuery);
+    std::printf("%-8s expanded/query=%10.1f  us/query=%9.1f\n", "navmesh", static_cast<double>(navmesh.expanded) * perQuery,
+                navmesh.seconds * 1e6 * perQuery);
+    std::printf("speedup: %.2fx, length vs grid path: %.3f, reachability mismatches: %d, blocked segments: %d\n",
+                navmesh.seconds > 0 ? astar.seconds / navmesh.seconds : 0.0, gridLength > 0 ? meshLength / gridLength : 0.0,
+                astar.found - navmesh.found, blocked);
+    return blocked == 0 && astar.found == navmesh.found ? 0 : 1;
+}
+
+static BenchTotals runSubgoalQueries(const Grid &grid, const SubgoalGraph &graph, const std::vector<std::pair<int, int>> &queries,
+                                     MovementModel movement, SearchContext &context)
+{
+    return runQueries(queries, [&](int start, int goal)
+                      { return withMovement(movement, [&](auto policy)
+                                            { return searchSubgoalGraph<decltype(policy)>(grid, graph, start, goal, context); }); });
+}
+
+static int benchSubgoals(Grid &grid, const BenchOptions &options)
+{
+    auto queries = randomQueries(grid, options.queries, options.seed);
+    SearchContext context;
+    BenchTotals astar = runQueries(queries, [&](int start, int goal)
+                                   { return searchGrid(grid, Algorithm::AStar, options.movement, start, goal, context); });
+    int mismatches = 0;
+    for (bool twoLevel : {false, true})
+    {
+        auto buildStart = std::chrono::steady_clock::now();
+        SubgoalGraph graph = buildSubgoalGraph(grid, options.movement, twoLevel, options.threads);
+        double buildSeconds = secondsSince(buildStart);
+        std::size_t edges = 0;
+        for (std::size_t s = 0; s < graph.cells.size(); ++s)
+            edges += graph.edges[s].size() + graph.shortcuts[s].size();
+        std::printf("%s: %d subgoals (%d global), %zu edges, build: %.2f ms on %u threads\n", twoLevel ? "two-level" : "simple",
+                    graph.subgoalCount(), graph.globalCount(), edges, buildSeconds * 1e3, options.threads);
+        BenchTotals subgoals = runSubgoalQueries(grid, graph, queries, options.movement, context);
+        printComparison(twoLevel ? "tsg" : "ssg", astar, subgoals, queries.size());
+        mismatches += countMismatches(astar, subgoals);
+        if (options.edits == 0)
+            continue;
+
+        // Toggle random cells with local repair, then check the repaired graph against A* on the edited map
+        Grid edited = grid;
+        std::mt19937 rng(options.seed + 1);
+        std::uniform_int_distribution<int> pickCell(0, grid.cellCount() - 1);
+        auto updateStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < options.edits; ++i)
+        {
+            int cell = pickCell(rng);
+            int x = cell % grid.width, y = cell / grid.width;
+            edited.setWall(x, y, !edited.isWall(x, y));
+            updateSubgoalGraph(edited, graph, x, y);
+        }
+        double updateSeconds = secondsSince(updateStart);
+        auto editedQueries = randomQueries(edited, options.queries, options.seed + 2);
+        BenchTotals editedAstar = runQueries(editedQueries, [&](int start, int goal)
+                                             { return searchGrid(edited, Algorithm::AStar, options.movement, start, goal, context); });
+        BenchTotals repaired = runSubgoalQueries(edited, graph, editedQueries, options.movement, context);
+        std::printf("%d edits: %.3f ms per local repair (full build %.2f ms), cost mismatches after repair: %d\n", options.edits,
+                    updateSeconds * 1e3 / options.edits, buildSeconds * 1e3, countMismatches(editedAstar, repaired));
+        mismatches += countMismatches(editedAstar, repaired);
+    }
+    return mismatches == 0 ? 0 : 1;
+}
+
+static int benchGoalBounds(const Grid &grid, const BenchOptions &options)
+{
+    GoalBounds bounds;
+    if (!options.boundsPath.empty() && mapGoalBounds(options.boundsPath, bounds) && bounds.valid(grid, options.movement))
+        std::printf("goal bounds: mapped %s, %zu bytes\n", options.boundsPath.c_str(), bounds.memoryBytes());
+    else
+    {
+        auto buildStart = std::chrono::steady_clock::now();
+        bounds = buildGoalBounds(grid, options.movement, options.threads);
+        std::printf("goal bounds: %zu bytes, build: %.2f s on %u threads\n", bounds.memoryBytes(), secondsSince(buildStart), options.threads);
+        if (!bounds.valid(grid, options.movement))
+        {
+            std::cerr << "Map too large for 16-bit goal bounds\n";
+            return 1;
+        }
+        if (!options.boundsPath.empty() && !saveGoalBounds(bounds, options.boundsPath))
+            std::cerr << "Failed to write " << options.boundsPath << "\n";
+    }
+
+    auto queries = randomQueries(grid, options.queries, options.seed);
+    SearchContext context;
+    BenchTotals astar = runQueries(queries, [&](int start, int goal)
+                                   { return searchGrid(grid, Algorithm::AStar, options.movement, start, goal, context); });
+    BenchTotals bounded = runQueries(queries, [&](int start, int goal)
+                                     { return withMovement(options.movement, [&](auto policy)
+                                                           { return searchGoalBounded<decltype(policy)>(grid, bounds, start, goal, context); }); });
+    printComparison("bounded", astar, bounded, queries.size());
+    return countMismatches(astar, bounded) == 0 ? 0 : 1;
+}
+
+static int benchArcFlags(const Grid &grid, const BenchOptions &options)
+{
+    const int regions = options.budget > 0 ? arcFlagRegionsForBudget(grid, options.budget) : options.regions;
+    auto buildStart = std::chrono::steady_clock::now();
+    ArcFlags arcFlags = buildArcFlags(grid, options.movement, regions, options.threads);
+    std::printf("arc flags: %d regions (%dx%d), %zu bytes, build: %.2f s on %u threads\n", arcFlags.regionCount(), arcFlags.columns,
+                arcFlags.rows, arcFlags.memoryBytes(), secondsSince(buildStart), options.threads);
+
+    auto queries = randomQueries(grid, options.queries, options.seed);
+    SearchContext context;
+    BenchTotals astar = runQueries(queries, [&](int start, int goal)
+                                   { return searchGrid(grid, Algorithm::AStar, options.movement, start, goal, context); });
+    BenchTotals flagged = runQueries(queries, [&](int start, int goal)
+                                     { return withMovement(options.movement, [&](auto policy)
+                                                           { return searchArcFlags<decltype(policy)>(grid, arcFlags, start, goal, context); }); });
+    printComparison("arcflags", astar, flagged, queries.size());
+    return countMismatches(astar, flagged) == 0 ? 0 : 1;
+}
+
+// A*, RSR and subgoal graph queries with and without dead-end pruning; mismatches against plain A*
+static int compareDeadEndPruning(const Grid &grid, const DeadEnds &deadEnds, const SubgoalGraph &graph, const BenchOptions &options,
+                                 unsigned seed)
+{
+    auto queries = randomQueries(grid, options.queries, seed);
+    SearchContext context;
+    RectangleDecomposition decomposition = decomposeRectangles(grid, options.threads);
+    BenchTotals astar = runQueries(queries, [&](int start, int goal)
+                                   { return searchGrid(grid, Algorithm::AStar, options.movement, start, goal, context); });
+    BenchTotals pruned = runQueries(queries, [&](int start, int goal)
+                                    { return searchGridSkippingDeadEnds(grid, deadEnds, Algorithm::AStar, start, goal, context); });
+    printComparison("dead-end", astar, pruned, queries.size());
+    int mismatches = countMismatches(astar, pruned);
+    withMovement(options.movement, [&](auto policy)
+                 {
+                     using Movement = decltype(policy);
+                     BenchTotals rsr = runQueries(queries, [&](int start, int goal)
+                                                  { return searchRsr<Movement>(grid, decomposition, start, goal, context); });
+                     BenchTotals rsrPruned = runQueries(queries, [&](int start, int goal)
+                                                        { return searchRsrPruned<Movement>(grid, decomposition, start, goal, context,
+                                                                                           DeadEndPruning(deadEnds, start, goal)); });
+                     BenchTotals subgoals = runQueries(queries, [&](int start, int goal)
+                                                       { return searchSubgoalGraph<Movement>(grid, graph, start, goal, context); });
+                     BenchTotals subgoalsPruned = runQueries(queries, [&](int start, int goal)
+                                                             { return searchSubgoalGraphPruned<Movement>(grid, graph, start, goal, context,
+                                                                                                         DeadEndPruning(deadEnds, start, goal)); });
+                     std::printf("rsr: %.1f -> %.1f expanded/query, subgoals: %.1f -> %.1f expanded/query\n",
+                                 static_cast<double>(rsr.expanded) / static_cast<double>(queries.size()),
+                                 static_cast<double>(rsrPruned.expanded) / static_cast<double>(queries.size()),
+                                 static_cast<double>(subgoals.expanded) / static_cast<double>(queries.size()),
+                                 static_cast<double>(subgoalsPruned.expanded) / static_cast<double>(queries.size()));
+                     mismatches += countMismatches(astar, rsrPruned) + countMismatches(astar, subgoalsPruned); });
+    return mismatches;
+}
+
+static int benchDeadEnds(Grid &grid, const BenchOptions &options)
+{
+    auto findStart = std::chrono::steady_clock::now();
+    DeadEnds deadEnds = findDeadEnds(grid, options.movement);
+    double findSeconds = secondsSince(findStart);
+    std::printf("dead ends: %d pockets, %d of %d cells, found in %.3f ms\n", deadEnds.pocketCount(), deadEnds.pocketCellCount(),
+                grid.cellCount(), findSeconds * 1e3);
+    SubgoalGraph graph = buildSubgoalGraph(grid, options.movement, false, options.threads);
+    int mismatches = compareDeadEndPruning(grid, deadEnds, graph, options, options.seed);
+    if (options.edits > 0)
+    {
+        // Toggle random cells with local updates, then check pruning on the edited map
+        std::mt19937 rng(options.seed + 1);
+        std::uniform_int_distribution<int> pickCell(0, grid.cellCount() - 1);
+        auto updateStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < options.edits; ++i)
+        {
+            int cell = pickCell(rng);
+            int x = cell % grid.width, y = cell / grid.width;
+            grid.setWall(x, y, !grid.isWall(x, y));
+            updateDeadEnds(grid, deadEnds, x, y);
+        }
+        double updateSeconds = secondsSince(updateStart);
+        std::printf("%d edits: %.3f ms per update (full pass %.3f ms), %d pockets, %d cells\n", options.edits,
+                    updateSeconds * 1e3 / options.edits, findSeconds * 1e3, deadEnds.pocketCount(), deadEnds.pocketCellCount());
+        graph = buildSubgoalGraph(grid, options.movement, false, options.threads);
+        mismatches += compareDeadEndPruning(grid, deadEnds, graph, options, options.seed + 2);
+    }
+    std::printf("cost mismatches: %d\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Annotated A* against plain A* on the grid with every cell that is too tight for the agent walled off
+static int compareAnnotated(const Grid &grid, const ClearanceMap &clearance, const BenchOptions &options, unsigned seed)
+{
+    int mismatches = 0;
+    SearchContext context;
+    for (int size = 1; size <= 3; ++size)
+    {
+        Grid inflated = grid;
+        for (int cell = 0; cell < grid.cellCount(); ++cell)
+        {
+            if (clearance.at(cell) < size)
+                inflated.setWall(cell % grid.width, cell / grid.width, true);
+        }
+        auto queries = randomQueries(inflated, options.queries, seed);
+        BenchTotals astar = runQueries(queries, [&](int start, int goal)
+                                       { return searchGrid(inflated, Algorithm::AStar, options.movement, start, goal, context); });
+        BenchTotals annotated = runQueries(queries, [&](int start, int goal)
+                                           { return searchAnnotated(grid, clearance, size, Algorithm::AStar, options.movement, start, goal, context); });
+        std::printf("size %d: %d of %zu queries found, annotated %.1f us/query, inflated-grid A* %.1f us/query, cost mismatches: %d\n", size,
+                    annotated.found, queries.size(), annotated.seconds * 1e6 / static_cast<double>(queries.size()),
+                    astar.seconds * 1e6 / static_cast<double>(queries.size()), countMismatches(astar, annotated));
+        mismatches += countMismatches(astar, annotated) + (astar.found - annotated.found != 0 ? 1 : 0);
+    }
+    return mismatches;
+}
+
+static int benchClearance(Grid &grid, const BenchOptions &options)
+{
+    auto computeStart = std::chrono::steady_clock::now();
+    ClearanceMap clearance = computeClearance(grid, options.threads);
+    double computeSeconds = secondsSince(computeStart);
+    int largest = *std::max_element(clearance.values.begin(), clearance.values.end());
+    std::printf("clearance: largest %d, transform: %.3f ms on %u threads\n", largest, computeSeconds * 1e3, options.threads);
+    int mismatches = compareAnnotated(grid, clearance, options, options.seed);
+    if (options.edits > 0)
+    {
+        std::mt19937 rng(options.seed + 1);
+        std::uniform_int_distribution<int> pickCell(0, grid.cellCount() - 1);
+        auto updateStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < options.edits; ++i)
+        {
+            int cell = pickCell(rng);
+            int x = cell % grid.width, y = cell / grid.width;
+            grid.setWall(x, y, !grid.isWall(x, y));
+            updateClearance(grid, clearance, x, y);
+        }
+        double updateSeconds = secondsSince(updateStart);
+        ClearanceMap rebuilt = computeClearance(grid, options.threads);
+        int stale = 0;
+        for (std::size_t cell = 0; cell < rebuilt.values.size(); ++cell)
+            stale += rebuilt.values[cell] != clearance.values[cell] ? 1 : 0;
+        std::printf("%d edits: %.4f ms per update (full transform %.3f ms), cells differing from a rebuild: %d\n", options.edits,
+                    updateSeconds * 1e3 / options.edits, computeSeconds * 1e3, stale);
+        mismatches += stale + compareAnnotated(grid, clearance, options, options.seed + 2);
+    }
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Cost of a lattice path recomputed from its cells and headings, or -1 if a step is not a legal move
+template <typename Movement>
+static float latticePathCost(const Grid &grid, const std::vector<int> &cells, const std::vector<int> &headings, const TurnCosts &turns)
+{
+    const std::array<int, 8> offsets = neighborOffsets(grid.width);
+    float cost = 0.0f;
+    for (std::size_t i = 1; i < cells.size(); ++i)
+    {
+        const int d = headings[i];
+        if (cells[i] != cells[i - 1] + offsets[static_cast<std::size_t>(d)] || !(Movement::moves(grid.neighborMask(cells[i - 1])) >> d & 1u))
+            return -1.0f;
+        cost += DIRECTION_COSTS[d] + (i > 1 ? turns.between(headings[i - 1], d) : 0.0f);
+    }
+    return cost;
+}
+
+static int benchLattice(const Grid &grid, const BenchOptions &options)
+{
+    auto queries = randomQueries(grid, options.queries, options.seed);
+    SearchContext context;
+    LatticeContext lattice;
+    BenchTotals astar = runQueries(queries, [&](int start, int goal)
+                                   { return searchGrid(grid, Algorithm::AStar, options.movement, start, goal, context); });
+
+    int mismatches = 0, badPaths = 0;
+    withMovement(options.movement, [&](auto policy)
+                 {
+                     using Movement = decltype(policy);
+                     // Free turns reduce the lattice to the grid, so costs must match A* exactly
+                     BenchTotals free = runQueries(queries, [&](int start, int goal)
+                                                   { return searchLattice<Movement>(grid, Algorithm::AStar, start, -1, goal, TurnCosts{{0, 0, 0, 0, 0}}, lattice); });
+                     printComparison("lattice", astar, free, queries.size());
+                     mismatches += countMismatches(astar, free);
+
+                     // With turn costs, A* has to agree with Dijkstra if the heuristic is admissible
+                     const TurnCosts turns;
+                     std::vector<int> cells, headings;
+                     BenchTotals turning = runQueries(queries, [&](int start, int goal)
+                                                      { return searchLattice<Movement>(grid, Algorithm::AStar, start, -1, goal, turns, lattice); });
+                     for (std::size_t i = 0; i < queries.size(); ++i)
+                     {
+                         searchLattice<Movement>(grid, Algorithm::AStar, queries[i].first, -1, queries[i].second, turns, lattice);
+                         writeLatticePath(lattice, grid.width, cells, &headings);
+                         if (turning.costs[i] >= 0.0f && std::abs(latticePathCost<Movement>(grid, cells, headings, turns) - turning.costs[i]) > 1e-3f)
+                             ++badPaths;
+                     }
+                     BenchTotals dijkstra = runQueries(queries, [&](int start, int goal)
+                                                       { return searchLattice<Movement>(grid, Algorithm::Dijkstra, start, -1, goal, turns, lattice); });
+                     const double perQuery = 1.0 / static_cast<double>(std::max<std::size_t>(1, queries.size()));
+                     std::printf("turn costs: a* expanded/query=%.1f us/query=%.1f, dijkstra expanded/query=%.1f us/query=%.1f, cost mismatches: %d, bad paths: %d\n",
+                                 static_cast<double>(turning.expanded) * perQuery, turning.seconds * 1e6 * perQuery,
+                                 static_cast<double>(dijkstra.expanded) * perQuery, dijkstra.seconds * 1e6 * perQuery,
+                                 countMismatches(dijkstra, turning), badPaths);
+                     mismatches += countMismatches(dijkstra, turning); });
+
+    // Search state only: both contexts also keep an open list whose size depends on the queries
+    const std::size_t gridBytes = context.g.size() * sizeof(float) + context.prev.size() * sizeof(int) +
+                                  (context.stamp.size() + context.closed.size()) * sizeof(std::uint32_t);
+    const std::size_t latticeBytes = lattice.stateBytes();
+    std::printf("search state: grid %zu bytes (%.1f per cell), lattice %zu bytes (%.1f per cell, %.1f per state)\n", gridBytes,
+                static_cast<double>(gridBytes) / grid.cellCount(), latticeBytes, static_cast<double>(latticeBytes) / grid.cellCount(),
+                static_cast<double>(latticeBytes) / (8.0 * grid.cellCount()));
+    return mismatches == 0 && badPaths == 0 ? 0 : 1;
+}
+
+// Checks one query's alternatives: legal, loopless, distinct, recorded costs correct and, for
+// K-shortest paths, in cost order. Returns the number of failed checks and adds up each
+// path's stretch over the first and its share of cells also on the first.
+static int checkAlternatives(const Grid &grid, MovementModel movement, const std::vector<AlternativePath> &paths, bool ordered,
+                             double &stretch, double &overlap)
+{
+    int failures = 0;
+    std::vector<std::uint8_t> onFirst(static_cast<std::size_t>(grid.cellCount()), 0);
+    for (int cell : paths.front().cells)
+        onFirst[static_cast<std::size_t>(cell)] = 1;
+    std::set<std::vector<int>> distinct;
+    for (std::size_t i = 0; i < paths.size(); ++i)
+    {
+        const AlternativePath &path = paths[i];
+        const std::set<int> cells(path.cells.begin(), path.cells.end());
+        if (std::abs(pathCost(grid, movement, path.cells) - path.cost) > 1e-3f || cells.size() != path.cells.size() || !distinct.insert(path.cells).second ||
+            (ordered && i > 0 && path.cost < paths[i - 1].cost - 1e-3f))
+            ++failures;
+        if (i == 0)
+            continue;
+        int shared = 0;
+        for (int cell : path.cells)
+            shared += onFirst[static_cast<std::size_t>(cell)];
+        stretch += path.cost / std::max(paths.front().cost, 1e-6f);
+        overlap += static_cast<double>(shared) / static_cast<double>(path.cells.size());
+    }
+    return failures;
+}
+
+static int benchAlternatives(const Grid &grid, const BenchOptions &options)
+{
+    auto queries = randomQueries(grid, options.queries, options.seed);
+    SearchContext context;
+    BenchTotals astar = runQueries(queries, [&](int start, int goal)
+                                   { return searchGrid(grid, Algorithm::AStar, options.movement, start, goal, context); });
+
+    int failures = 0;
+    const char *names[2] = {"yen", "penalty"};
+    for (int method = 0; method < 2; ++method)
+    {
+        std::vector<std::vector<AlternativePath>> results;
+        results.reserve(queries.size());
+        auto start = std::chrono::steady_clock::now();
+        for (const auto &query : queries)
+        {
+            results.push_back(method == 0 ? findKShortestPaths(grid, options.movement, query.first, query.second, options.paths, options.threads)
+                                          : findDiversePaths(grid, options.movement, query.first, query.second, options.paths));
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double stretch = 0.0, overlap = 0.0;
+        std::size_t alternatives = 0;
+        for (std::size_t i = 0; i < queries.size(); ++i)
+        {
+            if (results[i].empty())
+            {
+                failures += astar.costs[i] >= 0.0f;
+                continue;
+            }
+            // The first alternative is always a shortest path
+            failures += std::abs(results[i].front().cost - astar.costs[i]) > 1e-3f;
+            failures += checkAlternatives(grid, options.movement, results[i], method == 0, stretch, overlap);
+            alternatives += results[i].size() - 1;
+        }
+        const double perAlternative = alternatives ? 1.0 / static_cast<double>(alternatives) : 0.0;
+        std::printf("%-8s us/query=%9.1f  paths/query=%.2f  mean stretch=%.3f  mean overlap with first=%.1f%%\n", names[method],
+                    seconds * 1e6 / static_cast<double>(queries.size()),
+                    static_cast<double>(alternatives + queries.size()) / static_cast<double>(queries.size()), stretch * perAlternative,
+                    100.0 * overlap * perAlternative);
+    }
+    std::printf("astar    us/query=%9.1f (single path), failed checks: %d\n", astar.seconds * 1e6 / static_cast<double>(queries.size()), failures);
+    return failures == 0 ? 0 : 1;
+}
+
+// Nearest of many targets: one A* per target against one multi-target search, then ordered
+// waypoint routes searched segment by segment against the parallel router
+static int benchTargets(const Grid &grid, const BenchOptions &options)
+{
+    auto queries = randomQueries(grid, options.queries, options.seed);
+    auto targetCells = randomQueries(grid, options.queries * options.targets, options.seed + 1);
+    SearchContext context;
+    std::vector<TargetIndex> indexes;
+    for (std::size_t i = 0; i < queries.size(); ++i)
+    {
+        std::vector<int> targets;
+        for (int t = 0; t < options.targets; ++t)
+            targets.push_back(targetCells[i * static_cast<std::size_t>(options.targets) + static_cast<std::size_t>(t)].second);
+        indexes.push_back(buildTargetIndex(grid, targets));
+    }
+
+    std::size_t next = 0;
+    BenchTotals separate = runQueries(queries, [&](int start, int)
+                                      {
+                                          SearchResult best;
+                                          for (int target : indexes[next++].cells)
+                                          {
+                                              SearchResult result = searchGrid(grid, Algorithm::AStar, options.movement, start, target, context);
+                                              best.expanded += result.expanded;
+                                              if (result.found && (!best.found || result.cost < best.cost))
+                                              {
+                                                  best.found = true;
+                                                  best.cost = result.cost;
+                                              }
+                                          }
+                                          return best; });
+    int mismatches = 0;
+    for (Algorithm algorithm : {Algorithm::Dijkstra, Algorithm::AStar})
+    {
+        next = 0;
+        BenchTotals nearest = runQueries(queries, [&](int start, int)
+                                         {
+                                             int reached;
+                                             return searchNearestTarget(grid, algorithm, options.movement, start, indexes[next++], reached, context); });
+        printComparison(algorithm == Algorithm::AStar ? "multi-a*" : "multi-dj", separate, nearest, queries.size());
+        mismatches += countMismatches(separate, nearest);
+    }
+    std::printf("(baseline: one A* per target, %d targets per query)\n", options.targets);
+
+    // Routes through 8 waypoints: the first query cell, then targets
+    const int waypointCount = 8;
+    std::vector<std::vector<int>> routes;
+    for (std::size_t i = 0; i < queries.size(); ++i)
+    {
+        routes.emplace_back(1, queries[i].first);
+        for (int w = 1; w < waypointCount; ++w)
+            routes.back().push_back(targetCells[i * static_cast<std::size_t>(options.targets) + static_cast<std::size_t>(w % options.targets)].first);
+    }
+    std::vector<int> path, segment;
+    next = 0;
+    BenchTotals sequential = runQueries(queries, [&](int, int)
+                                        {
+                                            const std::vector<int> &waypoints = routes[next++];
+                                            SearchResult total;
+                                            total.found = true;
+                                            for (std::size_t w = 1; w < waypoints.size(); ++w)
+                                            {
+                                                SearchResult result = findPath(grid, Algorithm::AStar, options.movement, waypoints[w - 1], waypoints[w], segment, context);
+                                                total.found = total.found && result.found;
+                                                total.cost += result.cost;
+                                                total.expanded += result.expanded;
+                                            }
+                                            return total.found ? total : SearchResult(); });
+    WaypointRouter router(options.threads);
+    int badRoutes = 0;
+    next = 0;
+    BenchTotals parallel = runQueries(queries, [&](int, int)
+                                      {
+                                          const std::vector<int> &waypoints = routes[next++];
+                                          SearchResult result = router.route(grid, Algorithm::AStar, options.movement, waypoints, path);
+                                          // Segment costs are summed separately from the stitched path's steps, so allow rounding
+                                          if (result.found && std::abs(pathCost(grid, options.movement, path) - result.cost) > 1e-3f + 1e-5f * result.cost)
+                                              ++badRoutes;
+                                          return result; });
+    const double perQuery = 1.0 / static_cast<double>(queries.size());
+    std::printf("waypoints (%d): sequential us/route=%.1f, router (%u threads) us/route=%.1f, speedup: %.2fx, cost mismatches: %d, bad paths: %d\n",
+                waypointCount, sequential.seconds * 1e6 * perQuery, options.threads, parallel.seconds * 1e6 * perQuery,
+                parallel.seconds > 0 ? sequential.seconds / parallel.seconds : 0.0, countMismatches(sequential, parallel), badRoutes);
+    mismatches += countMismatches(sequential, parallel);
+    return mismatches == 0 && badRoutes == 0 ? 0 : 1;
+}
+
+// Time-dependent costs: the static dispatch against plain A*, the generic engine on constant
+// schedules against plain A*, time-dependent A* against Dijkstra on random doors, lights and
+// congested cells, and FIFO arrival times for two departures
+static int benchTimed(const Grid &grid, const BenchOptions &options)
+{
+    auto queries = randomQueries(grid, options.queries, options.seed);
+    SearchContext context;
+    BenchTotals astar = runQueries(queries, [&](int start, int goal)
+                                   { return searchGrid(grid, Algorithm::AStar, options.movement, start, goal, context); });
+
+    const TimeCosts none(grid);
+    BenchTotals untimed = runQueries(queries, [&](int start, int goal)
+                                     { return searchTimeDependent(grid, none, Algorithm::AStar, options.movement, start, goal, 0.0f, context); });
+    printComparison("untimed", astar, untimed, queries.size());
+    int mismatches = countMismatches(astar, untimed);
+
+    TimeCosts constant(grid);
+    const int flat = constant.addSchedule(1.0f, {{0.0f, 1.0f}});
+    for (int cell = 0; cell < grid.cellCount(); ++cell)
+        constant.assign(cell, flat);
+    BenchTotals generic = runQueries(queries, [&](int start, int goal)
+                                     { return searchTimeDependent(grid, constant, Algorithm::AStar, options.movement, start, goal, 0.0f, context); });
+    printComparison("generic", astar, generic, queries.size());
+    mismatches += countMismatches(astar, generic);
+
+    // About 3% of free cells get one of three schedules
+    TimeCosts costs(grid);
+    const float closed = std::numeric_limits<float>::infinity();
+    const int light = costs.addSchedule(20.0f, {{0.0f, 1.0f}, {10.0f, closed}});
+    const int congestion = costs.addSchedule(60.0f, {{0.0f, 1.0f}, {30.0f, 4.0f}});
+    const int door = costs.addSchedule(40.0f, {{0.0f, closed}, {30.0f, 1.0f}});
+    std::mt19937 rng(options.seed);
+    for (int cell = 0; cell < grid.cellCount(); ++cell)
+    {
+        if (!grid.walls[static_cast<std::size_t>(cell)] && rng() % 100 < 3)
+            costs.assign(cell, rng() % 3 == 0 ? light : rng() % 2 == 0 ? congestion : door);
+    }
+    BenchTotals timedAstar, timedDijkstra;
+    for (float departure : {0.0f, 7.0f})
+    {
+        timedAstar = runQueries(queries, [&](int start, int goal)
+                                { return searchTimeDependent(grid, costs, Algorithm::AStar, options.movement, start, goal, departure, context); });
+        if (departure == 0.0f)
+        {
+            timedDijkstra = runQueries(queries, [&](int start, int goal)
+                                       { return searchTimeDependent(grid, costs, Algorithm::Dijkstra, options.movement, start, goal, 0.0f, context); });
+            printComparison("td-a*", timedDijkstra, timedAstar, queries.size());
+            mismatches += countMismatches(timedDijkstra, timedAstar);
+        }
+    }
+    // Leaving 7 time units later never arrives earlier
+    int fifoViolations = 0;
+    for (std::size_t i = 0; i < queries.size(); ++i)
+        fifoViolations += timedDijkstra.costs[i] >= 0.0f && 7.0f + timedAstar.costs[i] < timedDijkstra.costs[i] - 1e-3f;
+    std::printf("(td-a* compared with time-dependent Dijkstra; %d timed cells) FIFO violations: %d\n", costs.timedCells, fifoViolations);
+    return mismatches == 0 && fifoViolations == 0 ? 0 : 1;
+}
+
+// Voxel map: the 2D map's walls rise through the lower half of the layers, and about 10% of the
+// remaining voxels are solid clutter
+static VoxelGrid makeVoxelWorld(const Grid &grid, int depth, unsigned seed)
+{
+    VoxelGrid voxels(grid.width, grid.height, depth);
+    std::mt19937 rng(seed);
+    for (int z = 0; z < depth; ++z)
+    {
+        for (int y = 0; y < grid.height; ++y)
+        {
+            for (int x = 0; x < grid.width; ++x)
+                voxels.setSolid(x, y, z, (z < depth / 2 && grid.isWall(x, y)) || rng() % 10 == 0);
+        }
+    }
+    return voxels;
+}
+
+// Cost of a voxel path, or -1 if a step is not a legal move
+template <typename Connectivity>
+static float voxelPathCost(const VoxelGrid &voxels, const std::vector<int> &path)
+{
+    float cost = 0.0f;
+    for (std::size_t i = 1; i < path.size(); ++i)
+    {
+        int x, y, z, nx, ny, nz;
+        voxels.coordinates(path[i - 1], x, y, z);
+        voxels.coordinates(path[i], nx, ny, nz);
+        int d = 0;
+        while (d < Connectivity::count && (VOXEL_DIRECTIONS[static_cast<std::size_t>(d)].x != nx - x || VOXEL_DIRECTIONS[static_cast<std::size_t>(d)].y != ny - y ||
+                                           VOXEL_DIRECTIONS[static_cast<std::size_t>(d)].z != nz - z))
+            ++d;
+        const std::uint32_t needs = d < Connectivity::count ? VOXEL_MOVE_NEEDS[static_cast<std::size_t>(d)] : 0u;
+        if (d == Connectivity::count || (voxels.freeNeighbors(x, y, z, Connectivity::count) & needs) != needs)
+            return -1.0f;
+        cost += voxelMoveCost(d);
+    }
+    return cost;
+}
+
+static int benchVoxels(const Grid &grid, const BenchOptions &options)
+{
+    const VoxelGrid voxels = makeVoxelWorld(grid, std::max(1, options.depth), options.seed);
+    std::vector<int> freeVoxels;
+    for (int z = 0; z < voxels.depth; ++z)
+    {
+        for (int y = 0; y < voxels.height; ++y)
+        {
+            for (int x = 0; x < voxels.width; ++x)
+            {
+                if (!voxels.isSolid(x, y, z))
+                    freeVoxels.push_back(voxels.voxelId(x, y, z));
+            }
+        }
+    }
+    if (freeVoxels.empty())
+        return 1;
+    std::mt19937 rng(options.seed);
+    std::vector<std::pair<int, int>> queries;
+    for (int i = 0; i < options.queries; ++i)
+        queries.emplace_back(freeVoxels[rng() % freeVoxels.size()], freeVoxels[rng() % freeVoxels.size()]);
+
+    VoxelContext context;
+    std::vector<int> path;
+    int failures = 0;
+    for (VoxelConnectivity connectivity : {VoxelConnectivity::Six, VoxelConnectivity::Eighteen, VoxelConnectivity::TwentySix})
+    {
+        BenchTotals dijkstra = runQueries(queries, [&](int start, int goal)
+                                          { return searchVoxels(voxels, Algorithm::Dijkstra, connectivity, start, goal, context); });
+        int badPaths = 0;
+        BenchTotals astar = runQueries(queries, [&](int start, int goal)
+                                       {
+                                           SearchResult result = searchVoxels(voxels, Algorithm::AStar, connectivity, start, goal, context);
+                                           writeVoxelPath(voxels, context, goal, path);
+                                           const float cost = withConnectivity(connectivity, [&](auto policy)
+                                                                               { return voxelPathCost<decltype(policy)>(voxels, path); });
+                                           badPaths += result.found && std::abs(cost - result.cost) > 1e-3f;
+                                           return result; });
+        const double perQuery = 1.0 / static_cast<double>(queries.size());
+        std::printf("%2d-connected: dijkstra expanded/query=%.1f us/query=%.1f, a* expanded/query=%.1f us/query=%.1f, cost mismatches: %d, bad paths: %d\n",
+                    static_cast<int>(connectivity), static_cast<double>(dijkstra.expanded) * perQuery, dijkstra.seconds * 1e6 * perQuery,
+                    static_cast<double>(astar.expanded) * perQuery, astar.seconds * 1e6 * perQuery, countMismatches(dijkstra, astar), badPaths);
+        failures += countMismatches(dijkstra, astar) + badPaths;
+    }
+
+    const double voxelCount = static_cast<double>(voxels.width) * voxels.height * voxels.depth;
+    const std::size_t stateBytes = context.stateBytes();
+    std::printf("%dx%dx%d voxels: occupancy %zu bytes (%.3f per voxel), search state %zu bytes (%.2f per voxel id)\n", voxels.width, voxels.height,
+                voxels.depth, voxels.memoryBytes(), static_cast<double>(voxels.memoryBytes()) / voxelCount, stateBytes,
+                static_cast<double>(stateBytes) / voxels.idCount());
+    return failures == 0 ? 0 : 1;
+}
+
+// Hex steps along a path, or -1 if two consecutive cells are not hex neighbors
+static float hexPathCost(const Grid &grid, const std::vector<int> &path)
+{
+    const HexSix hex(grid);
+    for (std::size_t i = 1; i < path.size(); ++i)
+    {
+        bool adjacent = false;
+        hex.neighbors(path[i - 1], [&](int next, float)
+                      { adjacent = adjacent || next == path[i]; });
+        if (!adjacent)
+            return -1.0f;
+    }
+    return path.empty() ? -1.0f : static_cast<float>(path.size() - 1);
+}
+
+// The square topologies must reproduce the movement engines' costs; the difference in time is
+// the price of the generic loop. Hex A* is checked against hex Dijkstra and its paths replayed.
+static int benchTopology(const Grid &grid, const BenchOptions &options)
+{
+    auto queries = randomQueries(grid, options.queries, options.seed);
+    SearchContext context;
+    int failures = 0;
+
+    BenchTotals eight = runQueries(queries, [&](int start, int goal)
+                                   { return searchGrid(grid, Algorithm::AStar, MovementModel::CornerCutting, start, goal, context); });
+    BenchTotals squareEight = runQueries(queries, [&](int start, int goal)
+                                         { return searchGridTopology(grid, Algorithm::AStar, GridTopology::SquareEight, start, goal, context); });
+    std::printf("(compared with corner-cutting A*)\n");
+    printComparison("square-8", eight, squareEight, queries.size());
+    failures += countMismatches(eight, squareEight);
+
+    BenchTotals four = runQueries(queries, [&](int start, int goal)
+                                  { return searchGrid(grid, Algorithm::AStar, MovementModel::FourConnected, start, goal, context); });
+    BenchTotals squareFour = runQueries(queries, [&](int start, int goal)
+                                        { return searchGridTopology(grid, Algorithm::AStar, GridTopology::SquareFour, start, goal, context); });
+    std::printf("(compared with 4-connected A*)\n");
+    printComparison("square-4", four, squareFour, queries.size());
+    failures += countMismatches(four, squareFour);
+
+    BenchTotals hexDijkstra = runQueries(queries, [&](int start, int goal)
+                                         { return searchGridTopology(grid, Algorithm::Dijkstra, GridTopology::HexSix, start, goal, context); });
+    std::vector<int> path;
+    int badPaths = 0;
+    BenchTotals hexAstar = runQueries(queries, [&](int start, int goal)
+                                      {
+                                          SearchResult result = findTopologyPath(grid, Algorithm::AStar, GridTopology::HexSix, start, goal, path, context);
+                                          badPaths += result.found && (path.front() != start || path.back() != goal ||
+                                                                       std::abs(hexPathCost(grid, path) - result.cost) > 1e-3f);
+                                          return result; });
+    const double perQuery = 1.0 / static_cast<double>(queries.size());
+    std::printf("hex-6: dijkstra expanded/query=%.1f us/query=%.1f, a* expanded/query=%.1f us/query=%.1f, found %d, cost mismatches: %d, bad paths: %d\n",
+                static_cast<double>(hexDijkstra.expanded) * perQuery, hexDijkstra.seconds * 1e6 * perQuery, static_cast<double>(hexAstar.expanded) * perQuery,
+                hexAstar.seconds * 1e6 * perQuery, hexAstar.found, countMismatches(hexDijkstra, hexAstar), badPaths);
+    failures += countMismatches(hexDijkstra, hexAstar) + badPaths;
+    return failures == 0 ? 0 : 1;
+}
+
+static void printUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " rsr|navmesh|subgoals|goalbounds|arcflags|deadends|clearance|lattice|alternatives|targets|timed|voxels|topology [--map FILE | --size WxH] [--queries N]\n"
+              << "                [--seed N] [--threads N] [--movement corner|no-corner|4] [--edits N] [--bounds FILE]\n"
+              << "                [--regions K | --budget BYTES] [--paths K] [--targets N] [--depth N]\n"
+              << "Without --map a warehouse layout is generated.\n";
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    if (argc < 2)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    options.mode = argv[1];
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--map" && hasValue)
+            options.mapPath = argv[++i];
+        else if (arg == "--size" && hasValue && std::sscanf(argv[i + 1], "%dx%d", &options.width, &options.height) == 2)
+            ++i;
+        else if (arg == "--queries" && hasValue)
+            options.queries = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seed" && hasValue)
+            options.seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--threads" && hasValue)
+            options.threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        else if (arg == "--edits" && hasValue)
+            options.edits = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--regions" && hasValue)
+            options.regions = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--budget" && hasValue)
+            options.budget = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+        else if (arg == "--paths" && hasValue)
+            options.paths = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--targets" && hasValue)
+            options.targets = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--depth" && hasValue)
+            options.depth = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--bounds" && hasValue)
+            options.boundsPath = argv[++i];
+        else if (arg == "--movement" && hasValue)
+        {
+            std::string model = argv[++i];
+            options.movement = model == "no-corner" ? MovementModel::NoCornerCutting
+                               : model == "4"       ? MovementModel::FourConnected
+                                                    : MovementModel::CornerCutting;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    Grid grid;
+    if (options.mapPath.empty())
+        grid = makeWarehouse(std::max(8, options.width), std::max(8, options.height));
+    else if (!loadGridFile(options.mapPath, grid))
+    {
+        std::cerr << "Failed to load map " << options.mapPath << "\n";
+        return 1;
+    }
+    std::printf("map %dx%d, %s moves, %d queries\n", grid.width, grid.height, movementName(options.movement), options.queries);
+
+    if (options.mode == "rsr")
+        return benchRsr(grid, options);
+    if (options.mode == "navmesh")
+        return benchNavMesh(grid, options);
+    if (options.mode == "subgoals")
+        return benchSubgoals(grid, options);
+    if (options.mode == "goalbounds")
+        return benchGoalBounds(grid, options);
+    if (options.mode == "arcflags")
+        return benchArcFlags(grid, options);
+    if (options.mode == "deadends")
+        return benchDeadEnds(grid, options);
+    if (options.mode == "clearance")
+        return benchClearance(grid, options);
+    if (options.mode == "lattice")
+        return benchLattice(grid, options);
+    if (options.mode == "alternatives")
+        return benchAlternatives(grid, options);
+    if (options.mode == "targets")
+        return benchTargets(grid, options);
+    if (options.mode == "timed")
+        return benchTimed(grid, options);
+    if (options.mode == "voxels")
+        return benchVoxels(grid, options);
+    if (options.mode == "topology")
+        return benchTopology(grid, options);
+    printUsage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,89 @@
+#include "clearance.hpp"
+
+#include "thread_pool.hpp"
+
+// Downward free run of (x, y), given the run of the cell below it
+static std::uint8_t downRun(const Grid &grid, const ClearanceMap &clearance, int x, int y)
+{
+    if (grid.isWall(x, y))
+        return 0;
+    const int below = y + 1 < grid.height ? clearance.down[static_cast<std::size_t>(grid.cellId(x, y + 1))] : 0;
+    return static_cast<std::uint8_t>(std::min(MAX_CLEARANCE, below + 1));
+}
+
+// Row pass of the transform: min over x' >= x of max(x' - x, down(x', y)), with the map's right
+// edge acting as a wall. Candidates farther than the best so far cannot win, so the scan stops
+// after at most clearance + 1 cells.
+static std::uint8_t squareClearance(const ClearanceMap &clearance, int x, int y)
+{
+    const std::uint8_t *row = clearance.down.data() + static_cast<std::size_t>(y) * static_cast<std::size_t>(clearance.width);
+    int best = std::min(static_cast<int>(row[x]), clearance.width - x);
+    for (int offset = 1; offset < best; ++offset)
+        best = std::min(best, std::max(offset, static_cast<int>(row[x + offset])));
+    return static_cast<std::uint8_t>(best);
+}
+
+ClearanceMap computeClearance(const Grid &grid, unsigned threads)
+{
+    ClearanceMap clearance;
+    clearance.width = grid.width;
+    clearance.height = grid.height;
+    clearance.down.assign(static_cast<std::size_t>(grid.cellCount()), 0);
+    clearance.values.assign(static_cast<std::size_t>(grid.cellCount()), 0);
+
+    // Column pass over bands of columns, then row pass over bands of rows
+    ThreadPool pool(threads);
+    const int bands = static_cast<int>(std::max(1u, threads));
+    const int columnsPerBand = (grid.width + bands - 1) / bands, rowsPerBand = (grid.height + bands - 1) / bands;
+    for (int begin = 0; begin < grid.width; begin += columnsPerBand)
+    {
+        const int end = std::min(grid.width, begin + columnsPerBand);
+        pool.submit([&grid, &clearance, begin, end]()
+                    {
+                        for (int y = grid.height - 1; y >= 0; --y)
+                        {
+                            for (int x = begin; x < end; ++x)
+                                clearance.down[static_cast<std::size_t>(grid.cellId(x, y))] = downRun(grid, clearance, x, y);
+                        } });
+    }
+    pool.wait();
+    for (int begin = 0; begin < grid.height; begin += rowsPerBand)
+    {
+        const int end = std::min(grid.height, begin + rowsPerBand);
+        pool.submit([&grid, &clearance, begin, end]()
+                    {
+                        for (int y = begin; y < end; ++y)
+                        {
+                            for (int x = 0; x < grid.width; ++x)
+                                clearance.values[static_cast<std::size_t>(grid.cellId(x, y))] = squareClearance(clearance, x, y);
+                        } });
+    }
+    pool.wait();
+    return clearance;
+}
+
+void updateClearance(const Grid &grid, ClearanceMap &clearance, int x, int y)
+{
+    // Downward runs change only in the cell's column, from the cell up to the first run that keeps its value
+    for (int row = y; row >= 0; --row)
+    {
+        std::uint8_t &run = clearance.down[static_cast<std::size_t>(grid.cellId(x, row))];
+        const std::uint8_t updated = downRun(grid, clearance, x, row);
+        if (row < y && updated == run)
+            break;
+        run = updated;
+    }
+
+    // A square that covers (x, y) also covers the free cells between its corner and (x, y) in
+    // column x and in row y, so only corners within those free runs can change
+    int up = 0, left = 0;
+    while (up < MAX_CLEARANCE && y - up - 1 >= 0 && !grid.isWall(x, y - up - 1))
+        ++up;
+    while (left < MAX_CLEARANCE && x - left - 1 >= 0 && !grid.isWall(x - left - 1, y))
+        ++left;
+    for (int row = y - up; row <= y; ++row)
+    {
+        for (int column = x - left; column <= x; ++column)
+            clearance.values[static_cast<std::size_t>(grid.cellId(column, row))] = squareClearance(clearance, column, row);
+    }
+}
@@ -0,0 +1,94 @@
+// True clearance for agents with square footprints. An agent of size s standing on cell (x, y)
+// covers the s x s cells [x, x + s) x [y, y + s); the clearance of a cell is the largest s for
+// which that square is free. Annotated A* then searches the grid as seen by an agent of the
+// requested size: a move is legal when the movement model allows it on the grid whose free
+// cells are those with clearance >= s.
+//
+// Clearance is the chessboard distance to the nearest wall (or the map's right or bottom edge)
+// in the quadrant below and to the right, computed as a separable distance transform: one pass
+// down the columns, then one along the rows, each split across threads.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "pathfinding.hpp"
+
+// Clearances are capped here (they are stored in one byte per cell)
+const int MAX_CLEARANCE = 255;
+
+struct ClearanceMap
+{
+    int width = 0, height = 0;
+    std::vector<std::uint8_t> down;   // Free cells from each cell downwards, capped at MAX_CLEARANCE
+    std::vector<std::uint8_t> values; // Clearance per cell, 0 on walls
+
+    bool valid(const Grid &grid) const { return width == grid.width && height == grid.height; }
+    int at(int cell) const { return values[static_cast<std::size_t>(cell)]; }
+};
+
+// Full transform on threads workers
+ClearanceMap computeClearance(const Grid &grid, unsigned threads);
+
+// Updates the map after the wall at (x, y) changed (grid already updated). Only cells whose
+// square can reach (x, y) through free cells are recomputed: the column above the cell for
+// the downward runs, then the window up and to the left bounded by the free runs through it.
+void updateClearance(const Grid &grid, ClearanceMap &clearance, int x, int y);
+
+// Keeps the moves an agent of size `size` can make. The neighbors with enough clearance form a
+// neighbor mask that the movement model narrows as usual, so corner rules apply to the agent's
+// footprint rather than to single cells.
+template <typename Movement>
+struct ClearancePruning
+{
+    const Grid &grid;
+    const ClearanceMap &clearance;
+    int size;
+    std::array<int, 8> offsets;
+
+    ClearancePruning(const Grid &grid, const ClearanceMap &clearance, int size)
+        : grid(grid), clearance(clearance), size(size), offsets(neighborOffsets(grid.width))
+    {
+    }
+
+    bool keeps(int cell) const { return clearance.at(cell) >= size; }
+
+    unsigned moves(int cell) const
+    {
+        unsigned roomy = 0;
+        for (unsigned m = grid.neighborMask(cell); m != 0; m &= m - 1)
+        {
+            const int d = __builtin_ctz(m);
+            roomy |= keeps(cell + offsets[static_cast<std::size_t>(d)]) ? 1u << d : 0u;
+        }
+        return Movement::moves(roomy);
+    }
+};
+
+// Annotated A* (or Dijkstra) for an agent of the given size, also dropping what the extra
+// pruning policy drops; no path if the agent does not fit on the start or goal cell
+template <typename Pruning, typename Trace = NullSearchTrace>
+SearchResult searchAnnotatedPruned(const Grid &grid, const ClearanceMap &clearance, int agentSize, Algorithm algorithm, MovementModel movement,
+                                   int start, int goal, SearchContext &context, const Pruning &extra, Trace &&trace = Trace())
+{
+    if (clearance.at(start) < agentSize || clearance.at(goal) < agentSize)
+    {
+        context.begin(grid.cellCount());
+        return SearchResult();
+    }
+    return withMovement(movement, [&](auto policy)
+                        {
+                            using Movement = decltype(policy);
+                            const ClearancePruning<Movement> roomy(grid, clearance, agentSize);
+                            const BothPruning<ClearancePruning<Movement>, Pruning> pruning{roomy, extra};
+                            if (algorithm == Algorithm::AStar)
+                                return searchGridPruned<Movement>(grid, start, goal, context, typename Movement::Distance(grid, goal), pruning, trace);
+                            return searchGridPruned<Movement>(grid, start, goal, context, ZeroHeuristic(), pruning, trace); });
+}
+
+template <typename Trace = NullSearchTrace>
+SearchResult searchAnnotated(const Grid &grid, const ClearanceMap &clearance, int agentSize, Algorithm algorithm, MovementModel movement,
+                             int start, int goal, SearchContext &context, Trace &&trace = Trace())
+{
+    return searchAnnotatedPruned(grid, clearance, agentSize, algorithm, movement, start, goal, context, NoPruning(), trace);
+}
@@ -0,0 +1,269 @@
+#include "dead_ends.hpp"
+
+// Takes a freed pocket id if there is one
+static int allocatePocket(DeadEnds &deadEnds, int entrance)
+{
+    if (deadEnds.freeIds.empty())
+    {
+        deadEnds.entrances.push_back(entrance);
+        return static_cast<int>(deadEnds.entrances.size()) - 1;
+    }
+    const int id = deadEnds.freeIds.back();
+    deadEnds.freeIds.pop_back();
+    deadEnds.entrances[static_cast<std::size_t>(id)] = entrance;
+    return id;
+}
+
+// Ends a pass or update: freed ids become reusable (cells of components relabelled later in the
+// same update could still hold them before) and the visited cells are unvisited again
+static void finishPass(DeadEnds &deadEnds)
+{
+    ArticulationScratch &scratch = deadEnds.scratch;
+    deadEnds.freeIds.insert(deadEnds.freeIds.end(), scratch.freed.begin(), scratch.freed.end());
+    scratch.freed.clear();
+    for (int cell : scratch.order)
+        scratch.discovered[static_cast<std::size_t>(cell)] = -1;
+    scratch.order.clear();
+    scratch.counter = 0;
+}
+
+// The moves out of cell that lead into a pocket other than the cell's own
+template <typename Movement>
+static std::uint8_t movesIntoPockets(const Grid &grid, const DeadEnds &deadEnds, const std::array<int, 8> &offsets, int cell)
+{
+    const int own = deadEnds.pocketOf[static_cast<std::size_t>(cell)];
+    unsigned mask = 0;
+    for (unsigned m = grid.walls[static_cast<std::size_t>(cell)] ? 0u : Movement::moves(grid.neighborMask(cell)); m != 0; m &= m - 1)
+    {
+        const int d = __builtin_ctz(m);
+        const int pocket = deadEnds.pocketOf[static_cast<std::size_t>(cell + offsets[static_cast<std::size_t>(d)])];
+        if (pocket >= 0 && pocket != own)
+            mask |= 1u << d;
+    }
+    return static_cast<std::uint8_t>(mask);
+}
+
+// Runs Tarjan's articulation search over root's component and labels its outermost pockets.
+// Pocket ids held by the component's cells before are freed.
+template <typename Movement>
+static void labelComponent(const Grid &grid, DeadEnds &deadEnds, int root, ArticulationScratch &scratch)
+{
+    const std::array<int, 8> offsets = neighborOffsets(grid.width);
+    const std::size_t first = scratch.order.size();
+    const int base = scratch.counter;
+    scratch.candidates.clear();
+
+    auto visit = [&](int cell)
+    {
+        scratch.discovered[static_cast<std::size_t>(cell)] = scratch.low[static_cast<std::size_t>(cell)] = scratch.counter++;
+        scratch.size[static_cast<std::size_t>(cell)] = 1;
+        scratch.order.push_back(cell);
+        scratch.stack.push_back({cell, Movement::moves(grid.neighborMask(cell))});
+    };
+    visit(root);
+    while (!scratch.stack.empty())
+    {
+        const std::size_t top = scratch.stack.size() - 1;
+        const int cell = scratch.stack[top].cell;
+        if (scratch.stack[top].moves != 0)
+        {
+            const int d = __builtin_ctz(scratch.stack[top].moves);
+            scratch.stack[top].moves &= scratch.stack[top].moves - 1;
+            const int next = cell + offsets[static_cast<std::size_t>(d)];
+            if (scratch.discovered[static_cast<std::size_t>(next)] < 0)
+                visit(next);
+            else
+                scratch.low[static_cast<std::size_t>(cell)] = std::min(scratch.low[static_cast<std::size_t>(cell)], scratch.discovered[static_cast<std::size_t>(next)]);
+            continue;
+        }
+        scratch.stack.pop_back();
+        if (scratch.stack.empty())
+            break;
+        // No back edge from cell's subtree climbs above its parent: the parent cuts the subtree off
+        const int parent = scratch.stack.back().cell;
+        scratch.low[static_cast<std::size_t>(parent)] = std::min(scratch.low[static_cast<std::size_t>(parent)], scratch.low[static_cast<std::size_t>(cell)]);
+        scratch.size[static_cast<std::size_t>(parent)] += scratch.size[static_cast<std::size_t>(cell)];
+        if (scratch.low[static_cast<std::size_t>(cell)] >= scratch.discovered[static_cast<std::size_t>(parent)])
+            scratch.candidates.push_back({cell, parent});
+    }
+
+    for (std::size_t i = first; i < scratch.order.size(); ++i)
+    {
+        int &pocket = deadEnds.pocketOf[static_cast<std::size_t>(scratch.order[i])];
+        if (pocket >= 0 && deadEnds.entrances[static_cast<std::size_t>(pocket)] >= 0)
+        {
+            deadEnds.entrances[static_cast<std::size_t>(pocket)] = -1;
+            scratch.freed.push_back(pocket);
+        }
+        pocket = -1;
+    }
+
+    // A subtree is a preorder range, so sorting by preorder puts each outermost pocket before
+    // the pockets nested in it
+    const int componentSize = static_cast<int>(scratch.order.size() - first);
+    std::sort(scratch.candidates.begin(), scratch.candidates.end(), [&](const ArticulationScratch::Candidate &a, const ArticulationScratch::Candidate &b)
+              { return scratch.discovered[static_cast<std::size_t>(a.child)] < scratch.discovered[static_cast<std::size_t>(b.child)]; });
+    int coveredEnd = base;
+    for (const ArticulationScratch::Candidate &candidate : scratch.candidates)
+    {
+        const int begin = scratch.discovered[static_cast<std::size_t>(candidate.child)];
+        const int size = scratch.size[static_cast<std::size_t>(candidate.child)];
+        if (begin < coveredEnd || size * 2 > componentSize)
+            continue;
+        const int id = allocatePocket(deadEnds, candidate.entrance);
+        for (int i = begin; i < begin + size; ++i)
+            deadEnds.pocketOf[static_cast<std::size_t>(scratch.order[first + static_cast<std::size_t>(i - base)])] = id;
+        coveredEnd = begin + size;
+    }
+    for (std::size_t i = first; i < scratch.order.size(); ++i)
+        deadEnds.pocketMoves[static_cast<std::size_t>(scratch.order[i])] = movesIntoPockets<Movement>(grid, deadEnds, offsets, scratch.order[i]);
+}
+
+template <typename Movement>
+static void findWith(const Grid &grid, DeadEnds &deadEnds)
+{
+    ArticulationScratch &scratch = deadEnds.scratch;
+    for (int cell = 0; cell < grid.cellCount(); ++cell)
+    {
+        if (!grid.walls[static_cast<std::size_t>(cell)] && scratch.discovered[static_cast<std::size_t>(cell)] < 0)
+            labelComponent<Movement>(grid, deadEnds, cell, scratch);
+    }
+    finishPass(deadEnds);
+}
+
+DeadEnds findDeadEnds(const Grid &grid, MovementModel movement)
+{
+    DeadEnds deadEnds;
+    deadEnds.movement = movement;
+    deadEnds.width = grid.width;
+    deadEnds.height = grid.height;
+    deadEnds.pocketOf.assign(static_cast<std::size_t>(grid.cellCount()), -1);
+    deadEnds.pocketMoves.assign(static_cast<std::size_t>(grid.cellCount()), 0);
+    deadEnds.scratch.discovered.assign(static_cast<std::size_t>(grid.cellCount()), -1);
+    deadEnds.scratch.low.resize(static_cast<std::size_t>(grid.cellCount()));
+    deadEnds.scratch.size.resize(static_cast<std::size_t>(grid.cellCount()));
+    withMovement(movement, [&](auto policy)
+                 { findWith<decltype(policy)>(grid, deadEnds); });
+    return deadEnds;
+}
+
+// The edit stays inside pocket: the cells the pocket's entrance still reaches through old
+// pocket cells (or the edited cell) remain the pocket, and the rest is now cut off from the map
+template <typename Movement>
+static void refloodPocket(const Grid &grid, DeadEnds &deadEnds, int pocket, int edited, const std::vector<int> &window)
+{
+    const std::array<int, 8> offsets = neighborOffsets(grid.width);
+    const int entrance = deadEnds.entrances[static_cast<std::size_t>(pocket)];
+    const int candidate = -2; // Label of old pocket cells while they are re-flooded
+    auto flood = [&](int seed, int from, int to, std::vector<int> *cells)
+    {
+        std::vector<int> stack(1, seed);
+        while (!stack.empty())
+        {
+            const int cell = stack.back();
+            stack.pop_back();
+            for (unsigned m = Movement::moves(grid.neighborMask(cell)); m != 0; m &= m - 1)
+            {
+                const int next = cell + offsets[static_cast<std::size_t>(__builtin_ctz(m))];
+                if (deadEnds.pocketOf[static_cast<std::size_t>(next)] != from)
+                    continue;
+                deadEnds.pocketOf[static_cast<std::size_t>(next)] = to;
+                if (cells)
+                    cells->push_back(next);
+                stack.push_back(next);
+            }
+        }
+    };
+
+    // Every part of the old pocket touches the edited cell, so its neighbors reach all of it
+    std::vector<int> cells;
+    if (!grid.walls[static_cast<std::size_t>(edited)])
+        deadEnds.pocketOf[static_cast<std::size_t>(edited)] = pocket;
+    else
+        deadEnds.pocketOf[static_cast<std::size_t>(edited)] = -1;
+    for (int cell : window)
+    {
+        if (deadEnds.pocketOf[static_cast<std::size_t>(cell)] != pocket)
+            continue;
+        deadEnds.pocketOf[static_cast<std::size_t>(cell)] = candidate;
+        cells.push_back(cell);
+        flood(cell, pocket, candidate, &cells);
+    }
+
+    // Re-flood from the entrance; candidates it misses are unreachable from the rest of the map
+    flood(entrance, candidate, pocket, nullptr);
+    bool empty = true;
+    for (int cell : cells)
+    {
+        if (deadEnds.pocketOf[static_cast<std::size_t>(cell)] == candidate)
+            deadEnds.pocketOf[static_cast<std::size_t>(cell)] = -1;
+        else
+            empty = false;
+    }
+    if (empty)
+    {
+        deadEnds.entrances[static_cast<std::size_t>(pocket)] = -1;
+        deadEnds.freeIds.push_back(pocket);
+    }
+
+    cells.push_back(entrance);
+    cells.push_back(edited);
+    for (int cell : cells)
+        deadEnds.pocketMoves[static_cast<std::size_t>(cell)] = movesIntoPockets<Movement>(grid, deadEnds, offsets, cell);
+}
+
+template <typename Movement>
+static void updateWith(const Grid &grid, DeadEnds &deadEnds, int x, int y)
+{
+    const int edited = grid.cellId(x, y);
+    std::vector<int> window; // Cells whose moves the edit changed
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+            if (grid.inBounds(x + dx, y + dy))
+                window.push_back(grid.cellId(x + dx, y + dy));
+        }
+    }
+
+    // Local case: the neighborhood lies inside a single pocket (the edited cell may be new to it)
+    int pocket = -1;
+    bool local = true;
+    for (int cell : window)
+    {
+        if (cell == edited || grid.walls[static_cast<std::size_t>(cell)])
+            continue;
+        const int label = deadEnds.pocketOf[static_cast<std::size_t>(cell)];
+        local = local && label >= 0 && (pocket < 0 || label == pocket);
+        pocket = label;
+    }
+    const int editedPocket = deadEnds.pocketOf[static_cast<std::size_t>(edited)];
+    if (local && pocket >= 0 && (editedPocket < 0 || editedPocket == pocket))
+    {
+        refloodPocket<Movement>(grid, deadEnds, pocket, edited, window);
+        return;
+    }
+
+    // Otherwise relabel every component around the edit; together they hold all cells whose
+    // pocket could have changed
+    ArticulationScratch &scratch = deadEnds.scratch;
+    if (editedPocket >= 0 && deadEnds.entrances[static_cast<std::size_t>(editedPocket)] >= 0)
+    {
+        deadEnds.entrances[static_cast<std::size_t>(editedPocket)] = -1;
+        scratch.freed.push_back(editedPocket);
+    }
+    deadEnds.pocketOf[static_cast<std::size_t>(edited)] = -1;
+    deadEnds.pocketMoves[static_cast<std::size_t>(edited)] = 0;
+    for (int cell : window)
+    {
+        if (!grid.walls[static_cast<std::size_t>(cell)] && scratch.discovered[static_cast<std::size_t>(cell)] < 0)
+            labelComponent<Movement>(grid, deadEnds, cell, scratch);
+    }
+    finishPass(deadEnds);
+}
+
+void updateDeadEnds(const Grid &grid, DeadEnds &deadEnds, int x, int y)
+{
+    withMovement(deadEnds.movement, [&](auto policy)
+                 { updateWith<decltype(policy)>(grid, deadEnds, x, y); });
+}
@@ -0,0 +1,110 @@
+// Dead ends: pockets of free cells that the rest of the map reaches through a single entrance
+// cell, such as rooms with one door or the blind corridors of a maze. A shortest path between
+// two cells outside a pocket never enters it, since it would have to leave through the same
+// entrance, so searches skip every pocket that holds neither the start nor the goal.
+//
+// Pockets are the sides of articulation points (one iterative Tarjan pass per connected
+// component) holding at most half of their component. Nested pockets are merged into the
+// outermost one; it is skipped or searched as a whole.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "pathfinding.hpp"
+
+// Articulation search state, sized to the map once and reused by every pass and update;
+// discovered is reset for the visited cells only
+struct ArticulationScratch
+{
+    struct Frame
+    {
+        int cell;
+        unsigned moves; // Moves not yet followed
+    };
+    struct Candidate
+    {
+        int child, entrance; // Subtree root and the articulation point above it
+    };
+
+    std::vector<int> discovered; // Preorder number per cell, -1 if unvisited
+    std::vector<int> low;
+    std::vector<int> size; // Subtree size
+    std::vector<int> order; // Visited cells in preorder
+    std::vector<Frame> stack;
+    std::vector<Candidate> candidates;
+    std::vector<int> freed; // Pocket ids freed by the current update
+    int counter = 0;
+};
+
+struct DeadEnds
+{
+    MovementModel movement = MovementModel::CornerCutting;
+    int width = 0, height = 0;
+    std::vector<int> pocketOf;               // Pocket id per cell, -1 outside pockets and on walls
+    std::vector<int> entrances;              // Entrance cell per pocket, -1 for ids freed by updates
+    std::vector<std::uint8_t> pocketMoves;   // Per cell, the moves into a pocket other than its own; only entrances have any
+    std::vector<int> freeIds;                // Freed pocket ids, reused before entrances grows
+    ArticulationScratch scratch;
+
+    bool valid(const Grid &grid, MovementModel model) const { return width == grid.width && height == grid.height && movement == model; }
+    int pocketCount() const { return static_cast<int>(std::count_if(entrances.begin(), entrances.end(), [](int cell) { return cell >= 0; })); }
+    int pocketCellCount() const { return static_cast<int>(std::count_if(pocketOf.begin(), pocketOf.end(), [](int id) { return id >= 0; })); }
+};
+
+// Finds the pockets of every connected component in linear time
+DeadEnds findDeadEnds(const Grid &grid, MovementModel movement);
+
+// Updates the pockets after the wall at (x, y) changed (grid already updated). An edit whose
+// 3x3 neighborhood lies inside one pocket only re-floods that pocket from its entrance; any
+// other edit reruns the pass over the components around the cell.
+void updateDeadEnds(const Grid &grid, DeadEnds &deadEnds, int x, int y);
+
+// Skips the pockets that hold neither start nor goal
+struct DeadEndPruning
+{
+    const DeadEnds &deadEnds;
+    std::array<int, 8> offsets;
+    int startPocket, goalPocket;
+
+    DeadEndPruning(const DeadEnds &deadEnds, int start, int goal)
+        : deadEnds(deadEnds), offsets(neighborOffsets(deadEnds.width)), startPocket(deadEnds.pocketOf[static_cast<std::size_t>(start)]),
+          goalPocket(deadEnds.pocketOf[static_cast<std::size_t>(goal)])
+    {
+    }
+
+    bool keeps(int cell) const
+    {
+        const int pocket = deadEnds.pocketOf[static_cast<std::size_t>(cell)];
+        return pocket < 0 || pocket == startPocket || pocket == goalPocket;
+    }
+
+    // Only entrances lead into pockets, so all other cells take the fast path
+    unsigned moves(int cell) const
+    {
+        unsigned into = deadEnds.pocketMoves[static_cast<std::size_t>(cell)];
+        if (into == 0)
+            return 0xFF;
+        unsigned kept = 0xFF & ~into;
+        for (; into != 0; into &= into - 1)
+        {
+            const int d = __builtin_ctz(into);
+            kept |= keeps(cell + offsets[static_cast<std::size_t>(d)]) ? 1u << d : 0u;
+        }
+        return kept;
+    }
+};
+
+// Dijkstra or A* (as searchGrid) under the pockets' movement model, skipping hopeless pockets
+template <typename Trace = NullSearchTrace>
+SearchResult searchGridSkippingDeadEnds(const Grid &grid, const DeadEnds &deadEnds, Algorithm algorithm, int start, int goal,
+                                        SearchContext &context, Trace &&trace = Trace())
+{
+    const DeadEndPruning pruning(deadEnds, start, goal);
+    return withMovement(deadEnds.movement, [&](auto policy)
+                        {
+                            using Movement = decltype(policy);
+                            if (algorithm == Algorithm::AStar)
+                                return searchGridPruned<Movement>(grid, start, goal, context, typename Movement::Distance(grid, goal), pruning, trace);
+                            return searchGridPruned<Movement>(grid, start, goal, context, ZeroHeuristic(), pruning, trace); });
+}
@@ -0,0 +1,143 @@
+#include "goal_bounds.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <fstream>
+
+#include "thread_pool.hpp"
+
+// Records the order in which a Dijkstra settles cells; parents always come before children
+struct SettleOrderTrace
+{
+    std::vector<int> &order;
+
+    void opened(int) {}
+    void visited(int cell) { order.push_back(cell); }
+};
+
+// Fills the 8 boxes of source from its Dijkstra tree: each settled cell inherits the first
+// move of its parent, and the source's children take the move that reaches them
+static void boundSource(const Grid &grid, int source, const SearchContext &context, const std::vector<int> &order,
+                        std::vector<std::int8_t> &firstMove, GoalBox *boxes)
+{
+    const int W = grid.width;
+    const int sx = source % W, sy = source / W;
+    for (int cell : order)
+    {
+        const int parent = context.prev[static_cast<std::size_t>(cell)];
+        if (parent < 0)
+            continue;
+        std::int8_t move = firstMove[static_cast<std::size_t>(parent)];
+        if (parent == source)
+        {
+            for (int d = 0; d < 8; ++d)
+            {
+                if (sx + directions[static_cast<std::size_t>(d)].x == cell % W && sy + directions[static_cast<std::size_t>(d)].y == cell / W)
+                    move = static_cast<std::int8_t>(d);
+            }
+        }
+        firstMove[static_cast<std::size_t>(cell)] = move;
+
+        GoalBox &box = boxes[move];
+        const auto x = static_cast<std::uint16_t>(cell % W), y = static_cast<std::uint16_t>(cell / W);
+        box.x0 = std::min(box.x0, x);
+        box.y0 = std::min(box.y0, y);
+        box.x1 = std::max(box.x1, x);
+        box.y1 = std::max(box.y1, y);
+    }
+}
+
+template <typename Movement>
+static void buildWith(const Grid &grid, GoalBox *boxes, unsigned threads)
+{
+    const int cellCount = grid.cellCount();
+    const GoalBox empty{UINT16_MAX, UINT16_MAX, 0, 0};
+    std::fill(boxes, boxes + static_cast<std::size_t>(cellCount) * 8, empty);
+
+    // Contiguous source ranges, several per worker so uneven regions still balance
+    const int chunks = static_cast<int>(std::max(1u, threads) * 8);
+    const int chunkSize = (cellCount + chunks - 1) / chunks;
+    ThreadPool pool(threads);
+    for (int begin = 0; begin < cellCount; begin += chunkSize)
+    {
+        const int end = std::min(cellCount, begin + chunkSize);
+        pool.submit([&grid, boxes, begin, end]()
+                    {
+                        SearchContext context;
+                        std::vector<int> order;
+                        std::vector<std::int8_t> firstMove(static_cast<std::size_t>(grid.cellCount()), -1);
+                        for (int source = begin; source < end; ++source)
+                        {
+                            if (grid.walls[static_cast<std::size_t>(source)])
+                                continue;
+                            order.clear();
+                            searchGridWith<Movement>(grid, source, -1, context, ZeroHeuristic(), SettleOrderTrace{order});
+                            boundSource(grid, source, context, order, firstMove, boxes + static_cast<std::size_t>(source) * 8);
+                        }
+                    });
+    }
+    pool.wait();
+}
+
+GoalBounds buildGoalBounds(const Grid &grid, MovementModel movement, unsigned threads)
+{
+    GoalBounds bounds;
+    if (grid.width >= UINT16_MAX || grid.height >= UINT16_MAX)
+        return bounds;
+    bounds.movement = movement;
+    bounds.width = grid.width;
+    bounds.height = grid.height;
+    std::shared_ptr<GoalBox> storage(new GoalBox[static_cast<std::size_t>(grid.cellCount()) * 8], std::default_delete<GoalBox[]>());
+    withMovement(movement, [&](auto policy)
+                 { buildWith<decltype(policy)>(grid, storage.get(), threads); });
+    bounds.boxes = storage.get();
+    bounds.storage = storage;
+    return bounds;
+}
+
+bool saveGoalBounds(const GoalBounds &bounds, const std::string &path)
+{
+    if (!bounds.boxes)
+        return false;
+    GoalBoundsHeader header{GOAL_BOUNDS_MAGIC, GOAL_BOUNDS_VERSION, static_cast<std::uint8_t>(bounds.movement), 0,
+                            static_cast<std::uint16_t>(bounds.width), static_cast<std::uint16_t>(bounds.height),
+                            static_cast<std::uint32_t>(bounds.width * bounds.height)};
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(bounds.boxes), static_cast<std::streamsize>(bounds.memoryBytes()));
+    return static_cast<bool>(out);
+}
+
+bool mapGoalBounds(const std::string &path, GoalBounds &bounds)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    void *address = MAP_FAILED;
+    std::size_t bytes = 0;
+    if (::fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= sizeof(GoalBoundsHeader))
+    {
+        bytes = static_cast<std::size_t>(info.st_size);
+        address = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (address == MAP_FAILED)
+        return false;
+    std::shared_ptr<const void> mapping(address, [bytes](const void *base)
+                                        { ::munmap(const_cast<void *>(base), bytes); });
+
+    const auto *header = static_cast<const GoalBoundsHeader *>(address);
+    if (header->magic != GOAL_BOUNDS_MAGIC || header->version != GOAL_BOUNDS_VERSION || header->movement > 2 ||
+        header->cellCount != static_cast<std::uint32_t>(header->width) * header->height ||
+        bytes < sizeof(GoalBoundsHeader) + static_cast<std::size_t>(header->cellCount) * 8 * sizeof(GoalBox))
+        return false;
+    bounds.movement = static_cast<MovementModel>(header->movement);
+    bounds.width = header->width;
+    bounds.height = header->height;
+    bounds.boxes = reinterpret_cast<const GoalBox *>(header + 1);
+    bounds.storage = std::move(mapping);
+    return true;
+}
@@ -0,0 +1,88 @@
+// Goal bounding for static maps: for every cell and each of its 8 moves, the bounding box of
+// the goals whose shortest path from the cell starts with that move. A query skips moves whose
+// box does not contain its goal. The boxes are built with one Dijkstra per free cell, so the
+// precomputation is quadratic in the map size; they are stored as 16-bit coordinates and can be
+// saved to a file that later processes map read-only instead of rebuilding.
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "pathfinding.hpp"
+
+const std::uint32_t GOAL_BOUNDS_MAGIC = 0x42474650; // "PFGB"
+const std::uint16_t GOAL_BOUNDS_VERSION = 1;
+
+// Inclusive cell bounds; x0 > x1 for moves that start no shortest path
+struct GoalBox
+{
+    std::uint16_t x0, y0, x1, y1;
+
+    bool contains(int x, int y) const { return x >= x0 && x <= x1 && y >= y0 && y <= y1; }
+};
+
+// Header of a saved table; cellCount * 8 boxes follow it, in cell-major order
+struct GoalBoundsHeader
+{
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint8_t movement;
+    std::uint8_t reserved;
+    std::uint16_t width, height;
+    std::uint32_t cellCount;
+};
+
+static_assert(sizeof(GoalBox) == 8 && sizeof(GoalBoundsHeader) == 16, "goal bounds files use a fixed layout");
+
+struct GoalBounds
+{
+    MovementModel movement = MovementModel::CornerCutting;
+    int width = 0, height = 0;
+    const GoalBox *boxes = nullptr;      // cellCount * 8, in storage or in the mapped file
+    std::shared_ptr<const void> storage; // Owns boxes: a heap block or the file mapping
+
+    bool valid(const Grid &grid, MovementModel model) const { return boxes && width == grid.width && height == grid.height && movement == model; }
+    const GoalBox &box(int cell, int direction) const { return boxes[static_cast<std::size_t>(cell) * 8 + static_cast<std::size_t>(direction)]; }
+    std::size_t memoryBytes() const { return static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 8 * sizeof(GoalBox); }
+
+    // Moves out of cell whose box contains (goalX, goalY)
+    unsigned towards(int cell, int goalX, int goalY) const
+    {
+        const GoalBox *cellBoxes = boxes + static_cast<std::size_t>(cell) * 8;
+        unsigned mask = 0;
+        for (int d = 0; d < 8; ++d)
+            mask |= cellBoxes[d].contains(goalX, goalY) ? 1u << d : 0u;
+        return mask;
+    }
+};
+
+// Runs one Dijkstra per free cell on threads workers. The grid's sides must be below 65535.
+// Wall edits invalidate the table; it has to be rebuilt.
+GoalBounds buildGoalBounds(const Grid &grid, MovementModel movement, unsigned threads);
+
+// Writes the table to path; false on I/O errors
+bool saveGoalBounds(const GoalBounds &bounds, const std::string &path);
+
+// Maps a saved table read-only; false if the file is missing, truncated or of another version
+bool mapGoalBounds(const std::string &path, GoalBounds &bounds);
+
+// Keeps the moves whose goal box contains the goal
+struct GoalBoundsPruning
+{
+    const GoalBounds &bounds;
+    int goalX, goalY;
+
+    unsigned moves(int cell) const { return bounds.towards(cell, goalX, goalY); }
+};
+
+// A* that only relaxes the moves whose goal box contains the goal. Every cell on a shortest
+// path keeps the first move of one, so the search stays exact while most of the map's side
+// branches are never opened.
+template <typename Movement, typename Trace = NullSearchTrace>
+SearchResult searchGoalBounded(const Grid &grid, const GoalBounds &bounds, int start, int goal, SearchContext &context,
+                               Trace &&trace = Trace())
+{
+    return searchGridPruned<Movement>(grid, start, goal, context, typename Movement::Distance(grid, goal),
+                                      GoalBoundsPruning{bounds, goal % grid.width, goal / grid.width}, std::forward<Trace>(trace));
+}
@@ -0,0 +1,57 @@
+#include "landmarks.hpp"
+
+#include <cmath>
+
+#include "thread_pool.hpp"
+
+// Splits the map into count angular sectors around its center and takes the passable cell
+// farthest from the center in each, which spreads landmarks along the rim
+static std::vector<int> pickLandmarks(const Grid &grid, int count)
+{
+    const double pi = 3.14159265358979323846;
+    const double centerX = (grid.width - 1) / 2.0, centerY = (grid.height - 1) / 2.0;
+    std::vector<int> best(static_cast<std::size_t>(count), -1);
+    std::vector<double> bestDistance(static_cast<std::size_t>(count), -1.0);
+    for (int y = 0; y < grid.height; ++y)
+    {
+        for (int x = 0; x < grid.width; ++x)
+        {
+            if (grid.isWall(x, y))
+                continue;
+            double dx = x - centerX, dy = y - centerY;
+            int sector = static_cast<int>((std::atan2(dy, dx) + pi) / (2.0 * pi) * count);
+            sector = std::min(std::max(sector, 0), count - 1);
+            double distance = dx * dx + dy * dy;
+            if (distance > bestDistance[static_cast<std::size_t>(sector)])
+            {
+                bestDistance[static_cast<std::size_t>(sector)] = distance;
+                best[static_cast<std::size_t>(sector)] = grid.cellId(x, y);
+            }
+        }
+    }
+    best.erase(std::remove(best.begin(), best.end(), -1), best.end());
+    return best;
+}
+
+LandmarkSet buildLandmarks(const Grid &grid, int count, unsigned threads)
+{
+    LandmarkSet set;
+    set.cellCount = grid.cellCount();
+    set.cells = pickLandmarks(grid, std::min(std::max(count, 1), MAX_LANDMARKS));
+    set.distances.resize(set.cells.size() * static_cast<std::size_t>(set.cellCount));
+
+    ThreadPool pool(std::min<unsigned>(threads, static_cast<unsigned>(set.cells.size())));
+    for (int k = 0; k < set.count(); ++k)
+    {
+        pool.submit([&grid, &set, k]()
+                    {
+                        SearchContext context;
+                        searchGridWith(grid, set.cells[static_cast<std::size_t>(k)], -1, context, ZeroHeuristic());
+                        float *table = set.distances.data() + static_cast<std::size_t>(k) * static_cast<std::size_t>(set.cellCount);
+                        for (int cell = 0; cell < set.cellCount; ++cell)
+                            table[cell] = context.cost(cell);
+                    });
+    }
+    pool.wait();
+    return set;
+}
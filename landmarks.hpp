@@ -0,0 +1,57 @@
+// Landmark (ALT) heuristic for static maps: exact distances from a few landmark cells to
+// every cell bound the remaining distance through the triangle inequality,
+// h(n) >= |d(L, goal) - d(L, n)|. Tables are built once per map and shared by all queries.
+#pragma once
+
+#include <vector>
+
+#include "pathfinding.hpp"
+
+const int MAX_LANDMARKS = 16;
+
+struct LandmarkSet
+{
+    int cellCount = 0;
+    std::vector<int> cells;       // Landmark cell ids
+    std::vector<float> distances; // cells.size() tables of cellCount floats; float max where unreachable
+
+    int count() const { return static_cast<int>(cells.size()); }
+    bool empty() const { return cells.empty(); }
+    const float *table(int landmark) const { return distances.data() + static_cast<std::size_t>(landmark) * static_cast<std::size_t>(cellCount); }
+};
+
+// Picks up to count landmarks spread around the map's rim and runs one full Dijkstra per
+// landmark, in parallel on threads workers. count is clamped to MAX_LANDMARKS.
+LandmarkSet buildLandmarks(const Grid &grid, int count, unsigned threads);
+
+// max(octile, landmark bound). Both are consistent, so the maximum is as well.
+struct LandmarkHeuristic
+{
+    OctileHeuristic octile;
+    const LandmarkSet &set;
+    float goalDistances[MAX_LANDMARKS];
+    std::array<int, 8> offsets;
+
+    LandmarkHeuristic(const Grid &grid, const LandmarkSet &set, int goal)
+        : octile(grid, goal), set(set), offsets(neighborOffsets(grid.width))
+    {
+        for (int k = 0; k < set.count(); ++k)
+            goalDistances[k] = set.table(k)[goal];
+    }
+
+    float at(int cell) const
+    {
+        float bound = octile.at(cell);
+        for (int k = 0; k < set.count(); ++k)
+            bound = std::max(bound, std::abs(goalDistances[k] - set.table(k)[cell]));
+        return bound;
+    }
+
+    void successors(int cell, int x, int y, unsigned mask, float *out) const
+    {
+        octile.successors(cell, x, y, mask, out);
+        LandmarkInput input{set.distances.data(), static_cast<std::size_t>(set.cellCount), set.count(), goalDistances,
+                            cell, offsets.data()};
+        simdKernels.landmark(input, mask, out);
+    }
+};
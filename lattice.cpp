@@ -0,0 +1,27 @@
+#include "lattice.hpp"
+
+void writeLatticePath(const LatticeContext &context, int width, std::vector<int> &cells, std::vector<int> *headings)
+{
+    cells.clear();
+    if (headings)
+        headings->clear();
+    if (context.goalState < 0)
+        return;
+    const std::array<int, 8> offsets = neighborOffsets(width);
+
+    // A state's heading is the move that entered it, which leads back to the parent cell
+    for (int state = context.goalState;;)
+    {
+        const int cell = state >> 3, heading = state & 7;
+        cells.push_back(cell);
+        if (headings)
+            headings->push_back(heading);
+        const std::uint8_t parent = context.parent(state);
+        if (parent == LATTICE_START)
+            break;
+        state = (cell - offsets[static_cast<std::size_t>(heading)]) * 8 + parent;
+    }
+    std::reverse(cells.begin(), cells.end());
+    if (headings)
+        std::reverse(headings->begin(), headings->end());
+}
@@ -0,0 +1,130 @@
+// Heading-aware lattice search for vehicles that pay for turning. States are (cell, heading)
+// pairs with the 8 grid directions as headings; a move in direction d from heading h costs the
+// step plus a turn cost that depends on the angle between h and d, and leaves the vehicle
+// facing d. State ids are cell * 8 + heading. Because a state's heading is the move that
+// entered it, its parent cell is implied and only the parent's heading needs to be stored:
+// 4 bits per state, 16 states per 64-bit word.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "pathfinding.hpp"
+
+// Position of each direction around the compass, in 45 degree steps
+const int DIRECTION_COMPASS[8] = {0, 2, 4, 6, 1, 3, 7, 5};
+
+// Parent code of states that start a path
+const std::uint8_t LATTICE_START = 8;
+
+// Cost of turning by 0, 45, 90, 135 and 180 degrees
+struct TurnCosts
+{
+    float step[5] = {0.0f, 0.25f, 1.0f, 2.5f, 5.0f};
+
+    float between(int from, int to) const
+    {
+        const int turn = std::abs(DIRECTION_COMPASS[from] - DIRECTION_COMPASS[to]);
+        return step[std::min(turn, 8 - turn)];
+    }
+    float cheapest() const { return std::min({step[1], step[2], step[3], step[4]}); }
+};
+
+// Search state for lattice queries, reused across queries like SearchContext. Per state it
+// keeps g, a stamp and a parent nibble: 8.5 bytes, against 16 bytes per cell for grid search.
+struct LatticeContext : PackedParentContext<4>
+{
+    int goalState = -1; // State that reached the goal in the last search
+
+    void begin(int stateCount)
+    {
+        PackedParentContext<4>::begin(stateCount);
+        goalState = -1;
+    }
+};
+
+// The movement model's distance plus the cheapest turn whenever the goal is off the ray ahead:
+// such a path has to change heading at least once. Adding the bonus keeps the heuristic
+// consistent, as every move either stays off the ray or pays for a turn itself.
+template <typename Movement>
+struct LatticeHeuristic
+{
+    typename Movement::Distance distance;
+    int width, goalX, goalY;
+    float turnBonus;
+
+    LatticeHeuristic(const Grid &grid, int goal, const TurnCosts &turns)
+        : distance(grid, goal), width(grid.width), goalX(goal % grid.width), goalY(goal / grid.width), turnBonus(turns.cheapest())
+    {
+    }
+
+    float at(int cell, int heading) const
+    {
+        const int dx = goalX - cell % width, dy = goalY - cell / width;
+        const int hx = directions[static_cast<std::size_t>(heading)].x, hy = directions[static_cast<std::size_t>(heading)].y;
+        // On the ray when (dx, dy) is a non-negative multiple of the heading
+        const bool ahead = dx * hy == dy * hx && dx * hx >= 0 && dy * hy >= 0;
+        return distance.at(cell) + (ahead ? 0.0f : turnBonus);
+    }
+};
+
+// Dijkstra or A* over (cell, heading) states from start to goal (cell ids). startHeading is the
+// vehicle's initial heading, or -1 to let the first move pick one for free; any heading may
+// arrive at the goal. context.goalState names the goal state on success.
+template <typename Movement, typename Trace = NullSearchTrace>
+SearchResult searchLattice(const Grid &grid, Algorithm algorithm, int start, int startHeading, int goal, const TurnCosts &turns,
+                           LatticeContext &context, Trace &&trace = Trace())
+{
+    SearchResult result;
+    const std::array<int, 8> offsets = neighborOffsets(grid.width);
+    const LatticeHeuristic<Movement> heuristic(grid, goal, turns);
+    const bool informed = algorithm == Algorithm::AStar;
+
+    context.begin(grid.cellCount() * 8);
+    for (int heading = 0; heading < 8; ++heading)
+    {
+        if (startHeading >= 0 && heading != startHeading)
+            continue;
+        const int state = start * 8 + heading;
+        context.set(state, 0.0f, LATTICE_START);
+        context.push(informed ? heuristic.at(start, heading) : 0.0f, state);
+    }
+    trace.opened(start);
+
+    while (!context.open.empty())
+    {
+        const int state = openEntryCell(context.pop());
+        if (!context.close(state))
+            continue;
+        const int cell = state >> 3, heading = state & 7;
+        const float cg = context.g[static_cast<std::size_t>(state)];
+        ++result.expanded;
+        trace.visited(cell);
+        if (cell == goal)
+        {
+            context.goalState = state;
+            result.found = true;
+            result.cost = cg;
+            break;
+        }
+
+        for (unsigned moves = Movement::moves(grid.neighborMask(cell)); moves != 0; moves &= moves - 1)
+        {
+            const int d = __builtin_ctz(moves);
+            const int next = cell + offsets[static_cast<std::size_t>(d)];
+            const int nextState = next * 8 + d;
+            const float ng = cg + DIRECTION_COSTS[d] + turns.between(heading, d);
+            if (ng < context.cost(nextState))
+            {
+                context.set(nextState, ng, static_cast<std::uint8_t>(heading));
+                context.push(ng + (informed ? heuristic.at(next, d) : 0.0f), nextState);
+                trace.opened(next);
+            }
+        }
+    }
+    return result;
+}
+
+// Writes the cells (and optionally headings) of the path to the last search's goal state,
+// start to goal inclusive
+void writeLatticePath(const LatticeContext &context, int width, std::vector<int> &cells, std::vector<int> *headings = nullptr);
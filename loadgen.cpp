@@ -0,0 +1,363 @@
+// Load generator for the local query server. Uploads a random map, then drives batched
+// queries from several connections and reports latency percentiles and throughput.
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pathfinding.hpp"
+#include "protocol.hpp"
+#include "shm_channel.hpp"
+
+// Blocking client connection with one request in flight at a time
+class Client
+{
+public:
+    ~Client()
+    {
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    bool connect(const std::string &path)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+            return false;
+        std::strcpy(address.sun_path, path.c_str());
+        fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        return fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+    }
+
+    // Sends one request frame and waits for its reply
+    bool call(MessageType type, const std::vector<char> &payload, FrameHeader &reply, std::vector<char> &replyPayload)
+    {
+        FrameHeader header{static_cast<std::uint32_t>(payload.size()), ++lastRequestId, static_cast<std::uint8_t>(type), 0, 0};
+        if (!sendAll(&header, sizeof(header)) || !sendAll(payload.data(), payload.size()))
+            return false;
+        if (!receiveAll(&reply, sizeof(reply)) || reply.requestId != header.requestId)
+            return false;
+        replyPayload.resize(reply.length);
+        return receiveAll(replyPayload.data(), reply.length);
+    }
+
+private:
+    bool sendAll(const void *data, std::size_t size)
+    {
+        const char *bytes = static_cast<const char *>(data);
+        while (size > 0)
+        {
+            ssize_t n = ::send(fd, bytes, size, MSG_NOSIGNAL);
+            if (n <= 0)
+                return false;
+            bytes += n;
+            size -= static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    bool receiveAll(void *data, std::size_t size)
+    {
+        char *bytes = static_cast<char *>(data);
+        while (size > 0)
+        {
+            ssize_t n = ::recv(fd, bytes, size, 0);
+            if (n <= 0)
+                return false;
+            bytes += n;
+            size -= static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    int fd = -1;
+    std::uint32_t lastRequestId = 0;
+};
+
+struct LoadOptions
+{
+    std::string socketPath = DEFAULT_SOCKET_PATH;
+    int width = 256;
+    int height = 256;
+    double density = 0.25; // Fraction of cells that are walls
+    unsigned seed = 1;
+    std::uint32_t mapId = 1;
+    Algorithm algorithm = Algorithm::AStar;
+    MovementModel movement = MovementModel::CornerCutting;
+    int connections = 4;
+    int batches = 200; // Per connection
+    int batchSize = 16;
+    bool verify = false; // Check every returned cost against a local search
+    std::string shmName; // Send queries through the shared-memory channel instead of the socket
+};
+
+static Grid makeRandomGrid(const LoadOptions &options)
+{
+    Grid grid(options.width, options.height);
+    std::mt19937 rng(options.seed);
+    std::bernoulli_distribution isWall(options.density);
+    for (auto &cell : grid.walls)
+        cell = isWall(rng) ? 1 : 0;
+    grid.rebuildNeighbors();
+    return grid;
+}
+
+static double percentile(const std::vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    std::size_t index = static_cast<std::size_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size()))) - 1;
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static void printUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " [--socket PATH] [--width N] [--height N] [--density P] [--seed N]\n"
+              << "                [--algo dijkstra|astar] [--connections N] [--batches N] [--batch N] [--verify]\n"
+              << "                [--movement corner|no-corner|4] [--shm NAME]\n";
+}
+
+int main(int argc, char **argv)
+{
+    LoadOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--socket" && hasValue)
+            options.socketPath = argv[++i];
+        else if (arg == "--width" && hasValue)
+            options.width = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--height" && hasValue)
+            options.height = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--density" && hasValue)
+            options.density = std::atof(argv[++i]);
+        else if (arg == "--seed" && hasValue)
+            options.seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--algo" && hasValue)
+            options.algorithm = std::string(argv[++i]) == "dijkstra" ? Algorithm::Dijkstra : Algorithm::AStar;
+        else if (arg == "--movement" && hasValue)
+        {
+            std::string model = argv[++i];
+            options.movement = model == "no-corner" ? MovementModel::NoCornerCutting
+                               : model == "4"       ? MovementModel::FourConnected
+                                                    : MovementModel::CornerCutting;
+        }
+        else if (arg == "--connections" && hasValue)
+            options.connections = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--batches" && hasValue)
+            options.batches = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--batch" && hasValue)
+            options.batchSize = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--verify")
+            options.verify = true;
+        else if (arg == "--shm" && hasValue)
+            options.shmName = argv[++i];
+        else
+        {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    if (options.width > 65535 || options.height > 65535)
+    {
+        std::cerr << "Map dimensions must fit in 16 bits\n";
+        return 1;
+    }
+
+    Grid grid = makeRandomGrid(options);
+    std::vector<std::uint32_t> freeCells;
+    for (int id = 0; id < grid.cellCount(); ++id)
+    {
+        if (!grid.walls[static_cast<std::size_t>(id)])
+            freeCells.push_back(static_cast<std::uint32_t>(id));
+    }
+    if (freeCells.empty())
+    {
+        std::cerr << "Map has no free cells\n";
+        return 1;
+    }
+
+    // Upload the map once; it stays resident in the server for all connections
+    {
+        Client client;
+        if (!client.connect(options.socketPath))
+        {
+            std::cerr << "Cannot connect to " << options.socketPath << "\n";
+            return 1;
+        }
+        std::vector<char> payload, replyPayload;
+        appendPod(payload, LoadMapHeader{options.mapId, static_cast<std::uint16_t>(grid.width), static_cast<std::uint16_t>(grid.height)});
+        appendWallBits(payload, grid);
+        FrameHeader reply;
+        if (!client.call(MessageType::LoadMap, payload, reply, replyPayload) || reply.status != static_cast<std::uint8_t>(ReplyStatus::Ok))
+        {
+            std::cerr << "Map upload failed\n";
+            return 1;
+        }
+    }
+
+    // Every connection holds up to one batch of slots at a time, so they must all fit at once
+    ShmChannel channel;
+    if (!options.shmName.empty())
+    {
+        if (!channel.open(options.shmName))
+        {
+            std::cerr << "Cannot open shared-memory channel " << options.shmName << "\n";
+            return 1;
+        }
+        if (channel.slotCount() < static_cast<std::uint32_t>(options.connections * options.batchSize))
+        {
+            std::cerr << "Channel has " << channel.slotCount() << " slots, need connections * batch\n";
+            return 1;
+        }
+    }
+
+    std::vector<std::vector<double>> latencies(static_cast<std::size_t>(options.connections));
+    std::atomic<long long> pathsFound{0}, queriesSent{0}, mismatches{0};
+    std::atomic<bool> failed{false};
+
+    auto worker = [&](int index)
+    {
+        Client client;
+        if (options.shmName.empty() && !client.connect(options.socketPath))
+        {
+            failed = true;
+            return;
+        }
+        std::mt19937 rng(options.seed + static_cast<unsigned>(index) + 1);
+        std::uniform_int_distribution<std::size_t> pick(0, freeCells.size() - 1);
+        SearchContext context;
+        std::vector<int> localPath;
+        std::vector<char> payload, replyPayload;
+        std::vector<QueryPair> queries(static_cast<std::size_t>(options.batchSize));
+        std::vector<std::uint32_t> slots(queries.size());
+        auto &samples = latencies[static_cast<std::size_t>(index)];
+        samples.reserve(static_cast<std::size_t>(options.batches));
+
+        for (int b = 0; b < options.batches; ++b)
+        {
+            payload.clear();
+            appendPod(payload, QueryBatchHeader{options.mapId, static_cast<std::uint8_t>(options.algorithm),
+                                                static_cast<std::uint8_t>(options.movement), {0, 0},
+                                                static_cast<std::uint32_t>(options.batchSize)});
+            for (auto &query : queries)
+            {
+                query = {freeCells[pick(rng)], freeCells[pick(rng)]};
+                appendPod(payload, query);
+            }
+
+            auto check = [&](const QueryPair &query, bool found, float cost)
+            {
+                pathsFound += found;
+                if (options.verify)
+                {
+                    SearchResult local = findPath(grid, Algorithm::Dijkstra, options.movement, static_cast<int>(query.start),
+                                                  static_cast<int>(query.goal), localPath, context);
+                    if (local.found != found || (local.found && std::abs(local.cost - cost) > 1e-3f))
+                        ++mismatches;
+                }
+            };
+
+            auto sent = std::chrono::steady_clock::now();
+            if (!options.shmName.empty())
+            {
+                // Fill and submit one slot per query, then collect the paths written in place
+                for (std::size_t q = 0; q < queries.size(); ++q)
+                {
+                    std::uint32_t slotIndex = channel.acquire(static_cast<std::uint32_t>(index * options.batchSize));
+                    ShmSlot &slot = channel.slot(slotIndex);
+                    slot.mapId = options.mapId;
+                    slot.algorithm = static_cast<std::uint8_t>(options.algorithm);
+                    slot.movement = static_cast<std::uint8_t>(options.movement);
+                    slot.start = queries[q].start;
+                    slot.goal = queries[q].goal;
+                    channel.submit(slotIndex);
+                    slots[q] = slotIndex;
+                }
+                for (std::uint32_t slotIndex : slots)
+                    channel.wait(slotIndex);
+                auto received = std::chrono::steady_clock::now();
+                samples.push_back(std::chrono::duration<double, std::micro>(received - sent).count());
+                for (std::size_t q = 0; q < queries.size(); ++q)
+                {
+                    ShmSlot &slot = channel.slot(slots[q]);
+                    bool ok = slot.status == static_cast<std::uint8_t>(ShmStatus::Ok);
+                    check(queries[q], ok && slot.found != 0, slot.cost);
+                    channel.release(slots[q]);
+                    if (!ok)
+                        failed = true;
+                }
+                if (failed)
+                    return;
+            }
+            else
+            {
+                FrameHeader reply;
+                if (!client.call(MessageType::QueryBatch, payload, reply, replyPayload) || reply.status != static_cast<std::uint8_t>(ReplyStatus::Ok))
+                {
+                    failed = true;
+                    return;
+                }
+                auto received = std::chrono::steady_clock::now();
+                samples.push_back(std::chrono::duration<double, std::micro>(received - sent).count());
+
+                std::size_t offset = 0;
+                std::uint32_t count = 0;
+                readPod(replyPayload, offset, count);
+                for (std::uint32_t q = 0; q < count; ++q)
+                {
+                    PathHeader path;
+                    if (!readPod(replyPayload, offset, path))
+                    {
+                        failed = true;
+                        return;
+                    }
+                    offset += path.length * sizeof(std::uint32_t);
+                    check(queries[q], path.found != 0, path.cost);
+                }
+            }
+            queriesSent += options.batchSize;
+        }
+    };
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.connections; ++i)
+        threads.emplace_back(worker, i);
+    for (auto &thread : threads)
+        thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    if (failed)
+    {
+        std::cerr << "Request failed\n";
+        return 1;
+    }
+
+    std::vector<double> all;
+    for (const auto &samples : latencies)
+        all.insert(all.end(), samples.begin(), samples.end());
+    std::sort(all.begin(), all.end());
+
+    std::printf("map %dx%d density=%.2f, %d connections x %d batches x %d queries\n", options.width, options.height,
+                options.density, options.connections, options.batches, options.batchSize);
+    std::printf("batch latency us: p50=%.1f p90=%.1f p99=%.1f p99.9=%.1f max=%.1f\n", percentile(all, 50), percentile(all, 90),
+                percentile(all, 99), percentile(all, 99.9), all.empty() ? 0.0 : all.back());
+    std::printf("throughput: %.0f queries/s, %lld of %lld paths found\n", static_cast<double>(queriesSent) / seconds,
+                static_cast<long long>(pathsFound), static_cast<long long>(queriesSent));
+    if (options.verify)
+        std::printf("verify: %lld mismatches\n", static_cast<long long>(mismatches));
+    return mismatches == 0 ? 0 : 1;
+}
@@ -1,11 +1,28 @@
 #include <SFML/Graphics.hpp>
 #include <optional>
 #include <vector>
-#include <queue>
-#include <cmath>
-#include <limits>
 #include <algorithm>
-#include <array>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+#include "alternatives.hpp"
+#include "clearance.hpp"
+#include "dead_ends.hpp"
+#include "metrics.hpp"
+#include "navmesh.hpp"
+#include "pathfinding.hpp"
+#include "rsr.hpp"
+#include "subgoals.hpp"
+#include "thread_pool.hpp"
+#include "topology.hpp"
+#include "voxels.hpp"
 
 // Define constants for better readability and maintainability
 const int GRID_SIZE = 20;
@@ -16,15 +33,9 @@ const float BUTTON_PADDING = 20.f;
 const float TEXT_OFFSET_X = 10.f;
 const float TEXT_OFFSET_Y = 5.f;
 const int PANEL_WIDTH_ADDITION = 200; // Additional width for the panel
-
-// Define costs for movement
-const float CARDINAL_COST = 1.0f;
-const float DIAGONAL_COST = std::sqrt(2.0f); // Approximately 1.414
-
-// Directions for 8-directional movement (static const to avoid re-creation)
-static const std::array<sf::Vector2i, 8> directions = {
-    sf::Vector2i(1, 0), sf::Vector2i(0, 1), sf::Vector2i(-1, 0), sf::Vector2i(0, -1),
-    sf::Vector2i(1, 1), sf::Vector2i(-1, 1), sf::Vector2i(1, -1), sf::Vector2i(-1, -1)};
+const int VOXEL_LAYERS = 6;           // Layers of the 3D view; the walls rise through the lower half
+// Pixels per cell unit in the hex view, so the half-cell shift of odd rows still fits the grid area
+const float HEX_CELL_SIZE = GRID_SIZE * CELL_SIZE / (GRID_SIZE + 0.5f);
 
 // Struct to store animation steps with direct colors
 struct AnimationStep
@@ -33,8 +44,977 @@ struct AnimationStep
     sf::Color color; // The color this cell should become at this step
 };
 
-int main()
+// Base color of a cell with no search overlay: walls white, ground orange
+static sf::Color baseCellColor(bool isWall)
+{
+    return isWall ? sf::Color::White : sf::Color(255, 200, 0);
+}
+
+// Resets every cell to its base color: walls white, ground orange, start/end blue
+static void resetGridColors(std::vector<std::vector<sf::Color>> &gridColors, const Grid &grid,
+                            int startX, int startY, int endX, int endY)
+{
+    for (int r = 0; r < GRID_SIZE; ++r)
+    {
+        for (int c = 0; c < GRID_SIZE; ++c)
+        {
+            gridColors[r][c] = baseCellColor(grid.isWall(c, r));
+        }
+    }
+    // Start and End nodes are always blue and override other colors
+    gridColors[startY][startX] = sf::Color::Blue;
+    gridColors[endY][endX] = sf::Color::Blue;
+}
+
+// Applies a single animation step to the grid colors
+static void applyAnimationStep(std::vector<std::vector<sf::Color>> &gridColors, const AnimationStep &step,
+                               int startX, int startY, int endX, int endY)
+{
+    // Only update if it's not the start/end node, which should always remain blue
+    if (!((step.coord.x == startX && step.coord.y == startY) || (step.coord.x == endX && step.coord.y == endY)))
+    {
+        gridColors[step.coord.y][step.coord.x] = step.color;
+    }
+}
+
+// One wall change: cell id plus old/new state, 4 bytes per edit
+struct CellEdit
+{
+    std::uint16_t cell; // y * GRID_SIZE + x
+    std::uint8_t oldWall;
+    std::uint8_t newWall;
+};
+
+// Undo/redo history stored as a flat edit log, with edits grouped per mouse gesture.
+// Undo and redo replay edits through the caller's edit function, so they are ordinary local edits.
+class EditLog
+{
+public:
+    void record(int x, int y, bool oldWall, bool newWall)
+    {
+        // A new edit after undoing discards the redo history
+        if (appliedGestures < gestureEnds.size())
+        {
+            gestureEnds.resize(appliedGestures);
+            edits.resize(appliedGestures == 0 ? 0 : gestureEnds.back());
+        }
+        edits.push_back({static_cast<std::uint16_t>(y * GRID_SIZE + x), static_cast<std::uint8_t>(oldWall),
+                         static_cast<std::uint8_t>(newWall)});
+    }
+
+    // Closes the current gesture; does nothing if it recorded no edits
+    void endGesture()
+    {
+        std::size_t committed = gestureEnds.empty() ? 0 : gestureEnds.back();
+        if (edits.size() > committed)
+        {
+            gestureEnds.push_back(edits.size());
+            appliedGestures = gestureEnds.size();
+        }
+    }
+
+    // Applies the inverse of the last gesture's edits in reverse order
+    template <typename ApplyEdit>
+    bool undo(ApplyEdit applyEdit)
+    {
+        endGesture();
+        if (appliedGestures == 0)
+            return false;
+        std::size_t begin = appliedGestures >= 2 ? gestureEnds[appliedGestures - 2] : 0;
+        std::size_t end = gestureEnds[appliedGestures - 1];
+        for (std::size_t i = end; i-- > begin;)
+            applyEdit(edits[i].cell % GRID_SIZE, edits[i].cell / GRID_SIZE, edits[i].oldWall != 0);
+        --appliedGestures;
+        return true;
+    }
+
+    // Re-applies the next undone gesture's edits in their original order
+    template <typename ApplyEdit>
+    bool redo(ApplyEdit applyEdit)
+    {
+        if (appliedGestures == gestureEnds.size())
+            return false;
+        std::size_t begin = appliedGestures == 0 ? 0 : gestureEnds[appliedGestures - 1];
+        std::size_t end = gestureEnds[appliedGestures];
+        for (std::size_t i = begin; i < end; ++i)
+            applyEdit(edits[i].cell % GRID_SIZE, edits[i].cell / GRID_SIZE, edits[i].newWall != 0);
+        ++appliedGestures;
+        return true;
+    }
+
+private:
+    std::vector<CellEdit> edits;
+    std::vector<std::size_t> gestureEnds; // End offset into edits for every committed gesture
+    std::size_t appliedGestures = 0;      // Gestures currently applied; the rest are redoable
+};
+
+// Records the engine's open/visited events as animation steps, leaving start/end untouched
+struct AnimationTrace
+{
+    std::vector<AnimationStep> &steps;
+    int startCell, endCell;
+
+    void opened(int cell)
+    {
+        // Mark as open (cyan), unless it's the end node; the start node is initially 'open'
+        if (cell != endCell)
+            steps.push_back({sf::Vector2i(cell % GRID_SIZE, cell / GRID_SIZE), sf::Color::Cyan});
+    }
+
+    void visited(int cell)
+    {
+        // Mark as visited (grey), unless it's the start/end node
+        if (cell != startCell && cell != endCell)
+            steps.push_back({sf::Vector2i(cell % GRID_SIZE, cell / GRID_SIZE), sf::Color(100, 100, 100)});
+    }
+};
+
+// Path colors: green for Dijkstra, magenta for A*
+static sf::Color pathColor(Algorithm algorithm)
+{
+    return algorithm == Algorithm::Dijkstra ? sf::Color::Green : sf::Color(255, 0, 255);
+}
+
+// Runs a search and records the exploration and the final path as animation steps. Agents
+// larger than one cell search with Annotated A* over clearance, and every agent skips hopeless
+// pockets when deadEnds is given. Returns false if the end node is unreachable.
+static bool buildSearchAnimation(const Grid &grid, Algorithm algorithm, MovementModel movement, int startX, int startY,
+                                 int endX, int endY, std::vector<AnimationStep> &steps, const DeadEnds *deadEnds = nullptr,
+                                 const ClearanceMap *clearance = nullptr, int agentSize = 1)
+{
+    static SearchContext context;
+    std::vector<int> path;
+    int startCell = grid.cellId(startX, startY);
+    int endCell = grid.cellId(endX, endY);
+    auto searchStart = std::chrono::steady_clock::now();
+    SearchResult result;
+    if ((clearance && agentSize > 1) || deadEnds)
+    {
+        if (clearance && agentSize > 1 && deadEnds)
+            result = searchAnnotatedPruned(grid, *clearance, agentSize, algorithm, movement, startCell, endCell, context,
+                                           DeadEndPruning(*deadEnds, startCell, endCell), AnimationTrace{steps, startCell, endCell});
+        else if (clearance && agentSize > 1)
+            result = searchAnnotated(grid, *clearance, agentSize, algorithm, movement, startCell, endCell, context,
+                                     AnimationTrace{steps, startCell, endCell});
+        else
+            result = searchGridSkippingDeadEnds(grid, *deadEnds, algorithm, startCell, endCell, context, AnimationTrace{steps, startCell, endCell});
+        if (result.found)
+        {
+            path.resize(static_cast<std::size_t>(pathLength(context, endCell)));
+            writePath(context, endCell, path.data(), static_cast<int>(path.size()));
+        }
+    }
+    else
+        result = findPath(grid, algorithm, movement, startCell, endCell, path, context, AnimationTrace{steps, startCell, endCell});
+    recordQuery(algorithm, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - searchStart).count()),
+                result.expanded, result.found);
+
+    // Add path steps to animation after all search steps
+    for (int cell : path)
+    {
+        if (cell != startCell && cell != endCell)
+        {
+            steps.push_back({sf::Vector2i(cell % GRID_SIZE, cell / GRID_SIZE), pathColor(algorithm)});
+        }
+    }
+    return result.found;
+}
+
+// The 3D view's world: the walls extruded through the lower half of the layers, under a ceiling
+// with a shaft every 6 cells
+static VoxelGrid buildVoxelWorld(const Grid &grid)
+{
+    VoxelGrid world(GRID_SIZE, GRID_SIZE, VOXEL_LAYERS);
+    for (int y = 0; y < GRID_SIZE; ++y)
+    {
+        for (int x = 0; x < GRID_SIZE; ++x)
+        {
+            for (int z = 0; z < VOXEL_LAYERS / 2; ++z)
+                world.setSolid(x, y, z, grid.isWall(x, y));
+            world.setSolid(x, y, VOXEL_LAYERS / 2, x % 6 != 3 || y % 6 != 3); // Ceiling with shafts
+        }
+    }
+    return world;
+}
+
+// 26-connected A* through the 3D world from the start on the bottom layer to the end on the top
+// one; path receives the voxel ids (empty if there is none)
+static SearchResult searchVoxelWorld(const VoxelGrid &world, int startX, int startY, int endX, int endY, std::vector<int> &path)
+{
+    static VoxelContext context;
+    const int goal = world.voxelId(endX, endY, VOXEL_LAYERS - 1);
+    SearchResult result = searchVoxels(world, Algorithm::AStar, VoxelConnectivity::TwentySix, world.voxelId(startX, startY, 0), goal, context);
+    writeVoxelPath(world, context, goal, path);
+    return result;
+}
+
+// Colors one layer of the 3D view: solid voxels white, path voxels in the layer magenta, and path
+// voxels in other layers pale pink
+static void colorVoxelSlice(std::vector<std::vector<sf::Color>> &gridColors, const VoxelGrid &world, const std::vector<int> &path, int slice)
+{
+    for (int y = 0; y < GRID_SIZE; ++y)
+    {
+        for (int x = 0; x < GRID_SIZE; ++x)
+            gridColors[y][x] = baseCellColor(world.isSolid(x, y, slice));
+    }
+    for (int id : path)
+    {
+        int x, y, z;
+        world.coordinates(id, x, y, z);
+        if (z == slice)
+            gridColors[y][x] = sf::Color(255, 0, 255);
+        else if (gridColors[y][x] != sf::Color(255, 0, 255))
+            gridColors[y][x] = sf::Color(255, 190, 255);
+    }
+}
+
+// The square topology recorded for a movement model when a session leaves the hex view; replays
+// search square cells under the recorded movement model either way
+static GridTopology squareTopology(MovementModel movement)
+{
+    return movement == MovementModel::FourConnected ? GridTopology::SquareFour : GridTopology::SquareEight;
+}
+
+// buildSearchAnimation under a cell topology, for the hex view
+static bool buildTopologyAnimation(const Grid &grid, Algorithm algorithm, GridTopology topology, int startX, int startY, int endX, int endY,
+                                   std::vector<AnimationStep> &steps)
+{
+    static SearchContext context;
+    std::vector<int> path;
+    int startCell = grid.cellId(startX, startY);
+    int endCell = grid.cellId(endX, endY);
+    auto searchStart = std::chrono::steady_clock::now();
+    SearchResult result = findTopologyPath(grid, algorithm, topology, startCell, endCell, path, context, AnimationTrace{steps, startCell, endCell});
+    recordQuery(algorithm, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - searchStart).count()),
+                result.expanded, result.found);
+    for (int cell : path)
+    {
+        if (cell != startCell && cell != endCell)
+            steps.push_back({sf::Vector2i(cell % GRID_SIZE, cell / GRID_SIZE), pathColor(algorithm)});
+    }
+    return result.found;
+}
+
+// Runs RSR on a fresh rectangle decomposition and records its expansions and refined path.
+// report receives its expansion count next to plain A*'s on the same query.
+static bool buildRsrAnimation(const Grid &grid, MovementModel movement, int startX, int startY, int endX, int endY,
+                              std::vector<AnimationStep> &steps, RectangleDecomposition &decomposition, std::string &report,
+                              const DeadEnds *deadEnds = nullptr)
+{
+    static SearchContext context;
+    int startCell = grid.cellId(startX, startY);
+    int endCell = grid.cellId(endX, endY);
+    decomposition = decomposeRectangles(grid, std::max(1u, std::thread::hardware_concurrency()));
+    SearchResult astar = searchGrid(grid, Algorithm::AStar, movement, startCell, endCell, context);
+    SearchResult result = withMovement(movement, [&](auto policy)
+                                       {
+                                           using Movement = decltype(policy);
+                                           if (deadEnds)
+                                               return searchRsrPruned<Movement>(grid, decomposition, startCell, endCell, context,
+                                                                                DeadEndPruning(*deadEnds, startCell, endCell),
+                                                                                AnimationTrace{steps, startCell, endCell});
+                                           return searchRsr<Movement>(grid, decomposition, startCell, endCell, context,
+                                                                      AnimationTrace{steps, startCell, endCell}); });
+    report = "Expanded: RSR " + std::to_string(result.expanded) + ", A* " + std::to_string(astar.expanded);
+    if (!result.found)
+        return false;
+
+    std::vector<int> path;
+    refineRsrPath(context, endCell, grid.width, movement != MovementModel::FourConnected, path);
+    for (int cell : path)
+    {
+        if (cell != startCell && cell != endCell)
+            steps.push_back({sf::Vector2i(cell % GRID_SIZE, cell / GRID_SIZE), sf::Color::Yellow});
+    }
+    return true;
+}
+
+// Runs a subgoal graph search (graph kept current by the caller) and records its expansions and
+// refined path; report compares its expansions with plain A*'s
+static bool buildSubgoalAnimation(const Grid &grid, const SubgoalGraph &subgoals, MovementModel movement, int startX, int startY,
+                                  int endX, int endY, std::vector<AnimationStep> &steps, std::string &report,
+                                  const DeadEnds *deadEnds = nullptr)
+{
+    static SearchContext context;
+    int startCell = grid.cellId(startX, startY);
+    int endCell = grid.cellId(endX, endY);
+    SearchResult astar = searchGrid(grid, Algorithm::AStar, movement, startCell, endCell, context);
+    std::vector<int> path;
+    SearchResult result = withMovement(movement, [&](auto policy)
+                                       {
+                                           using Movement = decltype(policy);
+                                           SearchResult search =
+                                               deadEnds ? searchSubgoalGraphPruned<Movement>(grid, subgoals, startCell, endCell, context,
+                                                                                             DeadEndPruning(*deadEnds, startCell, endCell),
+                                                                                             AnimationTrace{steps, startCell, endCell})
+                                                        : searchSubgoalGraph<Movement>(grid, subgoals, startCell, endCell, context,
+                                                                                       AnimationTrace{steps, startCell, endCell});
+                                           if (search.found)
+                                               refineSubgoalPath<Movement>(grid, context, endCell, path);
+                                           return search; });
+    report = "Subgoals: " + std::to_string(subgoals.globalCount()) + " global of " + std::to_string(subgoals.subgoalCount()) +
+             "\nExpanded: subgoals " + std::to_string(result.expanded) + ", A* " + std::to_string(astar.expanded);
+    for (int cell : path)
+    {
+        if (cell != startCell && cell != endCell)
+            steps.push_back({sf::Vector2i(cell % GRID_SIZE, cell / GRID_SIZE), sf::Color::Yellow});
+    }
+    return result.found;
+}
+
+// Draws each edge between two global subgoals once, from cell center to cell center
+static void appendSubgoalEdges(sf::VertexArray &lines, const SubgoalGraph &subgoals, sf::Color color)
+{
+    auto center = [&](int cell)
+    { return sf::Vector2f((static_cast<float>(cell % subgoals.width) + 0.5f) * CELL_SIZE, (static_cast<float>(cell / subgoals.width) + 0.5f) * CELL_SIZE); };
+    for (std::size_t s = 0; s < subgoals.cells.size(); ++s)
+    {
+        if (subgoals.cells[s] < 0 || !subgoals.global[s])
+            continue;
+        for (const auto *list : {&subgoals.edges[s], &subgoals.shortcuts[s]})
+        {
+            for (const SubgoalEdge &edge : *list)
+            {
+                if (static_cast<std::size_t>(edge.to) <= s || !subgoals.global[static_cast<std::size_t>(edge.to)])
+                    continue;
+                lines.append(sf::Vertex{center(subgoals.cells[s]), color, {}});
+                lines.append(sf::Vertex{center(subgoals.cells[static_cast<std::size_t>(edge.to)]), color, {}});
+            }
+        }
+    }
+}
+
+// Outlines every rectangle of a decomposition as line segments in grid pixel coordinates
+static void appendRectangleOutlines(sf::VertexArray &lines, const RectangleDecomposition &decomposition, sf::Color color)
+{
+    for (const GridRect &rect : decomposition.rects)
+    {
+        const float left = static_cast<float>(rect.x * CELL_SIZE) + 2.f, top = static_cast<float>(rect.y * CELL_SIZE) + 2.f;
+        const float right = static_cast<float>((rect.x + rect.width) * CELL_SIZE) - 2.f;
+        const float bottom = static_cast<float>((rect.y + rect.height) * CELL_SIZE) - 2.f;
+        const sf::Vector2f corners[4] = {{left, top}, {right, top}, {right, bottom}, {left, bottom}};
+        for (int i = 0; i < 4; ++i)
+        {
+            lines.append(sf::Vertex{corners[i], color, {}});
+            lines.append(sf::Vertex{corners[(i + 1) % 4], color, {}});
+        }
+    }
+}
+
+// Appends a polyline in grid units (cell (x, y) spans [x, x + 1)) as line segments in pixels
+static void appendPolyline(sf::VertexArray &lines, const std::vector<NavPoint> &points, sf::Color color)
+{
+    for (std::size_t i = 1; i < points.size(); ++i)
+    {
+        for (const NavPoint &point : {points[i - 1], points[i]})
+            lines.append(sf::Vertex{{point.x * CELL_SIZE, point.y * CELL_SIZE}, color, {}});
+    }
+}
+
+// Appends alternative paths through cell centers, one color each; each path is nudged off the
+// centers by a different amount so overlapping stretches stay visible
+static void appendAlternativePaths(sf::VertexArray &lines, const std::vector<AlternativePath> &paths, int width)
+{
+    const sf::Color colors[] = {sf::Color::Yellow, sf::Color::Cyan, sf::Color(255, 0, 255), sf::Color::Green, sf::Color(255, 120, 0), sf::Color::Red};
+    for (std::size_t i = 0; i < paths.size(); ++i)
+    {
+        const float nudge = 0.5f + 0.1f * (static_cast<float>(i % 5) - 2.0f);
+        std::vector<NavPoint> points;
+        for (int cell : paths[i].cells)
+            points.push_back({static_cast<float>(cell % width) + nudge, static_cast<float>(cell / width) + nudge});
+        appendPolyline(lines, points, colors[i % (sizeof(colors) / sizeof(colors[0]))]);
+    }
+}
+
+// Draws the grid cells and the start/end overlay onto any render target (window or offscreen texture)
+static void drawGrid(sf::RenderTarget &target, const std::vector<std::vector<sf::Color>> &gridColors,
+                     int startX, int startY, int endX, int endY)
+{
+    // Draw grid cells based on their current color in gridColors
+    sf::RectangleShape cellShape;
+    cellShape.setOutlineThickness(1.f);
+    cellShape.setOutlineColor(sf::Color::Red);
+    cellShape.setSize(sf::Vector2f(static_cast<float>(CELL_SIZE), static_cast<float>(CELL_SIZE)));
+
+    for (int r = 0; r < GRID_SIZE; ++r)
+    {
+        for (int c = 0; c < GRID_SIZE; ++c)
+        {
+            cellShape.setFillColor(gridColors[r][c]);
+            cellShape.setPosition(sf::Vector2f(static_cast<float>(c * CELL_SIZE), static_cast<float>(r * CELL_SIZE)));
+            target.draw(cellShape);
+        }
+    }
+
+    // Ensure Start and End cells are always blue and drawn on top
+    // This is important because animation steps might temporarily color them
+    sf::RectangleShape startShape(sf::Vector2f(static_cast<float>(CELL_SIZE), static_cast<float>(CELL_SIZE)));
+    startShape.setFillColor(sf::Color::Blue);
+    startShape.setPosition(sf::Vector2f(static_cast<float>(startX * CELL_SIZE), static_cast<float>(startY * CELL_SIZE)));
+    target.draw(startShape);
+
+    sf::RectangleShape endShape(sf::Vector2f(static_cast<float>(CELL_SIZE), static_cast<float>(CELL_SIZE)));
+    endShape.setFillColor(sf::Color::Blue);
+    endShape.setPosition(sf::Vector2f(static_cast<float>(endX * CELL_SIZE), static_cast<float>(endY * CELL_SIZE)));
+    target.draw(endShape);
+}
+
+// drawGrid for the hex view: every hex is a fan of four triangles in one vertex array, with the
+// outlines in a second one, so the whole grid takes two draw calls
+static void drawHexGrid(sf::RenderTarget &target, const std::vector<std::vector<sf::Color>> &gridColors,
+                        int startX, int startY, int endX, int endY)
+{
+    sf::VertexArray cells(sf::PrimitiveType::Triangles);
+    sf::VertexArray outlines(sf::PrimitiveType::Lines);
+    PlanePoint corners[HexSix::cornerCount];
+    for (int r = 0; r < GRID_SIZE; ++r)
+    {
+        for (int c = 0; c < GRID_SIZE; ++c)
+        {
+            const sf::Color color = (c == startX && r == startY) || (c == endX && r == endY) ? sf::Color::Blue : gridColors[r][c];
+            HexSix::corners(c, r, corners);
+            sf::Vector2f points[HexSix::cornerCount];
+            for (int i = 0; i < HexSix::cornerCount; ++i)
+                points[i] = {corners[i].x * HEX_CELL_SIZE, corners[i].y * HEX_CELL_SIZE};
+            for (int i = 1; i + 1 < HexSix::cornerCount; ++i)
+            {
+                cells.append(sf::Vertex{points[0], color, {}});
+                cells.append(sf::Vertex{points[i], color, {}});
+                cells.append(sf::Vertex{points[i + 1], color, {}});
+            }
+            for (int i = 0; i < HexSix::cornerCount; ++i)
+            {
+                outlines.append(sf::Vertex{points[i], sf::Color::Red, {}});
+                outlines.append(sf::Vertex{points[(i + 1) % HexSix::cornerCount], sf::Color::Red, {}});
+            }
+        }
+    }
+    target.draw(cells);
+    target.draw(outlines);
+}
+
+// Loads walls from a text map, cropped or padded to the visualizer's grid
+static bool loadWallMap(const std::string &path, Grid &grid)
+{
+    Grid loaded;
+    if (!loadGridFile(path, loaded))
+        return false;
+    for (int r = 0; r < GRID_SIZE && r < loaded.height; ++r)
+    {
+        for (int c = 0; c < GRID_SIZE && c < loaded.width; ++c)
+        {
+            grid.setWall(c, r, loaded.isWall(c, r));
+        }
+    }
+    return true;
+}
+
+// Options for rendering searches offscreen without opening a window
+struct HeadlessOptions
+{
+    std::string algorithm = "both"; // "dijkstra", "astar" or "both"
+    std::string mapPath;            // Optional wall map, empty grid if not given
+    std::string outputDir = ".";
+    MovementModel movement = MovementModel::CornerCutting;
+    int frameEvery = 0;       // Export every Nth animation step, 0 exports only the final state
+    unsigned encoderThreads = std::max(1u, std::thread::hardware_concurrency());
+};
+
+// Renders the chosen searches into an sf::RenderTexture and exports frames as PNGs.
+// Encoding happens on a thread pool so capture does not stall the animation replay.
+static int runHeadless(const HeadlessOptions &options)
+{
+    Grid grid(GRID_SIZE, GRID_SIZE);
+    std::vector<std::vector<sf::Color>> gridColors(GRID_SIZE, std::vector<sf::Color>(GRID_SIZE));
+    int startX = 0, startY = 0;
+    int endX = GRID_SIZE - 1, endY = GRID_SIZE - 1;
+
+    if (!options.mapPath.empty() && !loadWallMap(options.mapPath, grid))
+    {
+        std::cerr << "Failed to load map: " << options.mapPath << "\n";
+        return 1;
+    }
+    // Start and end are never walls
+    grid.setWall(startX, startY, false);
+    grid.setWall(endX, endY, false);
+
+    sf::RenderTexture texture;
+    const unsigned size = static_cast<unsigned>(GRID_SIZE * CELL_SIZE);
+    if (!texture.resize({size, size}))
+    {
+        std::cerr << "Failed to create offscreen render texture\n";
+        return 1;
+    }
+
+    ThreadPool encoders(options.encoderThreads);
+    std::mutex errorMutex;
+    int failedWrites = 0;
+
+    // Snapshot the current grid on this thread (needs the GL context), then encode on the pool
+    auto captureFrame = [&](const std::string &fileName)
+    {
+        texture.clear(sf::Color::Black);
+        drawGrid(texture, gridColors, startX, startY, endX, endY);
+        texture.display();
+        std::string path = options.outputDir + "/" + fileName;
+        encoders.submit([image = texture.getTexture().copyToImage(), path, &errorMutex, &failedWrites]()
+                        {
+                            if (!image.saveToFile(path))
+                            {
+                                std::lock_guard<std::mutex> lock(errorMutex);
+                                ++failedWrites;
+                                std::cerr << "Failed to write " << path << "\n";
+                            } });
+    };
+
+    struct Run
+    {
+        const char *name;
+        Algorithm algorithm;
+    };
+    std::vector<Run> runs;
+    if (options.algorithm == "dijkstra" || options.algorithm == "both")
+        runs.push_back({"dijkstra", Algorithm::Dijkstra});
+    if (options.algorithm == "astar" || options.algorithm == "both")
+        runs.push_back({"astar", Algorithm::AStar});
+    if (runs.empty())
+    {
+        std::cerr << "Unknown algorithm: " << options.algorithm << "\n";
+        return 1;
+    }
+
+    for (const auto &run : runs)
+    {
+        std::vector<AnimationStep> steps;
+        auto searchStart = std::chrono::steady_clock::now();
+        bool found = buildSearchAnimation(grid, run.algorithm, options.movement, startX, startY, endX, endY, steps);
+        auto searchEnd = std::chrono::steady_clock::now();
+
+        resetGridColors(gridColors, grid, startX, startY, endX, endY);
+        int frames = 0;
+        for (std::size_t i = 0; i < steps.size(); ++i)
+        {
+            applyAnimationStep(gridColors, steps[i], startX, startY, endX, endY);
+            if (options.frameEvery > 0 && (i + 1) % static_cast<std::size_t>(options.frameEvery) == 0)
+            {
+                char fileName[64];
+                std::snprintf(fileName, sizeof(fileName), "%s_%06zu.png", run.name, i + 1);
+                captureFrame(fileName);
+                ++frames;
+            }
+        }
+        captureFrame(std::string(run.name) + "_final.png");
+        ++frames;
+
+        std::cout << run.name << ": " << (found ? "path found" : "no path found")
+                  << ", steps=" << steps.size()
+                  << ", search_us=" << std::chrono::duration_cast<std::chrono::microseconds>(searchEnd - searchStart).count()
+                  << ", frames=" << frames << "\n";
+    }
+
+    encoders.wait();
+    return failedWrites == 0 ? 0 : 1;
+}
+
+// Recorded session format (all integers little-endian):
+//   header: "PFS1", u16 grid size, u16 start cell, u16 end cell, initial walls as a row-major bitset
+//   events: u32 milliseconds since session start, u8 event type, u8 reserved, u16 cell id
+//           (for the Set* events the u16 holds the new setting instead)
+const char SESSION_MAGIC[4] = {'P', 'F', 'S', '1'};
+
+enum class SessionEventType : std::uint8_t
+{
+    ToggleWall = 0,
+    RunDijkstra = 1,
+    RunAstar = 2,
+    SetMovement = 3,
+    SetDeadEnds = 4, // 1 while searches skip dead-end pockets
+    SetAgentSize = 5,
+    SetTopology = 6, // GridTopology; the square ones mean square cells under the current movement model
+    RunRsr = 7,
+    RunSubgoals = 8,
+    RunNavMesh = 9,
+    RunAlternatives = 10, // 0 for Yen's K shortest paths, 1 for the penalty method
+    RunVoxels = 11,
+    SetVoxelLayer = 12 // Layer of the 3D view on screen
+};
+
+struct SessionEvent
+{
+    std::uint32_t timeMs;
+    SessionEventType type;
+    std::uint16_t cell; // y * GRID_SIZE + x for ToggleWall, the setting for the Set* events
+};
+
+struct Session
+{
+    Grid initialGrid;
+    int startX = 0, startY = 0;
+    int endX = 0, endY = 0;
+    std::vector<SessionEvent> events;
+};
+
+static void writeU16(std::ostream &out, std::uint16_t v)
+{
+    const char bytes[2] = {static_cast<char>(v & 0xFF), static_cast<char>(v >> 8)};
+    out.write(bytes, 2);
+}
+
+static void writeU32(std::ostream &out, std::uint32_t v)
+{
+    writeU16(out, static_cast<std::uint16_t>(v & 0xFFFF));
+    writeU16(out, static_cast<std::uint16_t>(v >> 16));
+}
+
+static bool readU16(std::istream &in, std::uint16_t &v)
+{
+    unsigned char bytes[2];
+    if (!in.read(reinterpret_cast<char *>(bytes), 2))
+        return false;
+    v = static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+    return true;
+}
+
+static bool readU32(std::istream &in, std::uint32_t &v)
+{
+    std::uint16_t lo, hi;
+    if (!readU16(in, lo) || !readU16(in, hi))
+        return false;
+    v = static_cast<std::uint32_t>(lo) | (static_cast<std::uint32_t>(hi) << 16);
+    return true;
+}
+
+// Appends input events to a session log as they happen, so a crash still leaves a usable recording
+class SessionRecorder
+{
+public:
+    bool open(const std::string &path, const Grid &grid, int startX, int startY, int endX, int endY)
+    {
+        out.open(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+        out.write(SESSION_MAGIC, sizeof(SESSION_MAGIC));
+        writeU16(out, static_cast<std::uint16_t>(GRID_SIZE));
+        writeU16(out, static_cast<std::uint16_t>(startY * GRID_SIZE + startX));
+        writeU16(out, static_cast<std::uint16_t>(endY * GRID_SIZE + endX));
+        std::vector<char> bits((GRID_SIZE * GRID_SIZE + 7) / 8, 0);
+        for (int r = 0; r < GRID_SIZE; ++r)
+        {
+            for (int c = 0; c < GRID_SIZE; ++c)
+            {
+                int id = r * GRID_SIZE + c;
+                if (grid.isWall(c, r))
+                    bits[id / 8] = static_cast<char>(bits[id / 8] | (1 << (id % 8)));
+            }
+        }
+        out.write(bits.data(), static_cast<std::streamsize>(bits.size()));
+        out.flush();
+        clock.restart();
+        return static_cast<bool>(out);
+    }
+
+    bool isOpen() const { return out.is_open(); }
+
+    void record(SessionEventType type, int x = 0, int y = 0)
+    {
+        if (!out.is_open())
+            return;
+        writeU32(out, static_cast<std::uint32_t>(clock.getElapsedTime().asMilliseconds()));
+        out.put(static_cast<char>(type));
+        out.put(0); // Reserved
+        writeU16(out, static_cast<std::uint16_t>(y * GRID_SIZE + x));
+        out.flush();
+    }
+
+private:
+    std::ofstream out;
+    sf::Clock clock;
+};
+
+static bool loadSession(const std::string &path, Session &session)
 {
+    std::ifstream in(path, std::ios::binary);
+    char magic[4];
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + 4, SESSION_MAGIC))
+        return false;
+    std::uint16_t gridSize, startCell, endCell;
+    if (!readU16(in, gridSize) || !readU16(in, startCell) || !readU16(in, endCell) || gridSize != GRID_SIZE)
+        return false;
+    session.startX = startCell % GRID_SIZE;
+    session.startY = startCell / GRID_SIZE;
+    session.endX = endCell % GRID_SIZE;
+    session.endY = endCell / GRID_SIZE;
+
+    std::vector<char> bits((GRID_SIZE * GRID_SIZE + 7) / 8);
+    if (!in.read(bits.data(), static_cast<std::streamsize>(bits.size())))
+        return false;
+    session.initialGrid = Grid(GRID_SIZE, GRID_SIZE);
+    for (int id = 0; id < GRID_SIZE * GRID_SIZE; ++id)
+    {
+        session.initialGrid.setWall(id % GRID_SIZE, id / GRID_SIZE, (bits[id / 8] >> (id % 8)) & 1);
+    }
+
+    session.events.clear();
+    SessionEvent event;
+    std::uint16_t typeAndReserved;
+    while (readU32(in, event.timeMs) && readU16(in, typeAndReserved) && readU16(in, event.cell))
+    {
+        event.type = static_cast<SessionEventType>(typeAndReserved & 0xFF);
+        if (event.type > SessionEventType::SetVoxelLayer || event.cell >= GRID_SIZE * GRID_SIZE ||
+            (event.type == SessionEventType::SetMovement && event.cell > static_cast<std::uint16_t>(MovementModel::FourConnected)) ||
+            (event.type == SessionEventType::SetDeadEnds && event.cell > 1) ||
+            (event.type == SessionEventType::SetAgentSize && (event.cell < 1 || event.cell > 3)) ||
+            (event.type == SessionEventType::SetTopology && event.cell > static_cast<std::uint16_t>(GridTopology::HexSix)) ||
+            (event.type == SessionEventType::RunAlternatives && event.cell > 1) ||
+            (event.type == SessionEventType::SetVoxelLayer && event.cell >= VOXEL_LAYERS))
+            return false;
+        session.events.push_back(event);
+    }
+    return true;
+}
+
+// Re-executes a recorded session as fast as possible, timing the search and rendering work of every event
+static int runReplay(const std::string &path, bool render)
+{
+    Session session;
+    if (!loadSession(path, session))
+    {
+        std::cerr << "Failed to load session: " << path << "\n";
+        return 1;
+    }
+
+    Grid grid = session.initialGrid;
+    std::vector<std::vector<sf::Color>> gridColors(GRID_SIZE, std::vector<sf::Color>(GRID_SIZE));
+    const int startX = session.startX, startY = session.startY;
+    const int endX = session.endX, endY = session.endY;
+
+    sf::RenderTexture texture;
+    const unsigned size = static_cast<unsigned>(GRID_SIZE * CELL_SIZE);
+    if (render && !texture.resize({size, size}))
+    {
+        std::cerr << "Failed to create offscreen render texture\n";
+        return 1;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto micros = [](Clock::duration d)
+    { return static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(d).count()); };
+
+    long long totalSearchUs = 0, totalRenderUs = 0, maxSearchUs = 0, maxRenderUs = 0;
+    // Search settings as the interactive session had them; pockets, clearance and the subgoal
+    // graph follow every edit
+    MovementModel movement = MovementModel::CornerCutting;
+    SubgoalGraph subgoals; // Built by the first subgoal search, dropped when the movement model changes
+    DeadEnds deadEnds = findDeadEnds(grid, movement);
+    bool pruneDeadEnds = false;
+    ClearanceMap clearance = computeClearance(grid, std::max(1u, std::thread::hardware_concurrency()));
+    int agentSize = 1;
+    bool hexView = false;
+    VoxelGrid voxelWorld; // Built by the last 3D search
+    std::vector<int> voxelPath;
+    std::vector<AnimationStep> steps;
+    std::cout << "step,time_ms,event,cell,search_us,render_us,anim_steps\n";
+    for (std::size_t i = 0; i < session.events.size(); ++i)
+    {
+        const SessionEvent &event = session.events[i];
+        int x = event.cell % GRID_SIZE;
+        int y = event.cell / GRID_SIZE;
+        const char *name = "toggle";
+
+        auto searchStart = Clock::now();
+        steps.clear();
+        if (event.type == SessionEventType::ToggleWall)
+        {
+            // Mirrors the interactive handler: start/end can never become walls
+            if (!((x == startX && y == startY) || (x == endX && y == endY)))
+            {
+                grid.setWall(x, y, !grid.isWall(x, y));
+                if (subgoals.valid(grid, movement))
+                    updateSubgoalGraph(grid, subgoals, x, y);
+                updateDeadEnds(grid, deadEnds, x, y);
+                updateClearance(grid, clearance, x, y);
+            }
+            resetGridColors(gridColors, grid, startX, startY, endX, endY);
+        }
+        else if (event.type == SessionEventType::SetMovement)
+        {
+            movement = static_cast<MovementModel>(event.cell);
+            subgoals = SubgoalGraph();
+            deadEnds = findDeadEnds(grid, movement);
+            name = "movement";
+        }
+        else if (event.type == SessionEventType::SetDeadEnds)
+        {
+            pruneDeadEnds = event.cell != 0;
+            name = "dead_ends";
+        }
+        else if (event.type == SessionEventType::SetAgentSize)
+        {
+            agentSize = event.cell;
+            name = "agent_size";
+        }
+        else if (event.type == SessionEventType::SetTopology)
+        {
+            hexView = static_cast<GridTopology>(event.cell) == GridTopology::HexSix;
+            name = "topology";
+        }
+        else if (event.type == SessionEventType::RunRsr)
+        {
+            name = "rsr";
+            resetGridColors(gridColors, grid, startX, startY, endX, endY);
+            RectangleDecomposition decomposition;
+            std::string report;
+            buildRsrAnimation(grid, movement, startX, startY, endX, endY, steps, decomposition, report, pruneDeadEnds ? &deadEnds : nullptr);
+            for (const auto &step : steps)
+                applyAnimationStep(gridColors, step, startX, startY, endX, endY);
+        }
+        else if (event.type == SessionEventType::RunSubgoals)
+        {
+            name = "subgoals";
+            resetGridColors(gridColors, grid, startX, startY, endX, endY);
+            if (!subgoals.valid(grid, movement))
+                subgoals = buildSubgoalGraph(grid, movement, true, std::max(1u, std::thread::hardware_concurrency()));
+            std::string report;
+            buildSubgoalAnimation(grid, subgoals, movement, startX, startY, endX, endY, steps, report, pruneDeadEnds ? &deadEnds : nullptr);
+            for (const auto &step : steps)
+                applyAnimationStep(gridColors, step, startX, startY, endX, endY);
+        }
+        else if (event.type == SessionEventType::RunNavMesh)
+        {
+            // The mesh is rebuilt for every query, as N does
+            static SearchContext navContext;
+            name = "navmesh";
+            resetGridColors(gridColors, grid, startX, startY, endX, endY);
+            NavMesh mesh = buildNavMesh(grid, movement, std::max(1u, std::thread::hardware_concurrency()));
+            std::vector<NavPoint> path;
+            findNavMeshPath(mesh, grid.cellId(startX, startY), grid.cellId(endX, endY), navContext, path);
+        }
+        else if (event.type == SessionEventType::RunAlternatives)
+        {
+            const bool yen = event.cell == 0;
+            const int start = grid.cellId(startX, startY), goal = grid.cellId(endX, endY);
+            name = yen ? "k_shortest" : "diverse";
+            resetGridColors(gridColors, grid, startX, startY, endX, endY);
+            if (yen)
+                findKShortestPaths(grid, movement, start, goal, 4, std::max(1u, std::thread::hardware_concurrency()));
+            else
+                findDiversePaths(grid, movement, start, goal, 4);
+        }
+        else if (event.type == SessionEventType::RunVoxels)
+        {
+            name = "voxels";
+            voxelWorld = buildVoxelWorld(grid);
+            searchVoxelWorld(voxelWorld, startX, startY, endX, endY, voxelPath);
+            colorVoxelSlice(gridColors, voxelWorld, voxelPath, 0);
+        }
+        else if (event.type == SessionEventType::SetVoxelLayer)
+        {
+            // Only recorded while the 3D view is on screen, after its world was built
+            name = "voxel_layer";
+            if (voxelWorld.depth > 0)
+                colorVoxelSlice(gridColors, voxelWorld, voxelPath, event.cell);
+        }
+        else
+        {
+            Algorithm algorithm = event.type == SessionEventType::RunDijkstra ? Algorithm::Dijkstra : Algorithm::AStar;
+            name = algorithm == Algorithm::Dijkstra ? "dijkstra" : "astar";
+            resetGridColors(gridColors, grid, startX, startY, endX, endY);
+            if (hexView)
+                buildTopologyAnimation(grid, algorithm, GridTopology::HexSix, startX, startY, endX, endY, steps);
+            else
+                buildSearchAnimation(grid, algorithm, movement, startX, startY, endX, endY, steps, pruneDeadEnds ? &deadEnds : nullptr,
+                                     &clearance, agentSize);
+            for (const auto &step : steps)
+                applyAnimationStep(gridColors, step, startX, startY, endX, endY);
+        }
+        auto searchEnd = Clock::now();
+
+        if (render)
+        {
+            texture.clear(sf::Color::Black);
+            drawGrid(texture, gridColors, startX, startY, endX, endY);
+            texture.display();
+        }
+        auto renderEnd = Clock::now();
+
+        long long searchUs = micros(searchEnd - searchStart);
+        long long renderUs = micros(renderEnd - searchEnd);
+        totalSearchUs += searchUs;
+        totalRenderUs += renderUs;
+        maxSearchUs = std::max(maxSearchUs, searchUs);
+        maxRenderUs = std::max(maxRenderUs, renderUs);
+        std::cout << i << "," << event.timeMs << "," << name << "," << event.cell << ","
+                  << searchUs << "," << renderUs << "," << steps.size() << "\n";
+    }
+
+    std::cerr << "Replayed " << session.events.size() << " events: search total=" << totalSearchUs
+              << "us max=" << maxSearchUs << "us, render total=" << totalRenderUs << "us max=" << maxRenderUs << "us\n";
+    return 0;
+}
+
+static void printUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " [--record FILE]\n"
+              << "       " << program << " --headless [--algo dijkstra|astar|both] [--map FILE]\n"
+              << "                   [--movement corner|no-corner|4] [--out DIR] [--every N] [--threads N]\n"
+              << "       " << program << " --replay FILE [--no-render]\n"
+              << "Headless and replay runs accept --metrics-file PATH to dump search metrics on exit\n";
+}
+
+int main(int argc, char **argv)
+{
+    HeadlessOptions headlessOptions;
+    bool headless = false;
+    std::string recordPath, replayPath, metricsPath;
+    bool replayRender = true;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--headless")
+            headless = true;
+        else if (arg == "--algo" && hasValue)
+            headlessOptions.algorithm = argv[++i];
+        else if (arg == "--map" && hasValue)
+            headlessOptions.mapPath = argv[++i];
+        else if (arg == "--movement" && hasValue)
+        {
+            std::string model = argv[++i];
+            headlessOptions.movement = model == "no-corner" ? MovementModel::NoCornerCutting
+                                       : model == "4"       ? MovementModel::FourConnected
+                                                            : MovementModel::CornerCutting;
+        }
+        else if (arg == "--out" && hasValue)
+            headlessOptions.outputDir = argv[++i];
+        else if (arg == "--every" && hasValue)
+            headlessOptions.frameEvery = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--threads" && hasValue)
+            headlessOptions.encoderThreads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        else if (arg == "--record" && hasValue)
+            recordPath = argv[++i];
+        else if (arg == "--replay" && hasValue)
+            replayPath = argv[++i];
+        else if (arg == "--no-render")
+            replayRender = false;
+        else if (arg == "--metrics-file" && hasValue)
+            metricsPath = argv[++i];
+        else
+        {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    if (headless || !replayPath.empty())
+    {
+        int status = headless ? runHeadless(headlessOptions) : runReplay(replayPath, replayRender);
+        if (!metricsPath.empty() && !writeMetricsFile(metricsPath))
+        {
+            std::cerr << "Failed to write metrics to " << metricsPath << "\n";
+            status = 1;
+        }
+        return status;
+    }
+
     const unsigned windowWidth = static_cast<unsigned>(GRID_SIZE * CELL_SIZE + PANEL_WIDTH_ADDITION);
     const unsigned windowHeight = static_cast<unsigned>(GRID_SIZE * CELL_SIZE + 2 * MARGIN);
 
@@ -50,7 +1030,7 @@ int main()
     }
 
     // Grid and wall data
-    std::vector<std::vector<bool>> wall(GRID_SIZE, std::vector<bool>(GRID_SIZE, false));
+    Grid grid(GRID_SIZE, GRID_SIZE);
     // Grid state will directly store colors for animation
     std::vector<std::vector<sf::Color>> gridColors(GRID_SIZE, std::vector<sf::Color>(GRID_SIZE));
 
@@ -63,6 +1043,22 @@ int main()
     std::vector<AnimationStep> astarAnimationSteps;
     int currentDijkstraAnimFrame = -1; // -1 means not animating
     int currentAstarAnimFrame = -1;
+    // Keyboard-triggered search variants (R: rectangular symmetry reduction) share one animation
+    std::vector<AnimationStep> variantAnimationSteps;
+    int currentVariantAnimFrame = -1;
+    std::string variantReport;                            // Expansion comparison of the last variant search
+    sf::VertexArray overlayLines(sf::PrimitiveType::Lines); // Drawn over the grid until the next edit or search
+    SubgoalGraph subgoals;                                // Built on first use (G), then repaired on every wall edit
+    DeadEnds deadEnds;                                    // Kept current on every wall edit; searches skip them while pruneDeadEnds is on
+    bool pruneDeadEnds = false;
+    ClearanceMap clearance;                               // Kept current on every wall edit for Annotated A*
+    int agentSize = 1;                                    // Footprint of the searching agent, cycled with C
+    VoxelGrid voxelWorld;                                 // 3D view (3): the walls extruded, under a ceiling with shafts
+    std::vector<int> voxelPath;
+    float voxelPathCost = 0.0f;
+    int voxelSlice = 0;      // Layer shown in the 3D view, changed with Up/Down
+    bool voxelView = false;
+    bool hexView = false;    // Hex cells (H): the grid drawn and searched as pointy-top hexes
     sf::Clock animationClock;
     sf::Time animationDelay = sf::milliseconds(20); // Adjust for faster/slower animation
 
@@ -73,6 +1069,14 @@ int main()
     messageText.setPosition(sf::Vector2f(static_cast<float>(GRID_SIZE * CELL_SIZE + MARGIN), static_cast<float>(windowHeight - 50)));
     std::string currentMessage = "";
 
+    // Movement model used by both searches, cycled with the M key
+    MovementModel movement = MovementModel::CornerCutting;
+    deadEnds = findDeadEnds(grid, movement);
+    clearance = computeClearance(grid, std::max(1u, std::thread::hardware_concurrency()));
+    sf::Text statusText(font);
+    statusText.setCharacterSize(16);
+    statusText.setFillColor(sf::Color::White);
+
     // Prepare button text
     sf::Text dijkstraText(font);
     dijkstraText.setString("DIJKSTRA");
@@ -106,30 +1110,98 @@ int main()
     // Position text inside buttons
     dijkstraText.setPosition(sf::Vector2f(panelX + TEXT_OFFSET_X, panelY + TEXT_OFFSET_Y));
     aText.setPosition(sf::Vector2f(panelX + TEXT_OFFSET_X, panelY + diButtonHeight + PANEL_SPACING + TEXT_OFFSET_Y));
+    statusText.setPosition(sf::Vector2f(panelX, panelY + diButtonHeight + aButtonHeight + 2 * PANEL_SPACING));
 
     // Function to reset grid colors for animation
     auto resetGridColors = [&]()
     {
-        for (int r = 0; r < GRID_SIZE; ++r)
+        ::resetGridColors(gridColors, grid, startX, startY, endX, endY);
+        voxelView = false;
+    };
+
+    // Shows one layer of the 3D view and reports the path
+    auto showVoxelSlice = [&]()
+    {
+        resetGridColors();
+        colorVoxelSlice(gridColors, voxelWorld, voxelPath, voxelSlice);
+        char report[96];
+        if (voxelPath.empty())
+            std::snprintf(report, sizeof(report), "3D layer %d of %d (Up/Down)\nNo 3D path", voxelSlice + 1, VOXEL_LAYERS);
+        else
+            std::snprintf(report, sizeof(report), "3D layer %d of %d (Up/Down)\n26-connected cost %.2f", voxelSlice + 1, VOXEL_LAYERS, voxelPathCost);
+        variantReport = report;
+        voxelView = true;
+    };
+
+    resetGridColors(); // Initial setup of grid colors
+
+    // Optional session recording for later headless replay
+    SessionRecorder recorder;
+    if (!recordPath.empty() && !recorder.open(recordPath, grid, startX, startY, endX, endY))
+    {
+        std::cerr << "Failed to open session log: " << recordPath << "\n";
+        return -1;
+    }
+
+    // Wall editing: drag painting, undo/redo history and overlay tracking
+    EditLog editLog;
+    bool painting = false;     // Left button held down inside the grid
+    bool paintValue = false;   // Wall state applied to cells while painting
+    bool overlayShown = false; // Search colors or a result message are on screen
+
+    // Applies one wall edit. Without a search overlay only the edited cell is repainted,
+    // so edits, undo and redo all cost the same constant amount.
+    auto setWall = [&](int x, int y, bool value)
+    {
+        if (grid.isWall(x, y) == value || (x == startX && y == startY) || (x == endX && y == endY))
+            return false;
+        grid.setWall(x, y, value);
+        if (subgoals.valid(grid, movement))
+            updateSubgoalGraph(grid, subgoals, x, y);
+        if (deadEnds.valid(grid, movement))
+            updateDeadEnds(grid, deadEnds, x, y);
+        updateClearance(grid, clearance, x, y);
+        recorder.record(SessionEventType::ToggleWall, x, y);
+        if (overlayShown)
         {
-            for (int c = 0; c < GRID_SIZE; ++c)
-            {
-                if (wall[r][c])
-                {
-                    gridColors[r][c] = sf::Color::White; // Walls are white
-                }
-                else
-                {
-                    gridColors[r][c] = sf::Color(255, 200, 0); // Unexplored traversable cells are orange
-                }
-            }
+            // Clear any paths, messages, and stop animations after grid change
+            dijkstraAnimationSteps.clear();
+            astarAnimationSteps.clear();
+            variantAnimationSteps.clear();
+            currentDijkstraAnimFrame = -1;
+            currentAstarAnimFrame = -1;
+            currentVariantAnimFrame = -1;
+            variantReport.clear();
+            overlayLines.clear();
+            currentMessage = "";
+            resetGridColors(); // Reset visual grid
+            overlayShown = false;
         }
-        // Start and End nodes are always blue and override other colors
-        gridColors[startY][startX] = sf::Color::Blue;
-        gridColors[endY][endX] = sf::Color::Blue;
+        else
+        {
+            gridColors[y][x] = baseCellColor(value);
+        }
+        return true;
     };
 
-    resetGridColors(); // Initial setup of grid colors
+    // Cell under the pixel in the current view; false outside the grid
+    auto cellUnderCursor = [&](int mx, int my, int &col, int &row)
+    {
+        if (hexView)
+            return HexSix::cellAt(static_cast<float>(mx) / HEX_CELL_SIZE, static_cast<float>(my) / HEX_CELL_SIZE, GRID_SIZE, GRID_SIZE, col, row);
+        return SquareEight::cellAt(static_cast<float>(mx) / CELL_SIZE, static_cast<float>(my) / CELL_SIZE, GRID_SIZE, GRID_SIZE, col, row);
+    };
+
+    // Paints the cell under the cursor during a drag and logs the edit for undo
+    auto paintCell = [&](int mx, int my)
+    {
+        int col, row;
+        if (!cellUnderCursor(mx, my, col, row))
+            return;
+        bool oldValue = grid.isWall(col, row);
+        if (setWall(col, row, paintValue))
+            editLog.record(col, row, oldValue, paintValue);
+    };
 
     while (window.isOpen())
     {
@@ -142,8 +1214,240 @@ int main()
             }
             else if (auto *key = event->getIf<sf::Event::KeyPressed>())
             {
+                // The keyboard variants and the movement models are for square cells, so they leave
+                // the hex view
+                if (hexView && key->code != sf::Keyboard::Key::H && !key->control)
+                {
+                    hexView = false;
+                    recorder.record(SessionEventType::SetTopology, static_cast<int>(squareTopology(movement)));
+                }
                 if (key->code == sf::Keyboard::Key::Escape)
                     window.close();
+                // Ctrl+Z undoes the last gesture, Ctrl+Y or Ctrl+Shift+Z redoes it
+                else if (key->control && key->code == sf::Keyboard::Key::Z && !key->shift)
+                {
+                    painting = false;
+                    editLog.undo(setWall);
+                }
+                else if (key->control && (key->code == sf::Keyboard::Key::Y || (key->code == sf::Keyboard::Key::Z && key->shift)))
+                {
+                    painting = false;
+                    editLog.endGesture();
+                    editLog.redo(setWall);
+                }
+                // M cycles the movement model used by the next search
+                else if (key->code == sf::Keyboard::Key::M)
+                {
+                    movement = static_cast<MovementModel>((static_cast<int>(movement) + 1) % 3);
+                    subgoals = SubgoalGraph(); // Not repaired under other models; rebuilt on the next G
+                    deadEnds = findDeadEnds(grid, movement);
+                    recorder.record(SessionEventType::SetMovement, static_cast<int>(movement));
+                }
+                // D toggles dead-end pruning for every search and shades the pockets
+                else if (key->code == sf::Keyboard::Key::D)
+                {
+                    painting = false;
+                    editLog.endGesture();
+                    currentDijkstraAnimFrame = -1;
+                    currentAstarAnimFrame = -1;
+                    currentVariantAnimFrame = -1;
+                    overlayLines.clear();
+                    currentMessage = "";
+                    resetGridColors();
+
+                    pruneDeadEnds = !pruneDeadEnds;
+                    recorder.record(SessionEventType::SetDeadEnds, pruneDeadEnds ? 1 : 0);
+                    variantReport = "Dead ends: " + std::to_string(deadEnds.pocketCount()) + " pockets, " +
+                                    std::to_string(deadEnds.pocketCellCount()) + " cells";
+                    if (pruneDeadEnds)
+                    {
+                        for (int cell = 0; cell < grid.cellCount(); ++cell)
+                        {
+                            if (deadEnds.pocketOf[static_cast<std::size_t>(cell)] >= 0 && !(cell == grid.cellId(startX, startY) || cell == grid.cellId(endX, endY)))
+                                gridColors[cell / GRID_SIZE][cell % GRID_SIZE] = sf::Color(190, 170, 130);
+                        }
+                        overlayShown = true;
+                    }
+                }
+                // C cycles the agent size for Dijkstra and A* and shades each cell by its clearance
+                else if (key->code == sf::Keyboard::Key::C)
+                {
+                    painting = false;
+                    editLog.endGesture();
+                    currentDijkstraAnimFrame = -1;
+                    currentAstarAnimFrame = -1;
+                    currentVariantAnimFrame = -1;
+                    overlayLines.clear();
+                    currentMessage = "";
+                    resetGridColors();
+
+                    agentSize = agentSize % 3 + 1;
+                    recorder.record(SessionEventType::SetAgentSize, agentSize);
+                    variantReport = "Agent " + std::to_string(agentSize) + "x" + std::to_string(agentSize) + ": darker cells have more clearance";
+                    for (int cell = 0; cell < grid.cellCount(); ++cell)
+                    {
+                        const int value = clearance.at(cell);
+                        if (value == 0 || cell == grid.cellId(startX, startY) || cell == grid.cellId(endX, endY))
+                            continue;
+                        // Cells the agent does not fit on are tinted red, the rest go from light to dark teal
+                        const auto shade = static_cast<std::uint8_t>(255 - 20 * std::min(value, 8));
+                        gridColors[cell / GRID_SIZE][cell % GRID_SIZE] = value < agentSize ? sf::Color(255, 190, 190) : sf::Color(shade, 255, 255);
+                    }
+                    overlayShown = true;
+                }
+                // R runs rectangular symmetry reduction and overlays the rectangle decomposition
+                else if (key->code == sf::Keyboard::Key::R)
+                {
+                    painting = false;
+                    editLog.endGesture();
+                    currentDijkstraAnimFrame = -1;
+                    currentAstarAnimFrame = -1;
+                    variantAnimationSteps.clear();
+                    overlayLines.clear();
+                    currentMessage = "";
+                    resetGridColors();
+
+                    recorder.record(SessionEventType::RunRsr);
+                    RectangleDecomposition decomposition;
+                    if (!buildRsrAnimation(grid, movement, startX, startY, endX, endY, variantAnimationSteps, decomposition, variantReport,
+                                           pruneDeadEnds ? &deadEnds : nullptr))
+                        currentMessage = "RSR: No Path Found!";
+                    appendRectangleOutlines(overlayLines, decomposition, sf::Color(0, 200, 255));
+                    currentVariantAnimFrame = 0;
+                    overlayShown = true;
+                    animationClock.restart();
+                }
+                // G searches the two-level subgoal graph and draws its global edges
+                else if (key->code == sf::Keyboard::Key::G)
+                {
+                    painting = false;
+                    editLog.endGesture();
+                    currentDijkstraAnimFrame = -1;
+                    currentAstarAnimFrame = -1;
+                    variantAnimationSteps.clear();
+                    overlayLines.clear();
+                    currentMessage = "";
+                    resetGridColors();
+
+                    recorder.record(SessionEventType::RunSubgoals);
+                    if (!subgoals.valid(grid, movement))
+                        subgoals = buildSubgoalGraph(grid, movement, true, std::max(1u, std::thread::hardware_concurrency()));
+                    if (!buildSubgoalAnimation(grid, subgoals, movement, startX, startY, endX, endY, variantAnimationSteps, variantReport,
+                                               pruneDeadEnds ? &deadEnds : nullptr))
+                        currentMessage = "Subgoals: No Path Found!";
+                    appendSubgoalEdges(overlayLines, subgoals, sf::Color(0, 200, 255));
+                    currentVariantAnimFrame = 0;
+                    overlayShown = true;
+                    animationClock.restart();
+                }
+                // N builds a navigation mesh and draws it with the funnel-smoothed path
+                else if (key->code == sf::Keyboard::Key::N)
+                {
+                    painting = false;
+                    editLog.endGesture();
+                    currentDijkstraAnimFrame = -1;
+                    currentAstarAnimFrame = -1;
+                    currentVariantAnimFrame = -1;
+                    overlayLines.clear();
+                    currentMessage = "";
+                    resetGridColors();
+
+                    recorder.record(SessionEventType::RunNavMesh);
+                    static SearchContext navContext;
+                    NavMesh mesh = buildNavMesh(grid, movement, std::max(1u, std::thread::hardware_concurrency()));
+                    std::vector<NavPoint> path;
+                    SearchResult result = findNavMeshPath(mesh, grid.cellId(startX, startY), grid.cellId(endX, endY), navContext, path);
+                    appendRectangleOutlines(overlayLines, mesh.polygons, sf::Color(0, 200, 255));
+                    appendPolyline(overlayLines, path, sf::Color::Yellow);
+                    variantReport = "Navmesh: " + std::to_string(mesh.polygonCount()) + " polygons, " +
+                                    std::to_string(mesh.edges.size()) + " portals";
+                    if (!result.found)
+                        currentMessage = "Navmesh: No Path Found!";
+                    overlayShown = true;
+                }
+                // 3 builds a 3D world from the grid and searches it from the start on the bottom
+                // layer to the end on the top one; Up/Down step through its layers
+                else if (key->code == sf::Keyboard::Key::Num3)
+                {
+                    painting = false;
+                    editLog.endGesture();
+                    currentDijkstraAnimFrame = -1;
+                    currentAstarAnimFrame = -1;
+                    currentVariantAnimFrame = -1;
+                    overlayLines.clear();
+                    currentMessage = "";
+
+                    recorder.record(SessionEventType::RunVoxels);
+                    voxelWorld = buildVoxelWorld(grid);
+                    voxelPathCost = searchVoxelWorld(voxelWorld, startX, startY, endX, endY, voxelPath).cost;
+                    voxelSlice = 0;
+                    showVoxelSlice();
+                    overlayShown = true;
+                }
+                else if (voxelView && (key->code == sf::Keyboard::Key::Up || key->code == sf::Keyboard::Key::Down))
+                {
+                    voxelSlice = std::clamp(voxelSlice + (key->code == sf::Keyboard::Key::Up ? 1 : -1), 0, VOXEL_LAYERS - 1);
+                    recorder.record(SessionEventType::SetVoxelLayer, voxelSlice);
+                    showVoxelSlice();
+                }
+                // H switches between square and hex cells; the Dijkstra and A* buttons search the
+                // cells as drawn
+                else if (key->code == sf::Keyboard::Key::H)
+                {
+                    painting = false;
+                    editLog.endGesture();
+                    currentDijkstraAnimFrame = -1;
+                    currentAstarAnimFrame = -1;
+                    currentVariantAnimFrame = -1;
+                    overlayLines.clear();
+                    variantReport.clear();
+                    currentMessage = "";
+                    resetGridColors();
+                    hexView = !hexView;
+                    recorder.record(SessionEventType::SetTopology, static_cast<int>(hexView ? GridTopology::HexSix : squareTopology(movement)));
+                }
+                // K draws the 4 shortest loopless paths (Yen), V 4 diverse paths from the penalty method
+                else if (key->code == sf::Keyboard::Key::K || key->code == sf::Keyboard::Key::V)
+                {
+                    painting = false;
+                    editLog.endGesture();
+                    currentDijkstraAnimFrame = -1;
+                    currentAstarAnimFrame = -1;
+                    currentVariantAnimFrame = -1;
+                    overlayLines.clear();
+                    currentMessage = "";
+                    resetGridColors();
+
+                    const bool yen = key->code == sf::Keyboard::Key::K;
+                    recorder.record(SessionEventType::RunAlternatives, yen ? 0 : 1);
+                    const int start = grid.cellId(startX, startY), goal = grid.cellId(endX, endY);
+                    std::vector<AlternativePath> paths = yen ? findKShortestPaths(grid, movement, start, goal, 4, std::max(1u, std::thread::hardware_concurrency()))
+                                                             : findDiversePaths(grid, movement, start, goal, 4);
+                    appendAlternativePaths(overlayLines, paths, GRID_SIZE);
+                    variantReport = yen ? "K shortest:" : "Diverse:";
+                    for (const AlternativePath &path : paths)
+                    {
+                        char cost[16];
+                        std::snprintf(cost, sizeof(cost), " %.2f", path.cost);
+                        variantReport += cost;
+                    }
+                    if (paths.empty())
+                        currentMessage = "Alternatives: No Path Found!";
+                    overlayShown = true;
+                }
+            }
+            else if (auto *moved = event->getIf<sf::Event::MouseMoved>())
+            {
+                if (painting)
+                    paintCell(moved->position.x, moved->position.y);
+            }
+            else if (auto *released = event->getIf<sf::Event::MouseButtonReleased>())
+            {
+                if (released->button == sf::Mouse::Button::Left && painting)
+                {
+                    painting = false;
+                    editLog.endGesture();
+                }
             }
             else if (auto *mouse = event->getIf<sf::Event::MouseButtonPressed>())
             {
@@ -152,125 +1456,38 @@ int main()
                     int mx = mouse->position.x;
                     int my = mouse->position.y;
 
-                    // Grid area click: toggle wall
-                    if (mx >= 0 && mx < GRID_SIZE * CELL_SIZE && my >= 0 && my < GRID_SIZE * CELL_SIZE)
+                    // Grid area click: toggle wall and keep painting that state while dragging
+                    int col, row;
+                    if (cellUnderCursor(mx, my, col, row))
                     {
-                        int col = mx / CELL_SIZE;
-                        int row = my / CELL_SIZE;
-                        // Prevent toggling start/end
-                        if (!((col == startX && row == startY) || (col == endX && row == endY)))
-                        {
-                            wall[row][col] = !wall[row][col];
-                        }
-                        // Clear any paths, messages, and stop animations after grid change
-                        dijkstraAnimationSteps.clear();
-                        astarAnimationSteps.clear();
-                        currentDijkstraAnimFrame = -1;
-                        currentAstarAnimFrame = -1;
-                        currentMessage = "";
-                        resetGridColors(); // Reset visual grid
+                        editLog.endGesture();
+                        painting = true;
+                        paintValue = !grid.isWall(col, row);
+                        paintCell(mx, my);
                     }
                     // Dijkstra button area click
                     else if (mx >= panelX && mx < panelX + buttonWidth &&
                              my >= panelY && my < panelY + diButtonHeight)
                     {
+                        recorder.record(SessionEventType::RunDijkstra);
                         // Stop other animation and clear paths/messages
                         currentAstarAnimFrame = -1;
+                        currentVariantAnimFrame = -1;
                         dijkstraAnimationSteps.clear();
                         astarAnimationSteps.clear(); // Clear A* steps as well
+                        overlayLines.clear();
+                        variantReport.clear();
                         currentMessage = "";
                         resetGridColors(); // Reset visual grid for new animation
 
-                        const int N = GRID_SIZE;
-                        std::vector<std::vector<float>> dist(N, std::vector<float>(N, std::numeric_limits<float>::max()));
-                        std::vector<std::vector<sf::Vector2i>> prev(N, std::vector<sf::Vector2i>(N, sf::Vector2i(-1, -1)));
-
-                        struct Node
-                        {
-                            float d;
-                            int x, y;
-                        };
-                        struct Cmp
-                        {
-                            bool operator()(Node const &a, Node const &b) const { return a.d > b.d; }
-                        };
-                        std::priority_queue<Node, std::vector<Node>, Cmp> pq;
-
-                        dist[startY][startX] = 0.0f;
-                        pq.push({0.0f, startX, startY});
-                        dijkstraAnimationSteps.push_back({sf::Vector2i(startX, startY), sf::Color::Cyan}); // Start node is initially 'open'
-
-                        while (!pq.empty())
-                        {
-                            Node node = pq.top();
-                            pq.pop();
-                            int cx = node.x, cy = node.y;
-                            float cd = node.d;
-
-                            // Using a small epsilon for float comparison to account for precision loss
-                            if (cd > dist[cy][cx] + std::numeric_limits<float>::epsilon())
-                                continue; // Already found a shorter path
-
-                            // Mark as visited (grey), unless it's the start/end node
-                            if (!((cx == startX && cy == startY) || (cx == endX && cy == endY)))
-                            {
-                                dijkstraAnimationSteps.push_back({sf::Vector2i(cx, cy), sf::Color(100, 100, 100)});
-                            }
-
-                            if (cx == endX && cy == endY)
-                                break; // Goal reached
-
-                            for (auto &dir : directions)
-                            {
-                                int nx = cx + dir.x;
-                                int ny = cy + dir.y;
-                                if (nx >= 0 && nx < N && ny >= 0 && ny < N && !wall[ny][nx])
-                                {
-                                    float moveCost = (dir.x != 0 && dir.y != 0) ? DIAGONAL_COST : CARDINAL_COST; // Calculate cost based on movement type
-                                    float nd = cd + moveCost;
-                                    if (nd < dist[ny][nx])
-                                    {
-                                        dist[ny][nx] = nd;
-                                        prev[ny][nx] = sf::Vector2i(cx, cy);
-                                        pq.push({nd, nx, ny});
-                                        // Mark as open (cyan), unless it's the start/end node
-                                        if (!((nx == startX && ny == startY) || (nx == endX && ny == endY)))
-                                        {
-                                            dijkstraAnimationSteps.push_back({sf::Vector2i(nx, ny), sf::Color::Cyan});
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        // Reconstruct Dijkstra path and add to animation steps
-                        std::vector<sf::Vector2i> finalPath; // Temporary vector for path reconstruction
-                        int tx = endX, ty = endY;
-                        if (dist[ty][tx] < std::numeric_limits<float>::max())
-                        {
-                            while (!(tx == startX && ty == startY))
-                            {
-                                finalPath.emplace_back(tx, ty);
-                                sf::Vector2i p = prev[ty][tx];
-                                tx = p.x;
-                                ty = p.y;
-                            }
-                            finalPath.emplace_back(startX, startY);
-                            std::reverse(finalPath.begin(), finalPath.end()); // Reverse to get start-to-end
-
-                            // Add path steps to animation after all search steps
-                            for (const auto &p : finalPath)
-                            {
-                                if (!((p.x == startX && p.y == startY) || (p.x == endX && p.y == endY)))
-                                {
-                                    dijkstraAnimationSteps.push_back({p, sf::Color::Green}); // Path nodes are green
-                                }
-                            }
-                        }
-                        else
+                        if (hexView ? !buildTopologyAnimation(grid, Algorithm::Dijkstra, GridTopology::HexSix, startX, startY, endX, endY, dijkstraAnimationSteps)
+                                    : !buildSearchAnimation(grid, Algorithm::Dijkstra, movement, startX, startY, endX, endY, dijkstraAnimationSteps,
+                                                            pruneDeadEnds ? &deadEnds : nullptr, &clearance, agentSize))
                         {
                             currentMessage = "Dijkstra: No Path Found!";
                         }
                         currentDijkstraAnimFrame = 0; // Start animation
+                        overlayShown = true;
                         animationClock.restart();
                     }
                     // A* button area click
@@ -278,111 +1495,25 @@ int main()
                              my >= panelY + diButtonHeight + PANEL_SPACING &&
                              my < panelY + diButtonHeight + PANEL_SPACING + aButtonHeight)
                     {
+                        recorder.record(SessionEventType::RunAstar);
                         // Stop other animation and clear paths/messages
                         currentDijkstraAnimFrame = -1;
+                        currentVariantAnimFrame = -1;
                         astarAnimationSteps.clear();
                         dijkstraAnimationSteps.clear(); // Clear Dijkstra steps as well
+                        overlayLines.clear();
+                        variantReport.clear();
                         currentMessage = "";
                         resetGridColors(); // Reset visual grid for new animation
 
-                        const int N = GRID_SIZE;
-                        std::vector<std::vector<float>> g_cost(N, std::vector<float>(N, std::numeric_limits<float>::max()));
-                        std::vector<std::vector<sf::Vector2i>> prev(N, std::vector<sf::Vector2i>(N, sf::Vector2i(-1, -1)));
-
-                        struct Node
-                        {
-                            float f, g; // f_cost and g_cost
-                            int x, y;
-                        };
-                        struct Cmp2
-                        {
-                            bool operator()(Node const &a, Node const &b) const { return a.f > b.f; }
-                        };
-                        std::priority_queue<Node, std::vector<Node>, Cmp2> pq;
-
-                        auto heuristic = [&](int x, int y)
-                        {
-                            int dx = std::abs(x - endX);
-                            int dy = std::abs(y - endY);
-                            return static_cast<float>(std::max(dx, dy)); // Chebyshev distance for 8-directional movement
-                        };
-
-                        g_cost[startY][startX] = 0.0f;
-                        pq.push({heuristic(startX, startY), 0.0f, startX, startY});
-                        astarAnimationSteps.push_back({sf::Vector2i(startX, startY), sf::Color::Cyan}); // Start node is initially 'open'
-
-                        while (!pq.empty())
-                        {
-                            Node node = pq.top();
-                            pq.pop();
-                            int cx = node.x, cy = node.y;
-                            float cg = node.g;
-
-                            // Using a small epsilon for float comparison to account for precision loss
-                            if (cg > g_cost[cy][cx] + std::numeric_limits<float>::epsilon())
-                                continue; // Already found a shorter path
-
-                            // Mark as visited (grey), unless it's the start/end node
-                            if (!((cx == startX && cy == startY) || (cx == endX && cy == endY)))
-                            {
-                                astarAnimationSteps.push_back({sf::Vector2i(cx, cy), sf::Color(100, 100, 100)});
-                            }
-
-                            if (cx == endX && cy == endY)
-                                break; // Goal reached
-
-                            for (auto &dir : directions)
-                            {
-                                int nx = cx + dir.x;
-                                int ny = cy + dir.y;
-                                if (nx >= 0 && nx < N && ny >= 0 && ny < N && !wall[ny][nx])
-                                {
-                                    float moveCost = (dir.x != 0 && dir.y != 0) ? DIAGONAL_COST : CARDINAL_COST; // Calculate cost based on movement type
-                                    float ng = cg + moveCost;
-                                    if (ng < g_cost[ny][nx])
-                                    {
-                                        g_cost[ny][nx] = ng;
-                                        prev[ny][nx] = sf::Vector2i(cx, cy);
-                                        float f = ng + heuristic(nx, ny);
-                                        pq.push({f, ng, nx, ny});
-                                        // Mark as open (cyan), unless it's the start/end node
-                                        if (!((nx == startX && ny == startY) || (nx == endX && ny == endY)))
-                                        {
-                                            astarAnimationSteps.push_back({sf::Vector2i(nx, ny), sf::Color::Cyan});
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        // Reconstruct A* path and add to animation steps
-                        std::vector<sf::Vector2i> finalPath; // Temporary vector for path reconstruction
-                        int tx = endX, ty = endY;
-                        if (g_cost[ty][tx] < std::numeric_limits<float>::max())
-                        {
-                            while (!(tx == startX && ty == startY))
-                            {
-                                finalPath.emplace_back(tx, ty);
-                                sf::Vector2i p = prev[ty][tx];
-                                tx = p.x;
-                                ty = p.y;
-                            }
-                            finalPath.emplace_back(startX, startY);
-                            std::reverse(finalPath.begin(), finalPath.end()); // Reverse to get start-to-end
-
-                            // Add path steps to animation after all search steps
-                            for (const auto &p : finalPath)
-                            {
-                                if (!((p.x == startX && p.y == startY) || (p.x == endX && p.y == endY)))
-                                {
-                                    astarAnimationSteps.push_back({p, sf::Color(255, 0, 255)}); // Path nodes are magenta
-                                }
-                            }
-                        }
-                        else
+                        if (hexView ? !buildTopologyAnimation(grid, Algorithm::AStar, GridTopology::HexSix, startX, startY, endX, endY, astarAnimationSteps)
+                                    : !buildSearchAnimation(grid, Algorithm::AStar, movement, startX, startY, endX, endY, astarAnimationSteps,
+                                                            pruneDeadEnds ? &deadEnds : nullptr, &clearance, agentSize))
                         {
                             currentMessage = "A*: No Path Found!";
                         }
                         currentAstarAnimFrame = 0; // Start animation
+                        overlayShown = true;
                         animationClock.restart();
                     }
                 }
@@ -394,12 +1525,7 @@ int main()
         {
             if (currentDijkstraAnimFrame < dijkstraAnimationSteps.size())
             {
-                const auto &step = dijkstraAnimationSteps[currentDijkstraAnimFrame];
-                // Only update if it's not the start/end node, which should always remain blue
-                if (!((step.coord.x == startX && step.coord.y == startY) || (step.coord.x == endX && step.coord.y == endY)))
-                {
-                    gridColors[step.coord.y][step.coord.x] = step.color;
-                }
+                applyAnimationStep(gridColors, dijkstraAnimationSteps[currentDijkstraAnimFrame], startX, startY, endX, endY);
                 currentDijkstraAnimFrame++;
             }
             else
@@ -414,12 +1540,7 @@ int main()
         {
             if (currentAstarAnimFrame < astarAnimationSteps.size())
             {
-                const auto &step = astarAnimationSteps[currentAstarAnimFrame];
-                // Only update if it's not the start/end node, which should always remain blue
-                if (!((step.coord.x == startX && step.coord.y == startY) || (step.coord.x == endX && step.coord.y == endY)))
-                {
-                    gridColors[step.coord.y][step.coord.x] = step.color;
-                }
+                applyAnimationStep(gridColors, astarAnimationSteps[currentAstarAnimFrame], startX, startY, endX, endY);
                 currentAstarAnimFrame++;
             }
             else
@@ -429,42 +1550,39 @@ int main()
             animationClock.restart();
         }
 
-        // Rendering
-        window.clear(sf::Color::Black);
-
-        // Draw grid cells based on their current color in gridColors
-        sf::RectangleShape cellShape;
-        cellShape.setOutlineThickness(1.f);
-        cellShape.setOutlineColor(sf::Color::Red);
-        cellShape.setSize(sf::Vector2f(static_cast<float>(CELL_SIZE), static_cast<float>(CELL_SIZE)));
-
-        for (int r = 0; r < GRID_SIZE; ++r)
+        // Update animation frame for the keyboard-triggered variants
+        if (currentVariantAnimFrame != -1 && animationClock.getElapsedTime() >= animationDelay)
         {
-            for (int c = 0; c < GRID_SIZE; ++c)
+            if (currentVariantAnimFrame < static_cast<int>(variantAnimationSteps.size()))
             {
-                cellShape.setFillColor(gridColors[r][c]);
-                cellShape.setPosition(sf::Vector2f(static_cast<float>(c * CELL_SIZE), static_cast<float>(r * CELL_SIZE)));
-                window.draw(cellShape);
+                applyAnimationStep(gridColors, variantAnimationSteps[static_cast<std::size_t>(currentVariantAnimFrame)], startX, startY, endX, endY);
+                currentVariantAnimFrame++;
             }
+            else
+            {
+                currentVariantAnimFrame = -1; // Animation finished
+            }
+            animationClock.restart();
         }
 
-        // Ensure Start and End cells are always blue and drawn on top
-        // This is important because animation steps might temporarily color them
-        sf::RectangleShape startShape(sf::Vector2f(static_cast<float>(CELL_SIZE), static_cast<float>(CELL_SIZE)));
-        startShape.setFillColor(sf::Color::Blue);
-        startShape.setPosition(sf::Vector2f(static_cast<float>(startX * CELL_SIZE), static_cast<float>(startY * CELL_SIZE)));
-        window.draw(startShape);
+        // Rendering
+        window.clear(sf::Color::Black);
 
-        sf::RectangleShape endShape(sf::Vector2f(static_cast<float>(CELL_SIZE), static_cast<float>(CELL_SIZE)));
-        endShape.setFillColor(sf::Color::Blue);
-        endShape.setPosition(sf::Vector2f(static_cast<float>(endX * CELL_SIZE), static_cast<float>(endY * CELL_SIZE)));
-        window.draw(endShape);
+        if (hexView)
+            drawHexGrid(window, gridColors, startX, startY, endX, endY);
+        else
+            drawGrid(window, gridColors, startX, startY, endX, endY);
+        window.draw(overlayLines);
 
         // Draw panel buttons and text
         window.draw(diButton);
         window.draw(aButton);
         window.draw(dijkstraText);
         window.draw(aText);
+        statusText.setString(std::string("Moves (M): ") + (hexView ? topologyName(GridTopology::HexSix) : movementName(movement)) + "\nDead-end pruning (D): " + (pruneDeadEnds ? "on" : "off") +
+                             "\nAgent size (C): " + std::to_string(agentSize) +
+                             "\nR: RSR, G: subgoals, N: navmesh\nK: K shortest, V: diverse paths\n3: 3D view, H: hex cells\n" + variantReport);
+        window.draw(statusText);
 
         // Draw message if any
         if (!currentMessage.empty())
@@ -0,0 +1,249 @@
+#include "metrics.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+static const char *const ALGORITHM_LABELS[METRIC_ALGORITHMS] = {"dijkstra", "astar"};
+
+// Shards live until process exit so counts from finished threads are kept
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<MetricsShard>> shards;
+static std::map<std::string, double> preprocessingSeconds;
+
+MetricsShard &localMetrics()
+{
+    thread_local MetricsShard *shard = nullptr;
+    if (!shard)
+    {
+        auto created = std::make_unique<MetricsShard>();
+        shard = created.get();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        shards.push_back(std::move(created));
+    }
+    return *shard;
+}
+
+void recordPreprocessing(const std::string &stage, double seconds)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    preprocessingSeconds[stage] += seconds;
+}
+
+// Smallest bucket upper bound covering fraction q of the recorded values, in nanoseconds
+static std::uint64_t quantile(const std::vector<std::uint64_t> &buckets, std::uint64_t total, double q)
+{
+    std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(total) + 0.5);
+    std::uint64_t seen = 0;
+    for (int i = 0; i < LatencyHistogram::BUCKETS; ++i)
+    {
+        seen += buckets[static_cast<std::size_t>(i)];
+        if (seen >= std::max<std::uint64_t>(rank, 1))
+            return LatencyHistogram::bucketUpperBound(i);
+    }
+    return 0;
+}
+
+std::string renderMetrics()
+{
+    std::uint64_t queries[METRIC_ALGORITHMS] = {}, found[METRIC_ALGORITHMS] = {}, expansions[METRIC_ALGORITHMS] = {};
+    std::uint64_t latencySum[METRIC_ALGORITHMS] = {};
+    std::vector<std::vector<std::uint64_t>> buckets(METRIC_ALGORITHMS, std::vector<std::uint64_t>(LatencyHistogram::BUCKETS, 0));
+    std::map<std::string, double> preprocessing;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto &shard : shards)
+        {
+            for (int a = 0; a < METRIC_ALGORITHMS; ++a)
+            {
+                queries[a] += shard->queries[a].load(std::memory_order_relaxed);
+                found[a] += shard->pathsFound[a].load(std::memory_order_relaxed);
+                expansions[a] += shard->expansions[a].load(std::memory_order_relaxed);
+                latencySum[a] += shard->latency[a].total();
+                for (int i = 0; i < LatencyHistogram::BUCKETS; ++i)
+                    buckets[static_cast<std::size_t>(a)][static_cast<std::size_t>(i)] += shard->latency[a].count(i);
+            }
+        }
+        preprocessing = preprocessingSeconds;
+    }
+
+    std::ostringstream out;
+    auto counter = [&](const char *name, const char *help, const std::uint64_t *values)
+    {
+        out << "# HELP " << name << " " << help << "\n# TYPE " << name << " counter\n";
+        for (int a = 0; a < METRIC_ALGORITHMS; ++a)
+            out << name << "{algorithm=\"" << ALGORITHM_LABELS[a] << "\"} " << values[a] << "\n";
+    };
+    counter("pathfinding_queries_total", "Path queries answered.", queries);
+    counter("pathfinding_paths_found_total", "Queries for which a path exists.", found);
+    counter("pathfinding_expansions_total", "Nodes expanded by searches.", expansions);
+
+    // Histogram totals come from the merged buckets, not from queries: the two are read
+    // separately while other threads keep recording
+    std::uint64_t totals[METRIC_ALGORITHMS] = {};
+    for (int a = 0; a < METRIC_ALGORITHMS; ++a)
+    {
+        for (std::uint64_t c : buckets[static_cast<std::size_t>(a)])
+            totals[a] += c;
+    }
+
+    // Prometheus buckets at 1us * 2^k, derived from the fine-grained per-thread histograms
+    const char *histogram = "pathfinding_query_duration_seconds";
+    out << "# HELP " << histogram << " Search time per query.\n# TYPE " << histogram << " histogram\n";
+    for (int a = 0; a < METRIC_ALGORITHMS; ++a)
+    {
+        const std::uint64_t total = totals[a];
+        int index = 0;
+        std::uint64_t cumulative = 0;
+        for (std::uint64_t le = 1000; le <= (std::uint64_t(1000) << 23); le *= 2)
+        {
+            while (index < LatencyHistogram::BUCKETS && LatencyHistogram::bucketUpperBound(index) <= le)
+                cumulative += buckets[static_cast<std::size_t>(a)][static_cast<std::size_t>(index++)];
+            out << histogram << "_bucket{algorithm=\"" << ALGORITHM_LABELS[a] << "\",le=\"" << static_cast<double>(le) * 1e-9
+                << "\"} " << cumulative << "\n";
+        }
+        out << histogram << "_bucket{algorithm=\"" << ALGORITHM_LABELS[a] << "\",le=\"+Inf\"} " << total << "\n";
+        out << histogram << "_sum{algorithm=\"" << ALGORITHM_LABELS[a] << "\"} " << static_cast<double>(latencySum[a]) * 1e-9 << "\n";
+        out << histogram << "_count{algorithm=\"" << ALGORITHM_LABELS[a] << "\"} " << total << "\n";
+    }
+
+    const char *quantiles = "pathfinding_query_duration_quantile_seconds";
+    out << "# HELP " << quantiles << " Search time quantiles from the full-resolution histogram.\n# TYPE " << quantiles << " gauge\n";
+    for (int a = 0; a < METRIC_ALGORITHMS; ++a)
+    {
+        const std::uint64_t total = totals[a];
+        for (double q : {0.5, 0.9, 0.99, 0.999})
+        {
+            out << quantiles << "{algorithm=\"" << ALGORITHM_LABELS[a] << "\",quantile=\"" << q << "\"} "
+                << static_cast<double>(quantile(buckets[static_cast<std::size_t>(a)], total, q)) * 1e-9 << "\n";
+        }
+    }
+
+    out << "# HELP pathfinding_preprocessing_seconds_total Time spent in preprocessing stages.\n"
+        << "# TYPE pathfinding_preprocessing_seconds_total counter\n";
+    for (const auto &entry : preprocessing)
+        out << "pathfinding_preprocessing_seconds_total{stage=\"" << entry.first << "\"} " << entry.second << "\n";
+    return out.str();
+}
+
+bool writeMetricsFile(const std::string &path)
+{
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        out << renderMetrics();
+        if (!out)
+            return false;
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+bool MetricsHttpServer::start(int port)
+{
+    listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int reuse = 1;
+    ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<std::uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Local scrapes only
+    stopFd = ::eventfd(0, EFD_CLOEXEC);
+    if (listenFd < 0 || stopFd < 0 || ::bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+        ::listen(listenFd, 16) < 0)
+    {
+        stop();
+        return false;
+    }
+
+    thread = std::thread([this]()
+                         {
+        while (true)
+        {
+            pollfd fds[2] = {{listenFd, POLLIN, 0}, {stopFd, POLLIN, 0}};
+            if (::poll(fds, 2, -1) < 0 || (fds[1].revents & POLLIN))
+                return;
+            int client = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0)
+                continue;
+            timeval timeout{1, 0}; // A stalled scraper must not wedge the endpoint
+            ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            std::string request;
+            char buffer[1024];
+            while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192)
+            {
+                ssize_t n = ::recv(client, buffer, sizeof(buffer), 0);
+                if (n <= 0)
+                    break;
+                request.append(buffer, static_cast<std::size_t>(n));
+            }
+            std::string body, status = "200 OK";
+            if (request.compare(0, 13, "GET /metrics ") == 0)
+                body = renderMetrics();
+            else
+                status = "404 Not Found";
+            std::string response = "HTTP/1.1 " + status + "\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                                   std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+            std::size_t sent = 0;
+            while (sent < response.size())
+            {
+                ssize_t n = ::send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0)
+                    break;
+                sent += static_cast<std::size_t>(n);
+            }
+            ::close(client);
+        } });
+    return true;
+}
+
+void MetricsHttpServer::stop()
+{
+    if (thread.joinable())
+    {
+        std::uint64_t one = 1;
+        ssize_t ignored = ::write(stopFd, &one, sizeof(one));
+        (void)ignored;
+        thread.join();
+    }
+    for (int *fd : {&listenFd, &stopFd})
+    {
+        if (*fd >= 0)
+            ::close(*fd);
+        *fd = -1;
+    }
+}
+
+void MetricsFileDumper::start(const std::string &filePath, int interval)
+{
+    path = filePath;
+    intervalSeconds = std::max(1, interval);
+    thread = std::thread([this]()
+                         {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!wake.wait_for(lock, std::chrono::seconds(intervalSeconds), [this]() { return stopping; }))
+            writeMetricsFile(path);
+        writeMetricsFile(path); // Final snapshot on shutdown
+    });
+}
+
+void MetricsFileDumper::stop()
+{
+    if (!thread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+}
@@ -0,0 +1,133 @@
+// Query metrics for the server and headless modes, exported in Prometheus text format.
+//
+// Recording is lock-free: every thread owns a shard of counters and HDR-style latency
+// histograms that only it writes (relaxed load + store, no atomic read-modify-write), so
+// instrumentation does not add contention to the query path. Shards are merged only when
+// metrics are rendered, by the HTTP endpoint or the periodic file dump.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "pathfinding.hpp"
+
+const int METRIC_ALGORITHMS = 2; // Indexed by Algorithm
+
+// Log-linear histogram of nanosecond values: exact below 32, then 32 sub-buckets per
+// power of two (at most ~3% relative error). Values above 2^40 ns are clamped.
+class LatencyHistogram
+{
+public:
+    static const int SUB_BUCKET_BITS = 5;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MAX_EXPONENT = 40;
+    static const int BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+    static int bucketIndex(std::uint64_t value)
+    {
+        if (value < static_cast<std::uint64_t>(SUB_BUCKETS))
+            return static_cast<int>(value);
+        int exponent = std::min(63 - __builtin_clzll(value), MAX_EXPONENT);
+        int shift = exponent - SUB_BUCKET_BITS;
+        std::uint64_t sub = std::min<std::uint64_t>((value >> shift) - SUB_BUCKETS, SUB_BUCKETS - 1);
+        return (shift + 1) * SUB_BUCKETS + static_cast<int>(sub);
+    }
+
+    // Largest value that falls into a bucket
+    static std::uint64_t bucketUpperBound(int index)
+    {
+        if (index < SUB_BUCKETS)
+            return static_cast<std::uint64_t>(index);
+        int shift = index / SUB_BUCKETS - 1;
+        std::uint64_t lower = static_cast<std::uint64_t>(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+        return lower + (std::uint64_t(1) << shift) - 1;
+    }
+
+    // Only the owning thread may call record()
+    void record(std::uint64_t nanoseconds)
+    {
+        bump(counts[bucketIndex(nanoseconds)], 1);
+        bump(sum, nanoseconds);
+    }
+
+    std::uint64_t count(int index) const { return counts[index].load(std::memory_order_relaxed); }
+    std::uint64_t total() const { return sum.load(std::memory_order_relaxed); }
+
+    // Single-writer increment: a plain load and store, readers may see a slightly stale value
+    static void bump(std::atomic<std::uint64_t> &counter, std::uint64_t amount)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<std::uint64_t> counts[BUCKETS] = {};
+    std::atomic<std::uint64_t> sum{0};
+};
+
+// Per-thread metrics, written only by the owning thread
+struct MetricsShard
+{
+    std::atomic<std::uint64_t> queries[METRIC_ALGORITHMS] = {};
+    std::atomic<std::uint64_t> pathsFound[METRIC_ALGORITHMS] = {};
+    std::atomic<std::uint64_t> expansions[METRIC_ALGORITHMS] = {};
+    LatencyHistogram latency[METRIC_ALGORITHMS];
+};
+
+// The calling thread's shard, registered on first use
+MetricsShard &localMetrics();
+
+inline void recordQuery(Algorithm algorithm, std::uint64_t latencyNs, std::uint32_t expanded, bool found)
+{
+    MetricsShard &shard = localMetrics();
+    int a = static_cast<int>(algorithm);
+    LatencyHistogram::bump(shard.queries[a], 1);
+    LatencyHistogram::bump(shard.pathsFound[a], found ? 1 : 0);
+    LatencyHistogram::bump(shard.expansions[a], expanded);
+    shard.latency[a].record(latencyNs);
+}
+
+// Accumulates time spent in a named preprocessing stage (map loading, precomputation).
+// Takes a lock, so it is meant for setup paths, not per query.
+void recordPreprocessing(const std::string &stage, double seconds);
+
+// Merges every shard and renders all metrics in Prometheus text exposition format
+std::string renderMetrics();
+
+// Writes renderMetrics() to path atomically (temporary file + rename)
+bool writeMetricsFile(const std::string &path);
+
+// Serves GET /metrics on 127.0.0.1:port from a background thread
+class MetricsHttpServer
+{
+public:
+    ~MetricsHttpServer() { stop(); }
+    bool start(int port);
+    void stop();
+
+private:
+    int listenFd = -1;
+    int stopFd = -1;
+    std::thread thread;
+};
+
+// Rewrites a metrics file every interval from a background thread
+class MetricsFileDumper
+{
+public:
+    ~MetricsFileDumper() { stop(); }
+    void start(const std::string &path, int intervalSeconds);
+    void stop();
+
+private:
+    std::string path;
+    int intervalSeconds = 10;
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread thread;
+};
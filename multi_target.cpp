@@ -0,0 +1,81 @@
+#include "multi_target.hpp"
+
+TargetIndex buildTargetIndex(const Grid &grid, const std::vector<int> &targets)
+{
+    TargetIndex index;
+    index.width = grid.width;
+    index.height = grid.height;
+    index.columns = (grid.width + TARGET_BUCKET_SIZE - 1) / TARGET_BUCKET_SIZE;
+    index.rows = (grid.height + TARGET_BUCKET_SIZE - 1) / TARGET_BUCKET_SIZE;
+    index.isTarget.assign(static_cast<std::size_t>(grid.cellCount()), 0);
+    auto bucketOf = [&](int cell)
+    { return cell / grid.width / TARGET_BUCKET_SIZE * index.columns + cell % grid.width / TARGET_BUCKET_SIZE; };
+
+    // Counting sort by bucket; duplicates are dropped through the membership flags
+    index.bucketStart.assign(static_cast<std::size_t>(index.columns * index.rows + 1), 0);
+    for (int cell : targets)
+    {
+        if (index.isTarget[static_cast<std::size_t>(cell)])
+            continue;
+        index.isTarget[static_cast<std::size_t>(cell)] = 1;
+        ++index.bucketStart[static_cast<std::size_t>(bucketOf(cell) + 1)];
+    }
+    for (std::size_t bucket = 1; bucket < index.bucketStart.size(); ++bucket)
+        index.bucketStart[bucket] += index.bucketStart[bucket - 1];
+    index.cells.resize(static_cast<std::size_t>(index.bucketStart.back()));
+    std::vector<int> fill(index.bucketStart.begin(), index.bucketStart.end() - 1);
+    for (int cell = 0; cell < grid.cellCount(); ++cell)
+    {
+        if (index.isTarget[static_cast<std::size_t>(cell)])
+            index.cells[static_cast<std::size_t>(fill[static_cast<std::size_t>(bucketOf(cell))]++)] = cell;
+    }
+    return index;
+}
+
+WaypointRouter::WaypointRouter(unsigned threads)
+    : workers(std::max(1u, threads)), pool(workers), contexts(workers)
+{
+}
+
+SearchResult WaypointRouter::route(const Grid &grid, Algorithm algorithm, MovementModel movement, const std::vector<int> &waypoints, std::vector<int> &path)
+{
+    SearchResult total;
+    path.clear();
+    if (waypoints.empty())
+        return total;
+    const int segmentCount = static_cast<int>(waypoints.size()) - 1;
+    segments.resize(static_cast<std::size_t>(segmentCount));
+    results.assign(static_cast<std::size_t>(segmentCount), SearchResult());
+
+    // Each worker takes a contiguous range of segments with its own context
+    const int chunk = (segmentCount + static_cast<int>(workers) - 1) / static_cast<int>(workers);
+    for (int begin = 0, worker = 0; begin < segmentCount; begin += chunk, ++worker)
+    {
+        const int end = std::min(segmentCount, begin + chunk);
+        pool.submit([this, &grid, &waypoints, algorithm, movement, begin, end, worker]()
+                    {
+                        for (int i = begin; i < end; ++i)
+                            results[static_cast<std::size_t>(i)] = findPath(grid, algorithm, movement, waypoints[static_cast<std::size_t>(i)], waypoints[static_cast<std::size_t>(i + 1)],
+                                                                            segments[static_cast<std::size_t>(i)], contexts[static_cast<std::size_t>(worker)]); });
+    }
+    pool.wait();
+
+    // Stitch in order; every segment after the first starts on the previous one's last cell
+    total.found = true;
+    path.push_back(waypoints.front());
+    for (int i = 0; i < segmentCount; ++i)
+    {
+        const SearchResult &result = results[static_cast<std::size_t>(i)];
+        total.expanded += result.expanded;
+        total.cost += result.cost;
+        total.found = total.found && result.found;
+        if (total.found)
+            path.insert(path.end(), segments[static_cast<std::size_t>(i)].begin() + 1, segments[static_cast<std::size_t>(i)].end());
+    }
+    if (!total.found)
+    {
+        path.clear();
+        total.cost = 0.0f;
+    }
+    return total;
+}
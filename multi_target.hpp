@@ -0,0 +1,123 @@
+// Queries with more than one goal. A nearest-target search runs one Dijkstra or A* that stops
+// at the first target it expands, which is the nearest one; A* uses the distance to the
+// nearest target, looked up in a bucketed spatial index, as its heuristic. A minimum of
+// consistent heuristics is consistent, so the first target expanded is still optimal.
+//
+// Waypoint routing finds a path through an ordered list of cells: the segments between
+// consecutive waypoints are independent searches, run in parallel and stitched in order.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "pathfinding.hpp"
+#include "thread_pool.hpp"
+
+// Side of the square buckets of a TargetIndex, in cells
+const int TARGET_BUCKET_SIZE = 8;
+
+// Target cells bucketed by position, with a per-cell membership flag for the goal test
+struct TargetIndex
+{
+    int width = 0, height = 0;
+    int columns = 0, rows = 0;          // Buckets per row and column
+    std::vector<int> bucketStart;       // Per bucket, its first entry in cells; one extra entry at the end
+    std::vector<int> cells;             // Target cells grouped by bucket
+    std::vector<std::uint8_t> isTarget; // Per grid cell
+
+    bool empty() const { return cells.empty(); }
+    bool reached(int cell) const { return isTarget[static_cast<std::size_t>(cell)] != 0; }
+
+    // Smallest Metric::between(dx, dy) from (x, y) to any target. Rings of buckets are visited
+    // outwards until the ring's nearest possible cell is no closer than the best found.
+    template <typename Metric>
+    float nearest(int x, int y) const
+    {
+        const int bx = x / TARGET_BUCKET_SIZE, by = y / TARGET_BUCKET_SIZE;
+        const int maxRing = std::max(std::max(bx, columns - 1 - bx), std::max(by, rows - 1 - by));
+        float best = std::numeric_limits<float>::max();
+        auto visit = [&](int column, int row)
+        {
+            const int bucket = row * columns + column;
+            for (int i = bucketStart[static_cast<std::size_t>(bucket)]; i < bucketStart[static_cast<std::size_t>(bucket + 1)]; ++i)
+            {
+                const int cell = cells[static_cast<std::size_t>(i)];
+                best = std::min(best, Metric::between(cell % width - x, cell / width - y));
+            }
+        };
+        for (int ring = 0; ring <= maxRing; ++ring)
+        {
+            // Cells of ring r are at least (r - 1) * size + 1 cells away along some axis, and both
+            // metrics are at least the larger axis distance
+            if (ring > 0 && static_cast<float>((ring - 1) * TARGET_BUCKET_SIZE + 1) >= best)
+                break;
+            for (int row = std::max(0, by - ring); row <= std::min(rows - 1, by + ring); ++row)
+            {
+                if (row == by - ring || row == by + ring)
+                {
+                    for (int column = std::max(0, bx - ring); column <= std::min(columns - 1, bx + ring); ++column)
+                        visit(column, row);
+                    continue;
+                }
+                if (bx - ring >= 0)
+                    visit(bx - ring, row);
+                if (bx + ring < columns)
+                    visit(bx + ring, row);
+            }
+        }
+        return best;
+    }
+};
+
+TargetIndex buildTargetIndex(const Grid &grid, const std::vector<int> &targets);
+
+// Distance to the nearest target under the movement model's metric
+template <typename Movement>
+struct NearestTargetHeuristic
+{
+    using Metric = typename Movement::Distance;
+    const TargetIndex &targets;
+
+    float at(int cell) const { return targets.nearest<Metric>(cell % targets.width, cell / targets.width); }
+    void successors(int, int x, int y, unsigned mask, float *out) const
+    {
+        for (; mask != 0; mask &= mask - 1)
+        {
+            const int d = __builtin_ctz(mask);
+            out[d] = targets.nearest<Metric>(x + DIRECTION_DX[d], y + DIRECTION_DY[d]);
+        }
+    }
+};
+
+// Dijkstra or A* from start to the nearest target; reached names it (-1 if none is reachable)
+// and the path to it is left in context
+template <typename Trace = NullSearchTrace>
+SearchResult searchNearestTarget(const Grid &grid, Algorithm algorithm, MovementModel movement, int start, const TargetIndex &targets,
+                                 int &reached, SearchContext &context, Trace &&trace = Trace())
+{
+    return withMovement(movement, [&](auto policy)
+                        {
+                            using Movement = decltype(policy);
+                            if (algorithm == Algorithm::AStar && !targets.empty())
+                                return searchGridUntil<Movement>(grid, start, targets, reached, context, NearestTargetHeuristic<Movement>{targets}, NoPruning(), StaticCosts(), trace);
+                            return searchGridUntil<Movement>(grid, start, targets, reached, context, ZeroHeuristic(), NoPruning(), StaticCosts(), trace); });
+}
+
+// Routes through ordered waypoints. Keeps its workers and one search context per worker
+// between routes, so repeated queries neither start threads nor reallocate search state.
+class WaypointRouter
+{
+public:
+    explicit WaypointRouter(unsigned threads);
+
+    // Path through waypoints[0], waypoints[1], ... in order, each joint cell appearing once. The
+    // result is found only if every segment is; its cost and expansions are the segments' sums.
+    SearchResult route(const Grid &grid, Algorithm algorithm, MovementModel movement, const std::vector<int> &waypoints, std::vector<int> &path);
+
+private:
+    unsigned workers;
+    ThreadPool pool;
+    std::vector<SearchContext> contexts;
+    std::vector<std::vector<int>> segments;
+    std::vector<SearchResult> results;
+};
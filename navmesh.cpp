@@ -0,0 +1,267 @@
+#include "navmesh.hpp"
+
+#include <cmath>
+
+static float distanceBetween(NavPoint a, NavPoint b)
+{
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+static NavPoint cellCenter(int cell, int width)
+{
+    return {static_cast<float>(cell % width) + 0.5f, static_cast<float>(cell / width) + 0.5f};
+}
+
+// Twice the signed area of triangle (a, b, c); its sign tells on which side of a->b c lies
+static float triangleArea2(NavPoint a, NavPoint b, NavPoint c)
+{
+    return (c.x - a.x) * (b.y - a.y) - (b.x - a.x) * (c.y - a.y);
+}
+
+static bool samePoint(NavPoint a, NavPoint b)
+{
+    return std::abs(a.x - b.x) < 1e-5f && std::abs(a.y - b.y) < 1e-5f;
+}
+
+NavMesh buildNavMesh(const Grid &grid, MovementModel movement, unsigned threads)
+{
+    NavMesh mesh;
+    mesh.movement = movement;
+    mesh.polygons = decomposeRectangles(grid, threads);
+    const RectangleDecomposition &rects = mesh.polygons;
+
+    // Right and bottom edges of each rectangle, split into runs of one neighbor
+    auto addLink = [&](int from, int to, NavPoint a, NavPoint b)
+    { mesh.edges.push_back({{from, to}, {a, b}}); };
+    for (int id = 0; id < static_cast<int>(rects.rects.size()); ++id)
+    {
+        const GridRect &rect = rects.rects[static_cast<std::size_t>(id)];
+        const int right = rect.x + rect.width, bottom = rect.y + rect.height;
+        if (right < grid.width)
+        {
+            for (int y = rect.y; y < bottom;)
+            {
+                int neighbor = rects.rectOf[static_cast<std::size_t>(grid.cellId(right, y))];
+                int end = y + 1;
+                while (end < bottom && rects.rectOf[static_cast<std::size_t>(grid.cellId(right, end))] == neighbor)
+                    ++end;
+                if (neighbor >= 0)
+                    addLink(id, neighbor, {static_cast<float>(right), static_cast<float>(y)}, {static_cast<float>(right), static_cast<float>(end)});
+                y = end;
+            }
+        }
+        if (bottom < grid.height)
+        {
+            for (int x = rect.x; x < right;)
+            {
+                int neighbor = rects.rectOf[static_cast<std::size_t>(grid.cellId(x, bottom))];
+                int end = x + 1;
+                while (end < right && rects.rectOf[static_cast<std::size_t>(grid.cellId(end, bottom))] == neighbor)
+                    ++end;
+                if (neighbor >= 0)
+                    addLink(id, neighbor, {static_cast<float>(x), static_cast<float>(bottom)}, {static_cast<float>(end), static_cast<float>(bottom)});
+                x = end;
+            }
+        }
+    }
+
+    // Diagonal squeezes: free cells meeting only at a corner whose other two cells are walls
+    if (movement == MovementModel::CornerCutting)
+    {
+        auto free = [&](int x, int y) { return !grid.isWall(x, y); };
+        for (int y = 1; y < grid.height; ++y)
+        {
+            for (int x = 1; x < grid.width; ++x)
+            {
+                const NavPoint corner{static_cast<float>(x), static_cast<float>(y)};
+                if (free(x - 1, y - 1) && free(x, y) && !free(x, y - 1) && !free(x - 1, y))
+                    addLink(rects.rectOf[static_cast<std::size_t>(grid.cellId(x - 1, y - 1))], rects.rectOf[static_cast<std::size_t>(grid.cellId(x, y))],
+                            corner, corner);
+                else if (free(x, y - 1) && free(x - 1, y) && !free(x - 1, y - 1) && !free(x, y))
+                    addLink(rects.rectOf[static_cast<std::size_t>(grid.cellId(x, y - 1))], rects.rectOf[static_cast<std::size_t>(grid.cellId(x - 1, y))],
+                            corner, corner);
+            }
+        }
+    }
+
+    // Each edge is a portal of both its polygons; bucket them by polygon, with a on the left seen from inside
+    mesh.firstPortal.assign(rects.rects.size() + 1, 0);
+    for (const NavEdge &edge : mesh.edges)
+    {
+        ++mesh.firstPortal[static_cast<std::size_t>(edge.polygons[0]) + 1];
+        ++mesh.firstPortal[static_cast<std::size_t>(edge.polygons[1]) + 1];
+    }
+    for (std::size_t p = 1; p < mesh.firstPortal.size(); ++p)
+        mesh.firstPortal[p] += mesh.firstPortal[p - 1];
+    mesh.portals.resize(mesh.edges.size() * 2);
+    std::vector<int> fill(mesh.firstPortal.begin(), mesh.firstPortal.end() - 1);
+    for (int e = 0; e < static_cast<int>(mesh.edges.size()); ++e)
+    {
+        const NavEdge &edge = mesh.edges[static_cast<std::size_t>(e)];
+        for (int side = 0; side < 2; ++side)
+        {
+            NavPortal portal{edge.polygons[side], edge.polygons[1 - side], e, edge.ends[0], edge.ends[1]};
+            const GridRect &rect = rects.rects[static_cast<std::size_t>(portal.from)];
+            NavPoint center{rect.x + rect.width * 0.5f, rect.y + rect.height * 0.5f};
+            if (triangleArea2(center, portal.a, portal.b) < 0.0f)
+                std::swap(portal.a, portal.b);
+            mesh.portals[static_cast<std::size_t>(fill[static_cast<std::size_t>(portal.from)]++)] = portal;
+        }
+    }
+    return mesh;
+}
+
+// Funnel ("string pulling") over portals whose a/b are the left/right ends; the first and
+// last entries are the degenerate start and goal portals
+static void pullString(const std::vector<NavPortal> &corridor, std::vector<NavPoint> &path)
+{
+    NavPoint apex = corridor.front().a, left = apex, right = apex;
+    std::size_t apexIndex = 0, leftIndex = 0, rightIndex = 0;
+    path.assign(1, apex);
+    for (std::size_t i = 1; i < corridor.size(); ++i)
+    {
+        const NavPoint portalLeft = corridor[i].a, portalRight = corridor[i].b;
+
+        // Tighten the right side, or restart from the left corner once right crosses over it
+        if (triangleArea2(apex, right, portalRight) <= 0.0f)
+        {
+            if (samePoint(apex, right) || triangleArea2(apex, left, portalRight) > 0.0f)
+            {
+                right = portalRight;
+                rightIndex = i;
+            }
+            else
+            {
+                apex = left;
+                apexIndex = leftIndex;
+                path.push_back(apex);
+                right = left = apex;
+                rightIndex = leftIndex = i = apexIndex;
+                continue;
+            }
+        }
+
+        // Same for the left side
+        if (triangleArea2(apex, left, portalLeft) >= 0.0f)
+        {
+            if (samePoint(apex, left) || triangleArea2(apex, right, portalLeft) < 0.0f)
+            {
+                left = portalLeft;
+                leftIndex = i;
+            }
+            else
+            {
+                apex = right;
+                apexIndex = rightIndex;
+                path.push_back(apex);
+                right = left = apex;
+                rightIndex = leftIndex = i = apexIndex;
+                continue;
+            }
+        }
+    }
+    if (!samePoint(path.back(), corridor.back().a))
+        path.push_back(corridor.back().a);
+}
+
+SearchResult findNavMeshPath(const NavMesh &mesh, int start, int goal, SearchContext &context, std::vector<NavPoint> &path)
+{
+    SearchResult result;
+    path.clear();
+    const RectangleDecomposition &rects = mesh.polygons;
+    const int startPolygon = rects.rectOf[static_cast<std::size_t>(start)];
+    const int goalPolygon = rects.rectOf[static_cast<std::size_t>(goal)];
+    if (startPolygon < 0 || goalPolygon < 0)
+        return result;
+    const NavPoint startPoint = cellCenter(start, rects.width), goalPoint = cellCenter(goal, rects.width);
+
+    // Nodes are edge endpoints (2 per edge) plus the start and goal points; via records the
+    // polygon each node was reached through, which determines the corridor
+    const int startNode = static_cast<int>(mesh.edges.size()) * 2, goalNode = startNode + 1;
+    auto point = [&](int node)
+    {
+        if (node == startNode)
+            return startPoint;
+        if (node == goalNode)
+            return goalPoint;
+        return mesh.edges[static_cast<std::size_t>(node / 2)].ends[node % 2];
+    };
+    context.begin(goalNode + 1);
+    std::vector<int> via(static_cast<std::size_t>(goalNode + 1), -1);
+    context.set(startNode, 0.0f, -1);
+    via[static_cast<std::size_t>(startNode)] = startPolygon;
+    context.push(distanceBetween(startPoint, goalPoint), startNode);
+
+    while (!context.open.empty())
+    {
+        int node = openEntryCell(context.pop());
+        if (!context.close(node))
+            continue;
+        ++result.expanded;
+        if (node == goalNode)
+            break;
+
+        const NavPoint from = point(node);
+        auto relax = [&](int next, int polygon)
+        {
+            const NavPoint to = point(next);
+            float ng = context.g[static_cast<std::size_t>(node)] + distanceBetween(from, to);
+            if (ng < context.cost(next))
+            {
+                context.set(next, ng, node);
+                via[static_cast<std::size_t>(next)] = polygon;
+                context.push(ng + distanceBetween(to, goalPoint), next);
+            }
+        };
+        int polygons[2] = {startPolygon, -1};
+        if (node != startNode)
+        {
+            polygons[0] = mesh.edges[static_cast<std::size_t>(node / 2)].polygons[0];
+            polygons[1] = mesh.edges[static_cast<std::size_t>(node / 2)].polygons[1];
+        }
+        for (int polygon : polygons)
+        {
+            if (polygon < 0)
+                continue;
+            if (polygon == goalPolygon)
+                relax(goalNode, polygon);
+            for (int p = mesh.firstPortal[static_cast<std::size_t>(polygon)]; p < mesh.firstPortal[static_cast<std::size_t>(polygon) + 1]; ++p)
+            {
+                const int edge = mesh.portals[static_cast<std::size_t>(p)].edge;
+                relax(edge * 2, polygon);
+                relax(edge * 2 + 1, polygon);
+            }
+        }
+    }
+    if (context.cost(goalNode) == std::numeric_limits<float>::max())
+        return result;
+
+    // Wherever the polygon changes along the node path, the path crosses the edge of the node it left
+    std::vector<NavPortal> corridor;
+    corridor.push_back({goalPolygon, goalPolygon, -1, goalPoint, goalPoint});
+    for (int node = goalNode; context.prev[static_cast<std::size_t>(node)] >= 0;)
+    {
+        const int previous = context.prev[static_cast<std::size_t>(node)];
+        const int polygon = via[static_cast<std::size_t>(previous)], next = via[static_cast<std::size_t>(node)];
+        if (polygon != next)
+        {
+            for (int p = mesh.firstPortal[static_cast<std::size_t>(polygon)]; p < mesh.firstPortal[static_cast<std::size_t>(polygon) + 1]; ++p)
+            {
+                if (mesh.portals[static_cast<std::size_t>(p)].edge == previous / 2)
+                {
+                    corridor.push_back(mesh.portals[static_cast<std::size_t>(p)]);
+                    break;
+                }
+            }
+        }
+        node = previous;
+    }
+    corridor.push_back({startPolygon, startPolygon, -1, startPoint, startPoint});
+    std::reverse(corridor.begin(), corridor.end());
+    pullString(corridor, path);
+
+    result.found = true;
+    for (std::size_t i = 1; i < path.size(); ++i)
+        result.cost += distanceBetween(path[i - 1], path[i]);
+    return result;
+}
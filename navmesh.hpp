@@ -0,0 +1,62 @@
+// Navigation mesh over the wall grid for agents that move in continuous space. The mesh's
+// convex polygons are the empty rectangles of the RSR decomposition; polygons that share an
+// edge are linked by a portal (the shared segment). Queries run A* over polygons and
+// straighten the polygon corridor with the funnel algorithm, so paths are any-angle and
+// the graph is a few hundred polygons where the grid has tens of thousands of cells.
+#pragma once
+
+#include <vector>
+
+#include "pathfinding.hpp"
+#include "rsr.hpp"
+
+// Point in grid units; cell (x, y) covers [x, x + 1) x [y, y + 1)
+struct NavPoint
+{
+    float x, y;
+};
+
+// Segment shared by two polygons
+struct NavEdge
+{
+    int polygons[2];
+    NavPoint ends[2];
+};
+
+// An edge as seen from one of its polygons, with its ends ordered left/right for the funnel
+struct NavPortal
+{
+    int from, to;
+    int edge;
+    NavPoint a, b; // Left and right end seen from inside from
+};
+
+struct NavMesh
+{
+    MovementModel movement = MovementModel::CornerCutting;
+    RectangleDecomposition polygons;
+    std::vector<NavEdge> edges;
+    std::vector<int> firstPortal; // Portals of polygon p are [firstPortal[p], firstPortal[p + 1])
+    std::vector<NavPortal> portals;
+
+    int polygonCount() const { return static_cast<int>(polygons.rects.size()); }
+    bool valid(const Grid &grid, MovementModel model) const { return polygons.valid(grid) && movement == model; }
+    std::size_t memoryBytes() const
+    {
+        return polygons.rects.size() * sizeof(GridRect) + edges.size() * sizeof(NavEdge) + firstPortal.size() * sizeof(int) +
+               portals.size() * sizeof(NavPortal);
+    }
+};
+
+// Decomposes the grid on threads workers and links adjacent rectangles, so polygons connect
+// wherever cells do under the movement model. Rectangles that only touch at a corner are linked
+// only where the model cuts corners and the other two cells there are walls: the zero-width
+// portal at the corner is the grid's diagonal squeeze, and paths through it graze both walls.
+NavMesh buildNavMesh(const Grid &grid, MovementModel movement, unsigned threads);
+
+// Picks the polygon corridor from start to goal (cell ids) with A* over edge endpoints, where
+// endpoints of one convex polygon see each other; wall corners are edge endpoints, so this is
+// close to the shortest any-angle route. The funnel algorithm then straightens the corridor.
+// path receives the corners from the start cell's center to the goal cell's center,
+// result.cost is the length of that polyline and result.expanded counts endpoints.
+SearchResult findNavMeshPath(const NavMesh &mesh, int start, int goal, SearchContext &context, std::vector<NavPoint> &path);
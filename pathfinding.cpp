@@ -0,0 +1,32 @@
+#include "pathfinding.hpp"
+
+#include <fstream>
+
+bool loadGridFile(const std::string &path, Grid &grid)
+{
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    std::vector<std::string> lines;
+    std::string line;
+    std::size_t width = 0;
+    while (std::getline(in, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        width = std::max(width, line.size());
+        lines.push_back(line);
+    }
+    if (width == 0)
+        return false;
+
+    grid = Grid(static_cast<int>(width), static_cast<int>(lines.size()));
+    for (int y = 0; y < grid.height; ++y)
+    {
+        for (int x = 0; x < static_cast<int>(lines[y].size()); ++x)
+        {
+            grid.setWall(x, y, lines[y][x] == '#');
+        }
+    }
+    return true;
+}
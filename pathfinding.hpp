@@ -0,0 +1,591 @@
+// Grid pathfinding engine shared by the visualizer, the query server and its clients.
+// Has no SFML dependency so it can run in headless and server processes.
+#pragma once
+
+#include <vector>
+#include <array>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <algorithm>
+#include <utility>
+
+#include "simd_kernels.hpp"
+
+// Define costs for movement
+const float CARDINAL_COST = 1.0f;
+const float DIAGONAL_COST = std::sqrt(2.0f); // Approximately 1.414
+
+struct GridOffset
+{
+    int x, y;
+};
+
+// Directions for 8-directional movement (static const to avoid re-creation)
+static const std::array<GridOffset, 8> directions = {{{1, 0}, {0, 1}, {-1, 0}, {0, -1}, {1, 1}, {-1, 1}, {1, -1}, {-1, -1}}};
+
+// Direction index of the reverse move of each entry of `directions`
+const int OPPOSITE_DIRECTION[8] = {2, 3, 0, 1, 7, 6, 5, 4};
+
+// Wall map. Cells are addressed by (x, y) or by their row-major cell id y * width + x.
+// Alongside the walls the grid caches, per cell, which of its 8 moves are legal, so searches
+// never probe walls or bounds. setWall keeps the cache current; code that writes `walls`
+// directly must call rebuildNeighbors() afterwards.
+struct Grid
+{
+    int width = 0;
+    int height = 0;
+    std::vector<std::uint8_t> walls;     // 1 = wall, 0 = traversable
+    std::vector<std::uint8_t> neighbors; // Bit d set if directions[d] leads to an in-bounds, non-wall cell
+
+    Grid() = default;
+    Grid(int w, int h) : width(w), height(h), walls(static_cast<std::size_t>(w) * static_cast<std::size_t>(h), 0)
+    {
+        rebuildNeighbors();
+    }
+
+    int cellCount() const { return width * height; }
+    int cellId(int x, int y) const { return y * width + x; }
+    bool inBounds(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+    bool isWall(int x, int y) const { return walls[static_cast<std::size_t>(cellId(x, y))] != 0; }
+    unsigned neighborMask(int cell) const { return neighbors[static_cast<std::size_t>(cell)]; }
+
+    // Only the moves into (x, y) change, i.e. one bit in each of the surrounding masks
+    void setWall(int x, int y, bool value)
+    {
+        walls[static_cast<std::size_t>(cellId(x, y))] = value ? 1 : 0;
+        for (int d = 0; d < 8; ++d)
+        {
+            int nx = x + directions[d].x, ny = y + directions[d].y;
+            if (!inBounds(nx, ny))
+                continue;
+            std::uint8_t &mask = neighbors[static_cast<std::size_t>(cellId(nx, ny))];
+            std::uint8_t bit = static_cast<std::uint8_t>(1u << OPPOSITE_DIRECTION[d]);
+            mask = value ? static_cast<std::uint8_t>(mask & ~bit) : static_cast<std::uint8_t>(mask | bit);
+        }
+    }
+
+    void rebuildNeighbors()
+    {
+        neighbors.assign(walls.size(), 0);
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                unsigned mask = 0;
+                for (int d = 0; d < 8; ++d)
+                {
+                    int nx = x + directions[d].x, ny = y + directions[d].y;
+                    if (inBounds(nx, ny) && !isWall(nx, ny))
+                        mask |= 1u << d;
+                }
+                neighbors[static_cast<std::size_t>(cellId(x, y))] = static_cast<std::uint8_t>(mask);
+            }
+        }
+    }
+};
+
+// Cell id delta of each entry of `directions` on a grid of the given width
+inline std::array<int, 8> neighborOffsets(int width)
+{
+    std::array<int, 8> offsets;
+    for (int d = 0; d < 8; ++d)
+        offsets[d] = directions[d].y * width + directions[d].x;
+    return offsets;
+}
+
+// Loads a text map: one line per row, '#' is a wall, anything else is ground.
+// The grid is sized to the longest line and the number of lines.
+bool loadGridFile(const std::string &path, Grid &grid);
+
+enum class Algorithm : std::uint8_t
+{
+    Dijkstra = 0,
+    AStar = 1
+};
+
+struct SearchResult
+{
+    bool found = false;
+    float cost = 0.0f;
+    std::uint32_t expanded = 0; // Nodes popped and expanded
+};
+
+// Open-list entry packed into one integer: order-preserving bits of f in the high word and the
+// cell id in the low word, so heap comparisons are single integer compares (equal f breaks
+// ties by cell id) and 8 entries fit in a cache line. g is read from the state arrays.
+using OpenEntry = std::uint64_t;
+
+// Maps a float to unsigned bits with the same ordering
+inline std::uint32_t orderedBits(float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+inline OpenEntry packOpenEntry(float f, int cell)
+{
+    return (static_cast<OpenEntry>(orderedBits(f)) << 32) | static_cast<std::uint32_t>(cell);
+}
+
+inline int openEntryCell(OpenEntry entry)
+{
+    return static_cast<int>(static_cast<std::uint32_t>(entry));
+}
+
+// Reusable per-thread search state. Arrays are sized once and invalidated with a
+// generation counter, so repeated queries do not reallocate or clear them.
+struct SearchContext
+{
+    std::vector<float> g;
+    std::vector<int> prev;
+    std::vector<std::uint32_t> stamp;  // Generation in which g/prev were last written
+    std::vector<std::uint32_t> closed; // Generation in which the cell was expanded
+    std::vector<OpenEntry> open;       // Min-heap
+    std::uint32_t generation = 0;
+
+    void begin(int cellCount)
+    {
+        if (static_cast<int>(g.size()) != cellCount)
+        {
+            g.assign(static_cast<std::size_t>(cellCount), 0.0f);
+            prev.assign(static_cast<std::size_t>(cellCount), -1);
+            stamp.assign(static_cast<std::size_t>(cellCount), 0);
+            closed.assign(static_cast<std::size_t>(cellCount), 0);
+            generation = 0;
+        }
+        if (++generation == 0)
+        {
+            // Counter wrapped: old stamps could alias the new generation
+            std::fill(stamp.begin(), stamp.end(), 0);
+            std::fill(closed.begin(), closed.end(), 0);
+            generation = 1;
+        }
+        open.clear();
+    }
+
+    float cost(int cell) const
+    {
+        return stamp[static_cast<std::size_t>(cell)] == generation ? g[static_cast<std::size_t>(cell)] : std::numeric_limits<float>::max();
+    }
+
+    void set(int cell, float cost, int parent)
+    {
+        stamp[static_cast<std::size_t>(cell)] = generation;
+        g[static_cast<std::size_t>(cell)] = cost;
+        prev[static_cast<std::size_t>(cell)] = parent;
+    }
+
+    // Marks cell expanded; false if it already was
+    bool close(int cell)
+    {
+        if (closed[static_cast<std::size_t>(cell)] == generation)
+            return false;
+        closed[static_cast<std::size_t>(cell)] = generation;
+        return true;
+    }
+
+    void push(float f, int cell)
+    {
+        open.push_back(packOpenEntry(f, cell));
+        std::push_heap(open.begin(), open.end(), std::greater<OpenEntry>());
+    }
+
+    OpenEntry pop()
+    {
+        std::pop_heap(open.begin(), open.end(), std::greater<OpenEntry>());
+        OpenEntry entry = open.back();
+        open.pop_back();
+        return entry;
+    }
+};
+
+// Search state for graphs whose parent is implied by a small code, such as the direction of
+// the move into the state: per state g, a stamp and a ParentBits-bit parent code, packed
+// 64 / ParentBits to a 64-bit word. Opened and expanded share one stamp, so the generation
+// only counts up to 2^31.
+template <int ParentBits>
+struct PackedParentContext
+{
+    static constexpr int PER_WORD = 64 / ParentBits;
+    static constexpr std::uint64_t MASK = (1ull << ParentBits) - 1;
+
+    std::vector<float> g;
+    std::vector<std::uint32_t> stamp;   // 2 * generation once opened, 2 * generation + 1 once expanded
+    std::vector<std::uint64_t> parents; // Parent code per state
+    std::vector<OpenEntry> open;        // Min-heap
+    std::uint32_t generation = 0;
+
+    void begin(int stateCount)
+    {
+        if (static_cast<int>(g.size()) != stateCount)
+        {
+            g.assign(static_cast<std::size_t>(stateCount), 0.0f);
+            stamp.assign(static_cast<std::size_t>(stateCount), 0);
+            parents.assign(static_cast<std::size_t>(stateCount + PER_WORD - 1) / PER_WORD, 0);
+            generation = 0;
+        }
+        if (++generation >= 0x7FFFFFFFu)
+        {
+            // Doubled stamps would overflow: old stamps could alias the new generation
+            std::fill(stamp.begin(), stamp.end(), 0);
+            generation = 1;
+        }
+        open.clear();
+    }
+
+    float cost(int state) const
+    {
+        return stamp[static_cast<std::size_t>(state)] >> 1 == generation ? g[static_cast<std::size_t>(state)] : std::numeric_limits<float>::max();
+    }
+
+    std::uint8_t parent(int state) const
+    {
+        return static_cast<std::uint8_t>(parents[static_cast<std::size_t>(state / PER_WORD)] >> (state % PER_WORD * ParentBits) & MASK);
+    }
+
+    void set(int state, float cost, std::uint8_t parentCode)
+    {
+        stamp[static_cast<std::size_t>(state)] = generation * 2;
+        g[static_cast<std::size_t>(state)] = cost;
+        std::uint64_t &word = parents[static_cast<std::size_t>(state / PER_WORD)];
+        const int shift = state % PER_WORD * ParentBits;
+        word = (word & ~(MASK << shift)) | static_cast<std::uint64_t>(parentCode) << shift;
+    }
+
+    // Marks state expanded; false if it already was
+    bool close(int state)
+    {
+        if (stamp[static_cast<std::size_t>(state)] == generation * 2 + 1)
+            return false;
+        stamp[static_cast<std::size_t>(state)] = generation * 2 + 1;
+        return true;
+    }
+
+    void push(float f, int state)
+    {
+        open.push_back(packOpenEntry(f, state));
+        std::push_heap(open.begin(), open.end(), std::greater<OpenEntry>());
+    }
+
+    OpenEntry pop()
+    {
+        std::pop_heap(open.begin(), open.end(), std::greater<OpenEntry>());
+        OpenEntry entry = open.back();
+        open.pop_back();
+        return entry;
+    }
+
+    // Per-state arrays only; the open list grows with the queries
+    std::size_t stateBytes() const
+    {
+        return g.size() * sizeof(float) + stamp.size() * sizeof(std::uint32_t) + parents.size() * sizeof(std::uint64_t);
+    }
+};
+
+// Search event sink. The visualizer records these as animation steps; queries use this no-op version.
+struct NullSearchTrace
+{
+    void opened(int) {}
+    void visited(int) {}
+};
+
+// Heuristics expose at(cell) for single cells and successors(), which evaluates all
+// neighbors of an expanded cell in one batch so the engine makes one call per expansion.
+// successors() must fill out[d] for every direction in mask; other entries are ignored.
+
+// Dijkstra: no heuristic
+struct ZeroHeuristic
+{
+    float at(int) const { return 0.0f; }
+    void successors(int, int, int, unsigned, float *out) const { std::fill(out, out + 8, 0.0f); }
+};
+
+// Octile distance, exact on an empty 8-connected grid
+struct OctileHeuristic
+{
+    int width, goalX, goalY;
+
+    OctileHeuristic(const Grid &grid, int goal) : width(grid.width), goalX(goal % grid.width), goalY(goal / grid.width) {}
+
+    static float between(int dx, int dy) { return octileDistance(dx, dy); }
+    float at(int cell) const { return octileDistance(cell % width - goalX, cell / width - goalY); }
+    void successors(int, int x, int y, unsigned, float *out) const { simdKernels.octile(x, y, goalX, goalY, out); }
+};
+
+// 4-connected distance
+struct ManhattanHeuristic
+{
+    int width, goalX, goalY;
+
+    ManhattanHeuristic(const Grid &grid, int goal) : width(grid.width), goalX(goal % grid.width), goalY(goal / grid.width) {}
+
+    static float between(int dx, int dy) { return static_cast<float>(std::abs(dx) + std::abs(dy)); }
+    float at(int cell) const { return static_cast<float>(std::abs(cell % width - goalX) + std::abs(cell / width - goalY)); }
+    void successors(int, int x, int y, unsigned, float *out) const
+    {
+        for (int d = 0; d < 8; ++d)
+            out[d] = static_cast<float>(std::abs(x + DIRECTION_DX[d] - goalX) + std::abs(y + DIRECTION_DY[d] - goalY));
+    }
+};
+
+// Movement models, passed to the engine as template parameters. moves() narrows a cell's cached
+// neighbor mask to the moves the model allows; it compiles down to a few bit operations, so the
+// model costs nothing in the loop. Distance is the exact heuristic on an empty grid.
+enum class MovementModel : std::uint8_t
+{
+    CornerCutting = 0,   // Diagonals allowed whenever the target cell is free
+    NoCornerCutting = 1, // Diagonals need both adjacent straight cells free
+    FourConnected = 2
+};
+
+struct CornerCutting
+{
+    using Distance = OctileHeuristic;
+    static unsigned moves(unsigned neighbors) { return neighbors; }
+};
+
+struct NoCornerCutting
+{
+    using Distance = OctileHeuristic;
+    static unsigned moves(unsigned neighbors)
+    {
+        // Bits 0-3 are +x, +y, -x, -y; diagonal bits 4-7 are (+x+y), (-x+y), (+x-y), (-x-y)
+        unsigned diagonals = ((neighbors & (neighbors >> 1)) & 1u) << 4 |
+                             ((neighbors >> 1) & (neighbors >> 2) & 1u) << 5 |
+                             (neighbors & (neighbors >> 3) & 1u) << 6 |
+                             ((neighbors >> 2) & (neighbors >> 3) & 1u) << 7;
+        return neighbors & (0x0Fu | diagonals);
+    }
+};
+
+struct FourConnected
+{
+    using Distance = ManhattanHeuristic;
+    static unsigned moves(unsigned neighbors) { return neighbors & 0x0Fu; }
+};
+
+// Calls function with an instance of the policy type selected by a runtime model
+template <typename Function>
+auto withMovement(MovementModel movement, Function &&function)
+{
+    switch (movement)
+    {
+    case MovementModel::NoCornerCutting:
+        return function(NoCornerCutting());
+    case MovementModel::FourConnected:
+        return function(FourConnected());
+    default:
+        return function(CornerCutting());
+    }
+}
+
+inline const char *movementName(MovementModel movement)
+{
+    switch (movement)
+    {
+    case MovementModel::NoCornerCutting:
+        return "no corner cutting";
+    case MovementModel::FourConnected:
+        return "4-connected";
+    default:
+        return "corner cutting";
+    }
+}
+
+// Pruning policies drop moves that preprocessing has shown cannot start a shortest path to the
+// current goal: moves(cell) returns the mask of moves out of cell that may still be relaxed.
+// Policies for engines with macro steps (RSR, subgoal graphs) also provide keeps(cell), which
+// tells whether a step may end on the cell at all.
+struct NoPruning
+{
+    unsigned moves(int) const { return 0xFF; }
+    bool keeps(int) const { return true; }
+};
+
+// Applies two pruning policies at once: a move or cell survives only if both keep it
+template <typename First, typename Second>
+struct BothPruning
+{
+    const First &first;
+    const Second &second;
+
+    unsigned moves(int cell) const { return first.moves(cell) & second.moves(cell); }
+    bool keeps(int cell) const { return first.keeps(cell) && second.keeps(cell); }
+};
+
+// Cost policies price moves whose cost is not the static DIRECTION_COSTS one: varying(cell, moves)
+// picks those out of the moves from cell, and cost(next, g, step) is the g of next after such a
+// move of static cost step from a cell at g. Costs never below g + step keep the heuristics
+// consistent.
+struct StaticCosts
+{
+    unsigned varying(int, unsigned) const { return 0; }
+    float cost(int, float g, float step) const { return g + step; }
+};
+
+// Goal policies end the search: reached(cell) is true for every cell the search may stop on
+struct SingleGoal
+{
+    int cell; // Negative to explore the whole reachable area
+
+    bool reached(int other) const { return other == cell; }
+};
+
+// Runs a best-first search from start (cell id) under the Movement model, ordered by
+// g + heuristic and relaxing only the moves the pruning policy keeps at the cost policy's
+// prices, until it expands a cell the goal policy accepts; that cell is written to reached (-1
+// if none was). The search tree is left in context, so callers can reconstruct the path into
+// whatever storage they own.
+template <typename Movement, typename Goal, typename Heuristic, typename Pruning, typename Costs = StaticCosts, typename Trace = NullSearchTrace>
+SearchResult searchGridUntil(const Grid &grid, int start, const Goal &goal, int &reached, SearchContext &context, const Heuristic &heuristic,
+                             const Pruning &pruning, const Costs &costs = Costs(), Trace &&trace = Trace())
+{
+    SearchResult result;
+    const int W = grid.width;
+    const std::array<int, 8> offsets = neighborOffsets(W);
+    const RelaxKernel relax = simdKernels.relax;
+
+    reached = -1;
+    context.begin(grid.cellCount());
+    context.set(start, 0.0f, -1);
+    context.push(heuristic.at(start), start);
+    trace.opened(start); // Start node is initially 'open'
+
+    while (!context.open.empty())
+    {
+        int cell = openEntryCell(context.pop());
+
+        // Heuristics are consistent, so the first pop of a cell carries its final cost
+        // and later entries for it are stale
+        if (!context.close(cell))
+            continue;
+        int cx = cell % W, cy = cell / W;
+        float cg = context.g[static_cast<std::size_t>(cell)];
+
+        ++result.expanded;
+        trace.visited(cell);
+
+        if (goal.reached(cell))
+        {
+            reached = cell;
+            result.found = true;
+            result.cost = cg;
+            break;
+        }
+
+        // Relax all 8 neighbors at once, then evaluate the heuristic for the improved ones in one batch.
+        // Moves with varying costs are relaxed one by one. Improved neighbors are pushed in direction order.
+        float candidates[8];
+        const unsigned moves = Movement::moves(grid.neighborMask(cell)) & pruning.moves(cell);
+        const unsigned varying = costs.varying(cell, moves);
+        RelaxInput input{context.g.data(), context.stamp.data(), context.generation, cell, offsets.data(), moves & ~varying, cg};
+        unsigned improved = relax(input, candidates);
+        for (unsigned m = varying; m != 0; m &= m - 1)
+        {
+            const int d = __builtin_ctz(m);
+            const float ng = costs.cost(cell + offsets[static_cast<std::size_t>(d)], cg, DIRECTION_COSTS[d]);
+            if (ng < context.cost(cell + offsets[static_cast<std::size_t>(d)]))
+            {
+                candidates[d] = ng;
+                improved |= 1u << d;
+            }
+        }
+        if (improved == 0)
+            continue;
+        float h[8];
+        heuristic.successors(cell, cx, cy, improved, h);
+        for (; improved != 0; improved &= improved - 1)
+        {
+            int d = __builtin_ctz(improved);
+            int next = cell + offsets[static_cast<std::size_t>(d)];
+            float ng = candidates[d];
+            context.set(next, ng, cell);
+            context.push(ng + h[d], next);
+            trace.opened(next);
+        }
+    }
+    return result;
+}
+
+// Search from start to goal (cell ids); a negative goal explores the whole reachable area
+template <typename Movement, typename Heuristic, typename Pruning, typename Trace = NullSearchTrace>
+SearchResult searchGridPruned(const Grid &grid, int start, int goal, SearchContext &context, const Heuristic &heuristic,
+                              const Pruning &pruning, Trace &&trace = Trace())
+{
+    int reached;
+    return searchGridUntil<Movement>(grid, start, SingleGoal{goal}, reached, context, heuristic, pruning, StaticCosts(), std::forward<Trace>(trace));
+}
+
+// Unpruned search; see searchGridPruned
+template <typename Movement = CornerCutting, typename Heuristic, typename Trace = NullSearchTrace>
+SearchResult searchGridWith(const Grid &grid, int start, int goal, SearchContext &context, const Heuristic &heuristic,
+                            Trace &&trace = Trace())
+{
+    return searchGridPruned<Movement>(grid, start, goal, context, heuristic, NoPruning(), std::forward<Trace>(trace));
+}
+
+// Runs Dijkstra or A* (with the movement model's distance heuristic) from start to goal
+template <typename Trace = NullSearchTrace>
+SearchResult searchGrid(const Grid &grid, Algorithm algorithm, MovementModel movement, int start, int goal,
+                        SearchContext &context, Trace &&trace = Trace())
+{
+    return withMovement(movement, [&](auto policy)
+                        {
+                            using Movement = decltype(policy);
+                            if (algorithm == Algorithm::AStar)
+                                return searchGridWith<Movement>(grid, start, goal, context, typename Movement::Distance(grid, goal), trace);
+                            return searchGridWith<Movement>(grid, start, goal, context, ZeroHeuristic(), trace); });
+}
+
+template <typename Trace = NullSearchTrace>
+SearchResult searchGrid(const Grid &grid, Algorithm algorithm, int start, int goal, SearchContext &context, Trace &&trace = Trace())
+{
+    return searchGrid(grid, algorithm, MovementModel::CornerCutting, start, goal, context, std::forward<Trace>(trace));
+}
+
+// Number of cells on the path ending at goal in the last search's tree
+inline int pathLength(const SearchContext &context, int goal)
+{
+    int length = 0;
+    for (int cell = goal; cell != -1; cell = context.prev[static_cast<std::size_t>(cell)])
+        ++length;
+    return length;
+}
+
+// Writes the path ending at goal into out[0, length) in start-to-goal order. out must hold pathLength() cells.
+template <typename CellId>
+void writePath(const SearchContext &context, int goal, CellId *out, int length)
+{
+    // Walk prev back from the goal, filling the buffer from its end
+    for (int cell = goal; cell != -1 && length > 0; cell = context.prev[static_cast<std::size_t>(cell)])
+        out[--length] = static_cast<CellId>(cell);
+}
+
+// Finds a shortest path from start to goal (cell ids) with Dijkstra or A* under the given movement model.
+// On success path holds the cell ids from start to goal inclusive.
+template <typename Trace = NullSearchTrace>
+SearchResult findPath(const Grid &grid, Algorithm algorithm, MovementModel movement, int start, int goal,
+                      std::vector<int> &path, SearchContext &context, Trace &&trace = Trace())
+{
+    SearchResult result = searchGrid(grid, algorithm, movement, start, goal, context, std::forward<Trace>(trace));
+    path.clear();
+    if (result.found)
+    {
+        path.resize(static_cast<std::size_t>(pathLength(context, goal)));
+        writePath(context, goal, path.data(), static_cast<int>(path.size()));
+    }
+    return result;
+}
+
+template <typename Trace = NullSearchTrace>
+SearchResult findPath(const Grid &grid, Algorithm algorithm, int start, int goal, std::vector<int> &path,
+                      SearchContext &context, Trace &&trace = Trace())
+{
+    return findPath(grid, algorithm, MovementModel::CornerCutting, start, goal, path, context, std::forward<Trace>(trace));
+}
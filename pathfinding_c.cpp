@@ -0,0 +1,287 @@
+// C ABI wrapper around the engine. No C++ exception or allocation crosses this boundary.
+#define PF_BUILDING_LIBRARY
+#include "pathfinding_c.h"
+
+#include <new>
+#include <thread>
+
+#include "pathfinding.hpp"
+#include "subgoals.hpp"
+
+struct pf_map
+{
+    Grid grid;
+    MovementModel movement = MovementModel::CornerCutting;
+    bool hasSubgoals = false;
+    SubgoalGraph subgoals; // Kept in step with grid and movement while hasSubgoals
+};
+
+// Search state is reused across calls made from the same thread
+static SearchContext &threadContext()
+{
+    thread_local SearchContext context;
+    return context;
+}
+
+static bool validAlgorithm(const pf_map &map, int algorithm)
+{
+    return algorithm == PF_DIJKSTRA || algorithm == PF_ASTAR || (algorithm == PF_SUBGOALS && map.hasSubgoals);
+}
+
+static unsigned buildThreads()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Applies one wall edit, repairing the subgoal graph if there is one
+static void setWall(pf_map &map, int x, int y, bool wall)
+{
+    if (map.grid.isWall(x, y) == wall)
+        return;
+    map.grid.setWall(x, y, wall);
+    if (map.hasSubgoals)
+        updateSubgoalGraph(map.grid, map.subgoals, x, y);
+}
+
+// Subgoal-graph version of answerQuery() for valid, free start and goal cells
+static int answerSubgoalQuery(const pf_map &map, uint32_t start, uint32_t goal, uint32_t *out, size_t capacity,
+                              pf_path_result &result)
+{
+    SearchContext &context = threadContext();
+    thread_local std::vector<int> path;
+    bool found = withMovement(map.movement, [&](auto policy)
+                              {
+                                  using Movement = decltype(policy);
+                                  SearchResult search = searchSubgoalGraph<Movement>(map.grid, map.subgoals, static_cast<int>(start),
+                                                                                     static_cast<int>(goal), context);
+                                  if (search.found)
+                                  {
+                                      result.cost = search.cost;
+                                      refineSubgoalPath<Movement>(map.grid, context, static_cast<int>(goal), path);
+                                  }
+                                  return search.found; });
+    if (!found)
+        return PF_OK;
+    result.found = 1;
+    result.length = static_cast<uint32_t>(path.size());
+    if (path.size() > capacity || out == nullptr)
+        return result.status = PF_ERR_BUFFER_TOO_SMALL;
+    std::copy(path.begin(), path.end(), out);
+    return PF_OK;
+}
+
+// Runs one query and writes its path into out[0, capacity)
+static int answerQuery(const pf_map &map, int algorithm, uint32_t start, uint32_t goal, uint32_t *out,
+                       size_t capacity, pf_path_result &result)
+{
+    result.found = 0;
+    result.cost = 0.0f;
+    result.length = 0;
+    const Grid &grid = map.grid;
+    const uint32_t cells = static_cast<uint32_t>(grid.cellCount());
+    if (start >= cells || goal >= cells)
+        return result.status = PF_ERR_OUT_OF_BOUNDS;
+    result.status = PF_OK;
+    if (grid.walls[start] || grid.walls[goal])
+        return PF_OK;
+
+    try
+    {
+        SearchContext &context = threadContext();
+        if (algorithm == PF_SUBGOALS)
+            return answerSubgoalQuery(map, start, goal, out, capacity, result);
+        SearchResult search = searchGrid(grid, static_cast<Algorithm>(algorithm), map.movement, static_cast<int>(start),
+                                         static_cast<int>(goal), context);
+        if (!search.found)
+            return PF_OK;
+        int length = pathLength(context, static_cast<int>(goal));
+        result.found = 1;
+        result.cost = search.cost;
+        result.length = static_cast<uint32_t>(length);
+        if (static_cast<size_t>(length) > capacity || out == nullptr)
+            return result.status = PF_ERR_BUFFER_TOO_SMALL;
+        writePath(context, static_cast<int>(goal), out, length);
+        return PF_OK;
+    }
+    catch (const std::bad_alloc &)
+    {
+        return result.status = PF_ERR_OUT_OF_MEMORY;
+    }
+}
+
+extern "C"
+{
+
+int pf_abi_version(void)
+{
+    return PF_ABI_VERSION;
+}
+
+pf_map *pf_map_create(uint32_t width, uint32_t height)
+{
+    if (width == 0 || height == 0 || static_cast<uint64_t>(width) * height > static_cast<uint64_t>(std::numeric_limits<int>::max()))
+        return nullptr;
+    pf_map *map = new (std::nothrow) pf_map;
+    if (!map)
+        return nullptr;
+    try
+    {
+        map->grid = Grid(static_cast<int>(width), static_cast<int>(height));
+    }
+    catch (const std::bad_alloc &)
+    {
+        delete map;
+        return nullptr;
+    }
+    return map;
+}
+
+pf_map *pf_map_load(const char *path)
+{
+    if (!path)
+        return nullptr;
+    pf_map *map = new (std::nothrow) pf_map;
+    if (!map)
+        return nullptr;
+    try
+    {
+        if (loadGridFile(path, map->grid))
+            return map;
+    }
+    catch (const std::exception &)
+    {
+    }
+    delete map;
+    return nullptr;
+}
+
+void pf_map_destroy(pf_map *map)
+{
+    delete map;
+}
+
+uint32_t pf_map_width(const pf_map *map)
+{
+    return map ? static_cast<uint32_t>(map->grid.width) : 0;
+}
+
+uint32_t pf_map_height(const pf_map *map)
+{
+    return map ? static_cast<uint32_t>(map->grid.height) : 0;
+}
+
+int pf_map_set_cell(pf_map *map, uint32_t x, uint32_t y, int wall)
+{
+    if (!map)
+        return PF_ERR_INVALID_ARGUMENT;
+    if (x >= static_cast<uint32_t>(map->grid.width) || y >= static_cast<uint32_t>(map->grid.height))
+        return PF_ERR_OUT_OF_BOUNDS;
+    try
+    {
+        setWall(*map, static_cast<int>(x), static_cast<int>(y), wall != 0);
+    }
+    catch (const std::bad_alloc &)
+    {
+        map->hasSubgoals = false;
+        return PF_ERR_OUT_OF_MEMORY;
+    }
+    catch (const std::exception &)
+    {
+        map->hasSubgoals = false;
+        return PF_ERR_INTERNAL;
+    }
+    return PF_OK;
+}
+
+int pf_map_set_movement(pf_map *map, int movement)
+{
+    if (!map || movement < PF_MOVE_CORNER_CUTTING || movement > PF_MOVE_4_CONNECTED)
+        return PF_ERR_INVALID_ARGUMENT;
+    map->movement = static_cast<MovementModel>(movement);
+    if (map->hasSubgoals && !map->subgoals.valid(map->grid, map->movement))
+        return pf_map_build_subgoals(map, map->subgoals.twoLevel ? 1 : 0);
+    return PF_OK;
+}
+
+int pf_map_build_subgoals(pf_map *map, int two_level)
+{
+    if (!map)
+        return PF_ERR_INVALID_ARGUMENT;
+    try
+    {
+        map->hasSubgoals = false;
+        map->subgoals = buildSubgoalGraph(map->grid, map->movement, two_level != 0, buildThreads());
+        map->hasSubgoals = true;
+    }
+    catch (const std::bad_alloc &)
+    {
+        return PF_ERR_OUT_OF_MEMORY;
+    }
+    catch (const std::exception &)
+    {
+        return PF_ERR_INTERNAL;
+    }
+    return PF_OK;
+}
+
+int pf_map_set_cells(pf_map *map, const uint32_t *cell_ids, const uint8_t *walls, size_t count)
+{
+    if (!map || (count > 0 && (!cell_ids || !walls)))
+        return PF_ERR_INVALID_ARGUMENT;
+    const uint32_t cells = static_cast<uint32_t>(map->grid.cellCount());
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (cell_ids[i] >= cells)
+            return PF_ERR_OUT_OF_BOUNDS;
+    }
+    try
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            int id = static_cast<int>(cell_ids[i]);
+            setWall(*map, id % map->grid.width, id / map->grid.width, walls[i] != 0);
+        }
+    }
+    catch (const std::bad_alloc &)
+    {
+        map->hasSubgoals = false;
+        return PF_ERR_OUT_OF_MEMORY;
+    }
+    catch (const std::exception &)
+    {
+        map->hasSubgoals = false;
+        return PF_ERR_INTERNAL;
+    }
+    return PF_OK;
+}
+
+int pf_find_path(const pf_map *map, int algorithm, uint32_t start, uint32_t goal,
+                 uint32_t *path, uint32_t capacity, pf_path_result *result)
+{
+    if (!map || !result || !validAlgorithm(*map, algorithm))
+        return PF_ERR_INVALID_ARGUMENT;
+    result->offset = 0;
+    return answerQuery(*map, algorithm, start, goal, path, path ? capacity : 0, *result);
+}
+
+int pf_find_paths(const pf_map *map, int algorithm, const pf_query *queries, size_t count,
+                  uint32_t *path_buffer, size_t buffer_capacity, pf_path_result *results)
+{
+    if (!map || !validAlgorithm(*map, algorithm) || (count > 0 && (!queries || !results)))
+        return PF_ERR_INVALID_ARGUMENT;
+    if (!path_buffer)
+        buffer_capacity = 0;
+    size_t used = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        pf_path_result &result = results[i];
+        result.offset = static_cast<uint64_t>(used);
+        answerQuery(*map, algorithm, queries[i].start, queries[i].goal,
+                    path_buffer ? path_buffer + used : nullptr, buffer_capacity - used, result);
+        if (result.status == PF_OK)
+            used += result.length;
+    }
+    return PF_OK;
+}
+
+} // extern "C"
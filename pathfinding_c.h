@@ -0,0 +1,110 @@
+/*
+ * Stable C ABI of the pathfinding engine (libpathfinding.so).
+ *
+ * Lets C, Rust, Python (ctypes/cffi) and other services call the engine in-process without
+ * linking SFML. Every result is written into caller-provided buffers, so no memory
+ * allocated by the library ever has to be freed by the caller; the only handle is pf_map.
+ *
+ * Cells are addressed by packed ids y * width + x. A map may be queried from several
+ * threads at once, but must not be modified while queries on it are running.
+ */
+#ifndef PATHFINDING_C_H
+#define PATHFINDING_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(PF_BUILDING_LIBRARY)
+#define PF_API __attribute__((visibility("default")))
+#else
+#define PF_API
+#endif
+
+/* Bumped whenever a declaration in this header changes incompatibly */
+#define PF_ABI_VERSION 2
+
+/* Return codes */
+#define PF_OK 0
+#define PF_ERR_INVALID_ARGUMENT -1
+#define PF_ERR_OUT_OF_BOUNDS -2
+#define PF_ERR_BUFFER_TOO_SMALL -3 /* Result length holds the number of cells needed */
+#define PF_ERR_IO -4
+#define PF_ERR_OUT_OF_MEMORY -5
+#define PF_ERR_INTERNAL -6 /* Any other failure, e.g. a build thread could not start */
+
+/* Search algorithms */
+#define PF_DIJKSTRA 0
+#define PF_ASTAR 1
+#define PF_SUBGOALS 2 /* Subgoal graph search; needs pf_map_build_subgoals() first */
+
+/* Movement models */
+#define PF_MOVE_CORNER_CUTTING 0    /* Diagonals allowed whenever the target cell is free (default) */
+#define PF_MOVE_NO_CORNER_CUTTING 1 /* Diagonals need both adjacent straight cells free */
+#define PF_MOVE_4_CONNECTED 2
+
+typedef struct pf_map pf_map;
+
+typedef struct pf_query
+{
+    uint32_t start;
+    uint32_t goal;
+} pf_query;
+
+typedef struct pf_path_result
+{
+    int32_t status;  /* PF_OK or an error code for this query */
+    uint32_t found;  /* 1 if a path exists */
+    float cost;      /* Geometric path cost (1 per straight move, sqrt(2) per diagonal) */
+    uint32_t length; /* Cells on the path, start and goal included */
+    uint64_t offset; /* First cell of this path in the caller's path buffer (64-bit since ABI 2) */
+} pf_path_result;
+
+PF_API int pf_abi_version(void);
+
+/* Creates an empty map (no walls); returns NULL on invalid size or allocation failure */
+PF_API pf_map *pf_map_create(uint32_t width, uint32_t height);
+
+/* Loads a text map ('#' = wall, one line per row); returns NULL on failure */
+PF_API pf_map *pf_map_load(const char *path);
+
+PF_API void pf_map_destroy(pf_map *map);
+
+PF_API uint32_t pf_map_width(const pf_map *map);
+PF_API uint32_t pf_map_height(const pf_map *map);
+
+PF_API int pf_map_set_cell(pf_map *map, uint32_t x, uint32_t y, int wall);
+
+/* Selects the movement model used by later queries on this map */
+PF_API int pf_map_set_movement(pf_map *map, int movement);
+
+/*
+ * Builds the map's subgoal graph (two_level != 0 for the two-level variant) for PF_SUBGOALS
+ * queries. Later cell edits repair it locally; changing the movement model rebuilds it. If a
+ * build or repair fails, the map keeps no subgoal graph until the next successful build.
+ */
+PF_API int pf_map_build_subgoals(pf_map *map, int two_level);
+
+/* Sets walls[i] (0 or 1) on cell_ids[i] for i < count */
+PF_API int pf_map_set_cells(pf_map *map, const uint32_t *cell_ids, const uint8_t *walls, size_t count);
+
+/* Finds one path and writes its cell ids into path[0, capacity) */
+PF_API int pf_find_path(const pf_map *map, int algorithm, uint32_t start, uint32_t goal,
+                        uint32_t *path, uint32_t capacity, pf_path_result *result);
+
+/*
+ * Answers count queries. Paths are written back to back into path_buffer and results[i]
+ * tells where path i starts. Queries whose path no longer fits get PF_ERR_BUFFER_TOO_SMALL;
+ * the call itself returns PF_OK unless its arguments are invalid.
+ */
+PF_API int pf_find_paths(const pf_map *map, int algorithm, const pf_query *queries, size_t count,
+                         uint32_t *path_buffer, size_t buffer_capacity, pf_path_result *results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PATHFINDING_C_H */
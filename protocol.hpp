@@ -0,0 +1,124 @@
+// Binary request/response protocol of the local query server (see server.cpp).
+// Both ends live on the same machine, so all fields are native-endian and fixed-width.
+//
+// Every message is a FrameHeader followed by `length` payload bytes. Replies carry the
+// request's id and type with REPLY_FLAG set, so clients can pipeline requests. Replies may
+// arrive out of order, but a LoadMap is ordered within its connection: frames sent before it
+// finish first and frames sent after it see the loaded map.
+//
+//   LoadMap request:     LoadMapHeader, then ceil(width * height / 8) bytes of wall bits
+//                        (row-major cell ids, least significant bit first). Empty reply.
+//   QueryBatch request:  QueryBatchHeader, then `count` QueryPair entries.
+//   QueryBatch reply:    u32 count, then per query a PathHeader followed by `length` u32 cell ids.
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "pathfinding.hpp"
+
+const char *const DEFAULT_SOCKET_PATH = "/tmp/pathfinding.sock";
+const std::uint32_t MAX_FRAME_PAYLOAD = 64u << 20; // Larger frames close the connection
+const std::uint8_t REPLY_FLAG = 0x80;
+
+enum class MessageType : std::uint8_t
+{
+    LoadMap = 1,
+    QueryBatch = 2
+};
+
+enum class ReplyStatus : std::uint8_t
+{
+    Ok = 0,
+    BadRequest = 1,
+    UnknownMap = 2
+};
+
+struct FrameHeader
+{
+    std::uint32_t length; // Payload bytes following this header
+    std::uint32_t requestId;
+    std::uint8_t type;
+    std::uint8_t status; // ReplyStatus in replies, 0 in requests
+    std::uint16_t reserved;
+};
+
+struct LoadMapHeader
+{
+    std::uint32_t mapId;
+    std::uint16_t width;
+    std::uint16_t height;
+};
+
+struct QueryBatchHeader
+{
+    std::uint32_t mapId;
+    std::uint8_t algorithm; // Algorithm enum value
+    std::uint8_t movement;  // MovementModel enum value
+    std::uint8_t reserved[2];
+    std::uint32_t count;
+};
+
+struct QueryPair
+{
+    std::uint32_t start; // Packed cell id y * width + x
+    std::uint32_t goal;
+};
+
+struct PathHeader
+{
+    std::uint8_t found;
+    std::uint8_t reserved[3];
+    float cost;
+    std::uint32_t length; // Number of cell ids that follow
+};
+
+static_assert(sizeof(FrameHeader) == 12, "FrameHeader must stay packed");
+static_assert(sizeof(LoadMapHeader) == 8, "LoadMapHeader must stay packed");
+static_assert(sizeof(QueryBatchHeader) == 12, "QueryBatchHeader must stay packed");
+static_assert(sizeof(QueryPair) == 8, "QueryPair must stay packed");
+static_assert(sizeof(PathHeader) == 12, "PathHeader must stay packed");
+
+template <typename T>
+void appendPod(std::vector<char> &buffer, const T &value)
+{
+    const char *bytes = reinterpret_cast<const char *>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+// Copies a T out of the buffer at offset and advances it; false if the buffer is too short
+template <typename T>
+bool readPod(const std::vector<char> &buffer, std::size_t &offset, T &value)
+{
+    if (buffer.size() < offset + sizeof(T))
+        return false;
+    std::memcpy(&value, buffer.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+inline std::size_t wallBitBytes(int width, int height)
+{
+    return (static_cast<std::size_t>(width) * static_cast<std::size_t>(height) + 7) / 8;
+}
+
+inline void appendWallBits(std::vector<char> &buffer, const Grid &grid)
+{
+    std::size_t begin = buffer.size();
+    buffer.resize(begin + wallBitBytes(grid.width, grid.height), 0);
+    for (int id = 0; id < grid.cellCount(); ++id)
+    {
+        if (grid.walls[static_cast<std::size_t>(id)])
+            buffer[begin + id / 8] = static_cast<char>(buffer[begin + id / 8] | (1 << (id % 8)));
+    }
+}
+
+inline void readWallBits(const char *bits, Grid &grid)
+{
+    for (int id = 0; id < grid.cellCount(); ++id)
+    {
+        grid.walls[static_cast<std::size_t>(id)] = (bits[id / 8] >> (id % 8)) & 1;
+    }
+    grid.rebuildNeighbors();
+}
@@ -0,0 +1,126 @@
+#include "rsr.hpp"
+
+#include "thread_pool.hpp"
+
+const int RSR_BAND_ROWS = 64;
+
+// Decomposes rows [top, bottom) into rectangles, numbering them from 0 in rectOf
+static void decomposeBand(const Grid &grid, int top, int bottom, std::vector<GridRect> &rects, std::vector<int> &rectOf)
+{
+    auto freeCell = [&](int x, int y)
+    { return !grid.isWall(x, y) && rectOf[static_cast<std::size_t>(grid.cellId(x, y))] < 0; };
+
+    for (int y = top; y < bottom; ++y)
+    {
+        for (int x = 0; x < grid.width; ++x)
+        {
+            if (!freeCell(x, y))
+                continue;
+            int width = 1;
+            while (x + width < grid.width && freeCell(x + width, y))
+                ++width;
+            int height = 1;
+            while (y + height < bottom)
+            {
+                bool rowFree = true;
+                for (int c = x; c < x + width && rowFree; ++c)
+                    rowFree = freeCell(c, y + height);
+                if (!rowFree)
+                    break;
+                ++height;
+            }
+            int id = static_cast<int>(rects.size());
+            rects.push_back({x, y, width, height});
+            for (int r = y; r < y + height; ++r)
+                std::fill(rectOf.begin() + grid.cellId(x, r), rectOf.begin() + grid.cellId(x, r) + width, id);
+        }
+    }
+}
+
+RectangleDecomposition decomposeRectangles(const Grid &grid, unsigned threads)
+{
+    RectangleDecomposition decomposition;
+    decomposition.width = grid.width;
+    decomposition.height = grid.height;
+    decomposition.rectOf.assign(static_cast<std::size_t>(grid.cellCount()), -1);
+
+    const int bands = (grid.height + RSR_BAND_ROWS - 1) / RSR_BAND_ROWS;
+    std::vector<std::vector<GridRect>> bandRects(static_cast<std::size_t>(bands));
+    {
+        ThreadPool pool(std::min(threads, static_cast<unsigned>(std::max(bands, 1))));
+        for (int band = 0; band < bands; ++band)
+        {
+            pool.submit([&, band]()
+                        { decomposeBand(grid, band * RSR_BAND_ROWS, std::min(grid.height, (band + 1) * RSR_BAND_ROWS),
+                                        bandRects[static_cast<std::size_t>(band)], decomposition.rectOf); });
+        }
+        pool.wait();
+    }
+
+    // Band-local ids become global ones
+    for (int band = 0; band < bands; ++band)
+    {
+        const int first = static_cast<int>(decomposition.rects.size());
+        const auto &rects = bandRects[static_cast<std::size_t>(band)];
+        decomposition.rects.insert(decomposition.rects.end(), rects.begin(), rects.end());
+        auto begin = decomposition.rectOf.begin() + static_cast<std::ptrdiff_t>(band) * RSR_BAND_ROWS * grid.width;
+        auto end = decomposition.rectOf.begin() + static_cast<std::ptrdiff_t>(std::min(grid.height, (band + 1) * RSR_BAND_ROWS)) * grid.width;
+        for (auto it = begin; it != end; ++it)
+        {
+            if (*it >= 0)
+                *it += first;
+        }
+    }
+
+    decomposition.flags.assign(static_cast<std::size_t>(grid.cellCount()), 0);
+    decomposition.innerMoves.assign(static_cast<std::size_t>(grid.cellCount()), 0);
+    for (int cell = 0; cell < grid.cellCount(); ++cell)
+    {
+        const int id = decomposition.rectOf[static_cast<std::size_t>(cell)];
+        if (id < 0)
+            continue;
+        const int x = cell % grid.width, y = cell / grid.width;
+        if (!decomposition.rects[static_cast<std::size_t>(id)].onPerimeter(x, y))
+        {
+            decomposition.flags[static_cast<std::size_t>(cell)] = RSR_INTERIOR;
+            continue;
+        }
+        // Any free neighbor counts, whatever the movement model: extra exits only cost pushes
+        const GridRect &rect = decomposition.rects[static_cast<std::size_t>(id)];
+        for (int d = 0; d < 8; ++d)
+        {
+            const int nx = x + directions[d].x, ny = y + directions[d].y;
+            if (!grid.inBounds(nx, ny) || grid.isWall(nx, ny))
+                continue;
+            if (decomposition.rectOf[static_cast<std::size_t>(grid.cellId(nx, ny))] != id)
+                decomposition.flags[static_cast<std::size_t>(cell)] = RSR_EXIT;
+            else if (!rect.onPerimeter(nx, ny))
+                decomposition.innerMoves[static_cast<std::size_t>(cell)] |= static_cast<std::uint8_t>(1u << d);
+        }
+    }
+    return decomposition;
+}
+
+void refineRsrPath(const SearchContext &context, int goal, int width, bool diagonal, std::vector<int> &path)
+{
+    std::vector<int> waypoints(static_cast<std::size_t>(pathLength(context, goal)));
+    writePath(context, goal, waypoints.data(), static_cast<int>(waypoints.size()));
+    path.clear();
+    if (waypoints.empty())
+        return;
+    path.push_back(waypoints[0]);
+    for (std::size_t i = 1; i < waypoints.size(); ++i)
+    {
+        int x = waypoints[i - 1] % width, y = waypoints[i - 1] / width;
+        const int tx = waypoints[i] % width, ty = waypoints[i] / width;
+        while (x != tx || y != ty)
+        {
+            int sx = (tx > x) - (tx < x), sy = (ty > y) - (ty < y);
+            if (!diagonal && sx != 0)
+                sy = 0;
+            x += sx;
+            y += sy;
+            path.push_back(y * width + x);
+        }
+    }
+}
@@ -0,0 +1,230 @@
+// Rectangular Symmetry Reduction (RSR) for open maps. Passable space is decomposed into empty
+// rectangles. The search then only visits rectangle perimeters: interiors are crossed by
+// macro-edges whose cost is the exact distance inside the (obstacle-free) rectangle, which
+// removes the many equal-cost orderings of moves A* would otherwise expand one by one.
+//
+// Successors of a perimeter cell p of rectangle R:
+//   - its ordinary grid moves, except into R's interior
+//   - every cell of the side opposite p's side that is at most one rectangle depth away
+//     sideways (the cells an optimal path crossing R from p can exit at)
+//   - the endpoint of each diagonal run from p through R (entry to an adjacent side)
+// Together with moves along the perimeter these reproduce every shortest path between two
+// perimeter cells, so RSR stays optimal. A start or goal inside a rectangle is connected to
+// that rectangle's perimeter for the one query.
+//
+// Crossing targets are further limited to the ends of each fan and to exit cells (perimeter
+// cells with a free neighbor in another rectangle): a path through any other perimeter cell
+// can only continue along the perimeter, and inside an empty rectangle the fan's end cell or
+// the direct macro-edge is never longer than that detour. Without this filter the extra heap
+// pushes cost more time than the saved expansions.
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "pathfinding.hpp"
+
+struct GridRect
+{
+    int x, y, width, height;
+
+    bool contains(int cx, int cy) const { return cx >= x && cx < x + width && cy >= y && cy < y + height; }
+    bool onPerimeter(int cx, int cy) const { return cx == x || cx == x + width - 1 || cy == y || cy == y + height - 1; }
+};
+
+// Per-cell flags of a RectangleDecomposition
+const std::uint8_t RSR_INTERIOR = 1; // Strictly inside its rectangle
+const std::uint8_t RSR_EXIT = 2;     // On the perimeter, next to a free cell of another rectangle
+
+struct RectangleDecomposition
+{
+    int width = 0, height = 0;
+    std::vector<GridRect> rects;
+    std::vector<int> rectOf;          // Rectangle id per cell, -1 for walls
+    std::vector<std::uint8_t> flags; // RSR_INTERIOR / RSR_EXIT per cell
+    std::vector<std::uint8_t> innerMoves; // Per perimeter cell, the directions into its rectangle's interior
+
+    bool valid(const Grid &grid) const { return width == grid.width && height == grid.height; }
+
+    // Cells strictly inside their rectangle; RSR never expands them
+    bool interior(int cell) const { return flags[static_cast<std::size_t>(cell)] & RSR_INTERIOR; }
+    bool exit(int cell) const { return flags[static_cast<std::size_t>(cell)] & RSR_EXIT; }
+};
+
+// Greedy maximal empty rectangles: every free cell not yet covered grows as far right as it can,
+// then as far down. The map is cut into bands of rows decomposed in parallel on threads workers;
+// rectangles never cross a band, so the result does not depend on the thread count.
+RectangleDecomposition decomposeRectangles(const Grid &grid, unsigned threads);
+
+// Distance between two cells of the same empty rectangle under a movement model
+template <typename Movement>
+float rectangleDistance(int dx, int dy)
+{
+    if (std::is_same<Movement, FourConnected>::value)
+        return static_cast<float>(std::abs(dx) + std::abs(dy));
+    return octileDistance(dx, dy);
+}
+
+// A* (with the movement model's distance heuristic) over rectangle perimeters, skipping steps
+// onto cells the pruning policy does not keep. Leaves a tree of macro steps in context;
+// refineRsrPath() expands it to cells.
+template <typename Movement, typename Pruning, typename Trace = NullSearchTrace>
+SearchResult searchRsrPruned(const Grid &grid, const RectangleDecomposition &decomposition, int start, int goal,
+                             SearchContext &context, const Pruning &pruning, Trace &&trace = Trace())
+{
+    const bool diagonal = !std::is_same<Movement, FourConnected>::value;
+    const int W = grid.width;
+    const std::array<int, 8> offsets = neighborOffsets(W);
+    const RelaxKernel relaxMoves = simdKernels.relax;
+    const typename Movement::Distance heuristic(grid, goal);
+    const int goalX = goal % W, goalY = goal / W;
+    const int goalRect = decomposition.rectOf[static_cast<std::size_t>(goal)];
+    const bool goalInside = decomposition.interior(goal);
+    SearchResult result;
+
+    context.begin(grid.cellCount());
+    context.set(start, 0.0f, -1);
+    context.push(heuristic.at(start), start);
+    trace.opened(start);
+
+    auto relax = [&](int from, int next, int x, int y, float cost)
+    {
+        if (!pruning.keeps(next))
+            return;
+        float ng = context.g[static_cast<std::size_t>(from)] + cost;
+        if (ng < context.cost(next))
+        {
+            context.set(next, ng, from);
+            context.push(ng + Movement::Distance::between(goalX - x, goalY - y), next);
+            trace.opened(next);
+        }
+    };
+
+    while (!context.open.empty())
+    {
+        int cell = openEntryCell(context.pop());
+        if (!context.close(cell))
+            continue;
+        ++result.expanded;
+        trace.visited(cell);
+        if (cell == goal)
+            break;
+
+        const int cx = cell % W, cy = cell / W;
+        const int id = decomposition.rectOf[static_cast<std::size_t>(cell)];
+        const GridRect &rect = decomposition.rects[static_cast<std::size_t>(id)];
+        auto macro = [&](int x, int y)
+        { relax(cell, grid.cellId(x, y), x, y, rectangleDistance<Movement>(x - cx, y - cy)); };
+        // Crossing targets that can be on a shortest path; see the header comment
+        auto crossing = [&](int x, int y)
+        {
+            const int next = grid.cellId(x, y);
+            if (next == goal || decomposition.exit(next))
+                macro(x, y);
+        };
+
+        if (goalInside && id == goalRect)
+            macro(goalX, goalY);
+
+        if (!rect.onPerimeter(cx, cy))
+        {
+            // Interior start: the rectangle's exits are reachable directly
+            for (int x = rect.x; x < rect.x + rect.width; ++x)
+            {
+                crossing(x, rect.y);
+                crossing(x, rect.y + rect.height - 1);
+            }
+            for (int y = rect.y + 1; y < rect.y + rect.height - 1; ++y)
+            {
+                crossing(rect.x, y);
+                crossing(rect.x + rect.width - 1, y);
+            }
+            continue;
+        }
+
+        // Ordinary moves, except into R's interior, through the grid engine's batched kernels
+        float candidates[8];
+        RelaxInput input{context.g.data(), context.stamp.data(), context.generation, cell, offsets.data(),
+                         Movement::moves(grid.neighborMask(cell)) & pruning.moves(cell) & ~unsigned(decomposition.innerMoves[static_cast<std::size_t>(cell)]),
+                         context.g[static_cast<std::size_t>(cell)]};
+        unsigned improved = relaxMoves(input, candidates);
+        if (improved != 0)
+        {
+            float h[8];
+            heuristic.successors(cell, cx, cy, improved, h);
+            for (; improved != 0; improved &= improved - 1)
+            {
+                const int d = __builtin_ctz(improved);
+                const int next = cell + offsets[static_cast<std::size_t>(d)];
+                context.set(next, candidates[d], cell);
+                context.push(candidates[d] + h[d], next);
+                trace.opened(next);
+            }
+        }
+        if (rect.width < 3 || rect.height < 3)
+            continue; // No interior to cross
+
+        // Crossings to the opposite side, within one rectangle depth sideways (straight only when 4-connected)
+        const int right = rect.x + rect.width - 1, bottom = rect.y + rect.height - 1;
+        auto crossRow = [&](int y)
+        {
+            int depth = diagonal ? std::abs(y - cy) : 0;
+            const int first = std::max(rect.x, cx - depth), last = std::min(right, cx + depth);
+            macro(first, y);
+            for (int x = first + 1; x < last; ++x)
+                crossing(x, y);
+            if (last != first)
+                macro(last, y);
+        };
+        auto crossColumn = [&](int x)
+        {
+            int depth = diagonal ? std::abs(x - cx) : 0;
+            const int first = std::max(rect.y, cy - depth), last = std::min(bottom, cy + depth);
+            macro(x, first);
+            for (int y = first + 1; y < last; ++y)
+                crossing(x, y);
+            if (last != first)
+                macro(x, last);
+        };
+        if (cy == rect.y)
+            crossRow(bottom);
+        if (cy == bottom)
+            crossRow(rect.y);
+        if (cx == rect.x)
+            crossColumn(right);
+        if (cx == right)
+            crossColumn(rect.x);
+
+        // Diagonal runs to the boundary
+        if (diagonal)
+        {
+            for (int d = 4; d < 8; ++d)
+            {
+                int sx = directions[static_cast<std::size_t>(d)].x, sy = directions[static_cast<std::size_t>(d)].y;
+                int run = std::min(sx > 0 ? right - cx : cx - rect.x, sy > 0 ? bottom - cy : cy - rect.y);
+                if (run >= 2)
+                    macro(cx + sx * run, cy + sy * run);
+            }
+        }
+    }
+
+    if (context.cost(goal) != std::numeric_limits<float>::max())
+    {
+        result.found = true;
+        result.cost = context.cost(goal);
+    }
+    return result;
+}
+
+// Unpruned RSR; see searchRsrPruned
+template <typename Movement = CornerCutting, typename Trace = NullSearchTrace>
+SearchResult searchRsr(const Grid &grid, const RectangleDecomposition &decomposition, int start, int goal,
+                       SearchContext &context, Trace &&trace = Trace())
+{
+    return searchRsrPruned<Movement>(grid, decomposition, start, goal, context, NoPruning(), std::forward<Trace>(trace));
+}
+
+// Expands the macro steps ending at goal into the cells they cross, start to goal inclusive.
+// Each macro step lies inside one empty rectangle, so diagonal-first walks stay on free cells.
+void refineRsrPath(const SearchContext &context, int goal, int width, bool diagonal, std::vector<int> &path);
@@ -0,0 +1,729 @@
+// Long-lived local query server. Keeps maps resident and answers batched path queries
+// from other processes over a Unix domain socket (protocol in protocol.hpp).
+// A single epoll loop owns all sockets; searches run on a worker pool.
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <csignal>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <deque>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "landmarks.hpp"
+#include "metrics.hpp"
+#include "pathfinding.hpp"
+#include "protocol.hpp"
+#include "shm_channel.hpp"
+#include "thread_pool.hpp"
+
+// A map and its preprocessing, immutable once stored
+struct ResidentMap
+{
+    Grid grid;
+    LandmarkSet landmarks; // Empty unless the server runs with --landmarks
+};
+
+// Maps stay resident for the lifetime of the server. Queries hold a shared_ptr,
+// so replacing a map never invalidates a search that is already running.
+class MapRegistry
+{
+public:
+    explicit MapRegistry(int landmarkCount) : landmarkCount(landmarkCount) {}
+
+    // Runs the configured preprocessing outside the lock, then publishes the map
+    void store(std::uint32_t mapId, Grid grid)
+    {
+        auto map = std::make_shared<ResidentMap>();
+        map->grid = std::move(grid);
+        if (landmarkCount > 0)
+        {
+            auto buildStart = std::chrono::steady_clock::now();
+            map->landmarks = buildLandmarks(map->grid, landmarkCount, std::max(1u, std::thread::hardware_concurrency()));
+            recordPreprocessing("landmarks", std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count());
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        maps[mapId] = std::move(map);
+    }
+
+    std::shared_ptr<const ResidentMap> find(std::uint32_t mapId) const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = maps.find(mapId);
+        return it == maps.end() ? nullptr : it->second;
+    }
+
+private:
+    const int landmarkCount;
+    mutable std::shared_mutex mutex;
+    std::unordered_map<std::uint32_t, std::shared_ptr<const ResidentMap>> maps;
+};
+
+// A* uses the map's landmark tables when it has them. Tables are built with corner cutting,
+// the least restrictive model, so their bounds stay admissible under every model.
+static SearchResult searchResidentMap(const ResidentMap &map, Algorithm algorithm, MovementModel movement, int start, int goal,
+                                      SearchContext &context)
+{
+    if (algorithm == Algorithm::AStar && !map.landmarks.empty())
+    {
+        return withMovement(movement, [&](auto policy)
+                            { return searchGridWith<decltype(policy)>(map.grid, start, goal, context,
+                                                                      LandmarkHeuristic(map.grid, map.landmarks, goal)); });
+    }
+    return searchGrid(map.grid, algorithm, movement, start, goal, context);
+}
+
+static bool validQuery(std::uint8_t algorithm, std::uint8_t movement)
+{
+    return algorithm <= static_cast<std::uint8_t>(Algorithm::AStar) &&
+           movement <= static_cast<std::uint8_t>(MovementModel::FourConnected);
+}
+
+// Complete request frame not yet handed to the worker pool
+struct PendingFrame
+{
+    FrameHeader header;
+    std::vector<char> payload;
+};
+
+struct Connection
+{
+    std::uint64_t id = 0; // epoll key
+    int fd = -1;
+    std::vector<char> in;
+    std::vector<char> out;
+    std::size_t outOffset = 0;         // Bytes of out already written
+    bool writeArmed = false;           // EPOLLOUT currently requested
+    std::deque<PendingFrame> pending;  // Frames held back behind a LoadMap
+    int inFlight = 0;                  // Frames in the pool whose replies are not delivered yet
+    bool loading = false;              // A LoadMap is in the pool; later frames wait for it
+};
+
+// Reply frame produced by a worker, handed back to the event loop through an eventfd
+struct Completion
+{
+    std::uint64_t connectionId;
+    std::vector<char> frame;
+    bool loadMap; // Ends the connection's LoadMap barrier
+};
+
+static std::uint64_t elapsedNanoseconds(std::chrono::steady_clock::time_point since)
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since).count());
+}
+
+static void beginReply(std::vector<char> &frame, const FrameHeader &request, ReplyStatus status)
+{
+    FrameHeader reply{0, request.requestId, static_cast<std::uint8_t>(request.type | REPLY_FLAG),
+                      static_cast<std::uint8_t>(status), 0};
+    frame.clear();
+    appendPod(frame, reply);
+}
+
+static void finishReply(std::vector<char> &frame)
+{
+    std::uint32_t length = static_cast<std::uint32_t>(frame.size() - sizeof(FrameHeader));
+    std::memcpy(frame.data(), &length, sizeof(length));
+}
+
+static void handleLoadMap(MapRegistry &registry, const FrameHeader &header, const std::vector<char> &payload,
+                          std::vector<char> &frame)
+{
+    std::size_t offset = 0;
+    LoadMapHeader load;
+    if (!readPod(payload, offset, load) || load.width == 0 || load.height == 0 ||
+        payload.size() - offset < wallBitBytes(load.width, load.height))
+    {
+        beginReply(frame, header, ReplyStatus::BadRequest);
+        return;
+    }
+    auto loadStart = std::chrono::steady_clock::now();
+    Grid grid(load.width, load.height);
+    readWallBits(payload.data() + offset, grid);
+    recordPreprocessing("map_load", std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count());
+    registry.store(load.mapId, std::move(grid));
+    beginReply(frame, header, ReplyStatus::Ok);
+}
+
+static void handleQueryBatch(MapRegistry &registry, const FrameHeader &header, const std::vector<char> &payload,
+                             std::vector<char> &frame)
+{
+    // Search state is reused across all queries served by this worker
+    thread_local SearchContext context;
+    thread_local std::vector<int> path;
+
+    std::size_t offset = 0;
+    QueryBatchHeader batch;
+    if (!readPod(payload, offset, batch) || !validQuery(batch.algorithm, batch.movement) ||
+        (payload.size() - offset) / sizeof(QueryPair) < batch.count)
+    {
+        beginReply(frame, header, ReplyStatus::BadRequest);
+        return;
+    }
+    std::shared_ptr<const ResidentMap> map = registry.find(batch.mapId);
+    if (!map)
+    {
+        beginReply(frame, header, ReplyStatus::UnknownMap);
+        return;
+    }
+
+    beginReply(frame, header, ReplyStatus::Ok);
+    appendPod(frame, batch.count);
+    const Grid &grid = map->grid;
+    const std::uint32_t cells = static_cast<std::uint32_t>(grid.cellCount());
+    for (std::uint32_t i = 0; i < batch.count; ++i)
+    {
+        QueryPair query;
+        readPod(payload, offset, query);
+        PathHeader result{};
+        path.clear();
+        if (query.start < cells && query.goal < cells && !grid.walls[query.start] && !grid.walls[query.goal])
+        {
+            auto searchStart = std::chrono::steady_clock::now();
+            SearchResult search = searchResidentMap(*map, static_cast<Algorithm>(batch.algorithm), static_cast<MovementModel>(batch.movement),
+                                                    static_cast<int>(query.start), static_cast<int>(query.goal), context);
+            recordQuery(static_cast<Algorithm>(batch.algorithm), elapsedNanoseconds(searchStart), search.expanded, search.found);
+            result.found = search.found ? 1 : 0;
+            result.cost = search.cost;
+            if (search.found)
+            {
+                path.resize(static_cast<std::size_t>(pathLength(context, static_cast<int>(query.goal))));
+                writePath(context, static_cast<int>(query.goal), path.data(), static_cast<int>(path.size()));
+            }
+        }
+        result.length = static_cast<std::uint32_t>(path.size());
+        appendPod(frame, result);
+        for (int cell : path)
+            appendPod(frame, static_cast<std::uint32_t>(cell));
+    }
+}
+
+// Answers one shared-memory query, writing the path straight into the slot. The query fields
+// are copied out once: the client can still write the slot, so nothing is re-read after the
+// checks.
+static void answerShmQuery(MapRegistry &registry, ShmSlot &slot, std::uint32_t pathCapacity, SearchContext &context)
+{
+    const std::uint32_t mapId = slot.mapId, start = slot.start, goal = slot.goal;
+    const std::uint8_t algorithm = slot.algorithm, movement = slot.movement;
+    slot.found = 0;
+    slot.cost = 0.0f;
+    slot.length = 0;
+    std::shared_ptr<const ResidentMap> map = registry.find(mapId);
+    if (!map)
+    {
+        slot.status = static_cast<std::uint8_t>(ShmStatus::UnknownMap);
+        return;
+    }
+    const std::uint32_t cells = static_cast<std::uint32_t>(map->grid.cellCount());
+    if (!validQuery(algorithm, movement) || start >= cells || goal >= cells)
+    {
+        slot.status = static_cast<std::uint8_t>(ShmStatus::BadRequest);
+        return;
+    }
+    slot.status = static_cast<std::uint8_t>(ShmStatus::Ok);
+    if (map->grid.walls[start] || map->grid.walls[goal])
+        return;
+
+    auto searchStart = std::chrono::steady_clock::now();
+    SearchResult search = searchResidentMap(*map, static_cast<Algorithm>(algorithm), static_cast<MovementModel>(movement),
+                                            static_cast<int>(start), static_cast<int>(goal), context);
+    recordQuery(static_cast<Algorithm>(algorithm), elapsedNanoseconds(searchStart), search.expanded, search.found);
+    if (!search.found)
+        return;
+    const int length = pathLength(context, static_cast<int>(goal));
+    slot.found = 1;
+    slot.cost = search.cost;
+    slot.length = static_cast<std::uint32_t>(length);
+    if (static_cast<std::uint32_t>(length) > pathCapacity)
+        slot.status = static_cast<std::uint8_t>(ShmStatus::PathTruncated);
+    else
+        writePath(context, static_cast<int>(goal), slot.cells(), length);
+}
+
+// SIGINT/SIGTERM are blocked in every thread and read from a signalfd, so shutdown
+// goes through the event loop instead of interrupting a worker
+static sigset_t shutdownSignals()
+{
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    return signals;
+}
+
+struct ServerOptions
+{
+    std::string socketPath = DEFAULT_SOCKET_PATH;
+    unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::pair<std::uint32_t, std::string>> maps; // Preloaded map id and file
+    std::string shmName;                                     // Shared-memory channel, disabled if empty
+    std::uint32_t shmSlots = 64;
+    std::uint32_t shmThreads = 1;
+    std::uint32_t shmPathCapacity = 16384;
+    int metricsPort = 0;     // Prometheus endpoint on 127.0.0.1, disabled if 0
+    std::string metricsFile; // Periodic metrics dump, disabled if empty
+    int metricsInterval = 10;
+    int landmarks = 0; // Landmark tables per map for A*, disabled if 0
+};
+
+class Server
+{
+public:
+    explicit Server(const ServerOptions &options) : options(options), registry(options.landmarks), pool(options.workers) {}
+
+    ~Server()
+    {
+        stopShm();
+        for (auto &entry : connections)
+            ::close(entry.second.fd);
+        for (int fd : {listenFd, wakeFd, signalFd, epollFd})
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+        if (listenFd >= 0)
+            ::unlink(options.socketPath.c_str());
+    }
+
+    bool start()
+    {
+        for (const auto &entry : options.maps)
+        {
+            auto loadStart = std::chrono::steady_clock::now();
+            Grid grid;
+            if (!loadGridFile(entry.second, grid))
+            {
+                std::cerr << "Failed to load map " << entry.second << "\n";
+                return false;
+            }
+            recordPreprocessing("map_load", std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count());
+            registry.store(entry.first, std::move(grid));
+            std::cerr << "Loaded map " << entry.first << " from " << entry.second << "\n";
+        }
+
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (options.socketPath.size() >= sizeof(address.sun_path))
+        {
+            std::cerr << "Socket path too long\n";
+            return false;
+        }
+        std::strcpy(address.sun_path, options.socketPath.c_str());
+        ::unlink(options.socketPath.c_str());
+
+        listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0 || ::bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+            ::listen(listenFd, SOMAXCONN) < 0)
+        {
+            std::perror("listen");
+            return false;
+        }
+
+        sigset_t signals = shutdownSignals();
+        signalFd = ::signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+        wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        if (signalFd < 0 || wakeFd < 0 || epollFd < 0)
+        {
+            std::perror("epoll setup");
+            return false;
+        }
+        watch(listenFd, EPOLLIN, LISTEN_KEY);
+        watch(wakeFd, EPOLLIN, WAKE_KEY);
+        watch(signalFd, EPOLLIN, SIGNAL_KEY);
+        std::cerr << "Listening on " << options.socketPath << " with " << options.workers << " workers\n";
+
+        if (options.metricsPort > 0)
+        {
+            if (!metricsServer.start(options.metricsPort))
+            {
+                std::perror("metrics endpoint");
+                return false;
+            }
+            std::cerr << "Metrics on http://127.0.0.1:" << options.metricsPort << "/metrics\n";
+        }
+        if (!options.metricsFile.empty())
+            metricsDumper.start(options.metricsFile, options.metricsInterval);
+
+        if (!options.shmName.empty())
+        {
+            if (!shmChannel.create(options.shmName, options.shmSlots, options.shmPathCapacity))
+            {
+                std::perror("shm_open");
+                return false;
+            }
+            for (std::uint32_t t = 0; t < options.shmThreads; ++t)
+                shmThreads.emplace_back([this, t]()
+                                        { serveShm(t, options.shmThreads); });
+            std::cerr << "Shared-memory channel " << options.shmName << ": " << options.shmSlots << " slots, "
+                      << options.shmThreads << " threads\n";
+        }
+        return true;
+    }
+
+    void run()
+    {
+        std::vector<epoll_event> events(64);
+        bool running = true;
+        while (running)
+        {
+            int ready = ::epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), -1);
+            if (ready < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                std::perror("epoll_wait");
+                break;
+            }
+            for (int i = 0; i < ready; ++i)
+            {
+                std::uint64_t key = events[i].data.u64;
+                if (key == LISTEN_KEY)
+                    acceptConnections();
+                else if (key == WAKE_KEY)
+                    deliverCompletions();
+                else if (key == SIGNAL_KEY)
+                    running = false;
+                else
+                    serviceConnection(key, events[i].events);
+            }
+        }
+        stopShm();
+        pool.wait();
+        std::cerr << "Shutting down\n";
+    }
+
+private:
+    static const std::uint64_t LISTEN_KEY = 0;
+    static const std::uint64_t WAKE_KEY = 1;
+    static const std::uint64_t SIGNAL_KEY = 2;
+
+    // Polls this thread's stripe of slots, sleeping on the submission futex when idle
+    void serveShm(std::uint32_t first, std::uint32_t stride)
+    {
+        SearchContext context;
+        ShmChannelHeader &header = shmChannel.header();
+        int idleSpins = 0;
+        while (!shmStopping.load(std::memory_order_relaxed))
+        {
+            std::uint32_t seen = header.submitted.load(std::memory_order_seq_cst);
+            bool worked = false;
+            for (std::uint32_t i = first; i < shmChannel.slotCount(); i += stride)
+            {
+                ShmSlot &slot = shmChannel.slot(i);
+                std::uint32_t expected = SlotSubmitted;
+                if (slot.state.load(std::memory_order_relaxed) != SlotSubmitted ||
+                    !slot.state.compare_exchange_strong(expected, SlotProcessing, std::memory_order_acquire))
+                    continue;
+                answerShmQuery(registry, slot, shmChannel.pathCapacity(), context);
+                shmChannel.complete(i);
+                worked = true;
+            }
+            if (worked)
+            {
+                idleSpins = 0;
+                continue;
+            }
+            if (++idleSpins < shmSpinLimit())
+            {
+                cpuRelax();
+                continue;
+            }
+            // Nothing submitted since the scan began: sleep until a client bumps the counter
+            header.serverSleepers.fetch_add(1, std::memory_order_seq_cst);
+            if (header.submitted.load(std::memory_order_seq_cst) == seen && !shmStopping.load())
+                futexWait(header.submitted, seen);
+            header.serverSleepers.fetch_sub(1, std::memory_order_seq_cst);
+            idleSpins = 0;
+        }
+    }
+
+    void stopShm()
+    {
+        if (shmThreads.empty())
+            return;
+        shmStopping = true;
+        shmChannel.header().submitted.fetch_add(1, std::memory_order_seq_cst);
+        futexWake(shmChannel.header().submitted, INT_MAX);
+        for (auto &thread : shmThreads)
+            thread.join();
+        shmThreads.clear();
+    }
+
+    void watch(int fd, std::uint32_t events, std::uint64_t key, int op = EPOLL_CTL_ADD)
+    {
+        epoll_event event{};
+        event.events = events;
+        event.data.u64 = key;
+        ::epoll_ctl(epollFd, op, fd, &event);
+    }
+
+    void acceptConnections()
+    {
+        while (true)
+        {
+            int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+                return; // EAGAIN: backlog drained
+            std::uint64_t id = nextConnectionId++;
+            connections[id].id = id;
+            connections[id].fd = fd;
+            watch(fd, EPOLLIN | EPOLLRDHUP, id);
+        }
+    }
+
+    void closeConnection(std::uint64_t id)
+    {
+        auto it = connections.find(id);
+        if (it == connections.end())
+            return;
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+        ::close(it->second.fd);
+        connections.erase(it);
+        // Replies still in flight for this id are dropped in deliverCompletions()
+    }
+
+    void serviceConnection(std::uint64_t id, std::uint32_t events)
+    {
+        auto it = connections.find(id);
+        if (it == connections.end())
+            return;
+        Connection &connection = it->second;
+        if (events & EPOLLOUT)
+        {
+            if (!flush(connection))
+            {
+                closeConnection(id);
+                return;
+            }
+        }
+        if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+        {
+            char buffer[64 * 1024];
+            while (true)
+            {
+                ssize_t n = ::read(connection.fd, buffer, sizeof(buffer));
+                if (n > 0)
+                {
+                    connection.in.insert(connection.in.end(), buffer, buffer + n);
+                    continue;
+                }
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                    break;
+                closeConnection(id); // EOF or error
+                return;
+            }
+            if (!dispatchFrames(id, connection))
+                closeConnection(id);
+        }
+    }
+
+    // Queues every complete frame in the input buffer and starts those that may run
+    bool dispatchFrames(std::uint64_t id, Connection &connection)
+    {
+        std::size_t offset = 0;
+        while (connection.in.size() - offset >= sizeof(FrameHeader))
+        {
+            FrameHeader header;
+            std::memcpy(&header, connection.in.data() + offset, sizeof(header));
+            if (header.length > MAX_FRAME_PAYLOAD)
+                return false;
+            if (connection.in.size() - offset - sizeof(FrameHeader) < header.length)
+                break; // Wait for the rest of the frame
+            auto begin = connection.in.begin() + static_cast<std::ptrdiff_t>(offset + sizeof(FrameHeader));
+            connection.pending.push_back({header, std::vector<char>(begin, begin + header.length)});
+            offset += sizeof(FrameHeader) + header.length;
+        }
+        connection.in.erase(connection.in.begin(), connection.in.begin() + static_cast<std::ptrdiff_t>(offset));
+        startFrames(id, connection);
+        return true;
+    }
+
+    // Hands queued frames to the worker pool. Queries run concurrently, but a LoadMap is a
+    // barrier within its connection: it starts once the frames before it have finished, and the
+    // frames after it wait for it, so a pipelined LoadMap and QueryBatch see the new map.
+    void startFrames(std::uint64_t id, Connection &connection)
+    {
+        while (!connection.pending.empty() && !connection.loading)
+        {
+            const bool loadMap = static_cast<MessageType>(connection.pending.front().header.type) == MessageType::LoadMap;
+            if (loadMap && connection.inFlight > 0)
+                break;
+            PendingFrame frame = std::move(connection.pending.front());
+            connection.pending.pop_front();
+            connection.loading = loadMap;
+            ++connection.inFlight;
+
+            pool.submit([this, id, loadMap, header = frame.header, payload = std::move(frame.payload)]()
+                        {
+                            Completion completion{id, {}, loadMap};
+                            switch (static_cast<MessageType>(header.type))
+                            {
+                            case MessageType::LoadMap:
+                                handleLoadMap(registry, header, payload, completion.frame);
+                                break;
+                            case MessageType::QueryBatch:
+                                handleQueryBatch(registry, header, payload, completion.frame);
+                                break;
+                            default:
+                                beginReply(completion.frame, header, ReplyStatus::BadRequest);
+                                break;
+                            }
+                            finishReply(completion.frame);
+                            {
+                                std::lock_guard<std::mutex> lock(completionMutex);
+                                completions.push_back(std::move(completion));
+                            }
+                            std::uint64_t one = 1;
+                            ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+                            (void)ignored; });
+        }
+    }
+
+    void deliverCompletions()
+    {
+        std::uint64_t count;
+        ssize_t ignored = ::read(wakeFd, &count, sizeof(count));
+        (void)ignored;
+        std::vector<Completion> ready;
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            ready.swap(completions);
+        }
+        for (auto &completion : ready)
+        {
+            auto it = connections.find(completion.connectionId);
+            if (it == connections.end())
+                continue; // Client went away
+            Connection &connection = it->second;
+            connection.out.insert(connection.out.end(), completion.frame.begin(), completion.frame.end());
+            --connection.inFlight;
+            if (completion.loadMap)
+                connection.loading = false;
+            startFrames(completion.connectionId, connection);
+            if (!flush(connection))
+                closeConnection(completion.connectionId);
+        }
+    }
+
+    // Writes as much pending output as the socket accepts; arms EPOLLOUT for the rest
+    bool flush(Connection &connection)
+    {
+        while (connection.outOffset < connection.out.size())
+        {
+            ssize_t n = ::send(connection.fd, connection.out.data() + connection.outOffset,
+                               connection.out.size() - connection.outOffset, MSG_NOSIGNAL);
+            if (n < 0)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    break;
+                return false;
+            }
+            connection.outOffset += static_cast<std::size_t>(n);
+        }
+        if (connection.outOffset == connection.out.size())
+        {
+            connection.out.clear();
+            connection.outOffset = 0;
+        }
+        bool wantWrite = !connection.out.empty();
+        if (wantWrite != connection.writeArmed)
+        {
+            watch(connection.fd, EPOLLIN | EPOLLRDHUP | (wantWrite ? EPOLLOUT : 0u), connection.id, EPOLL_CTL_MOD);
+            connection.writeArmed = wantWrite;
+        }
+        return true;
+    }
+
+    ServerOptions options;
+    MapRegistry registry;
+    int listenFd = -1, wakeFd = -1, signalFd = -1, epollFd = -1;
+    std::unordered_map<std::uint64_t, Connection> connections;
+    std::uint64_t nextConnectionId = 16; // Keys below this are reserved for listen/wake/signal
+    std::mutex completionMutex;
+    std::vector<Completion> completions;
+    ShmChannel shmChannel;
+    std::vector<std::thread> shmThreads;
+    std::atomic<bool> shmStopping{false};
+    MetricsHttpServer metricsServer;
+    MetricsFileDumper metricsDumper;
+    ThreadPool pool; // Declared last so workers are joined before the state they touch is destroyed
+};
+
+static void printUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " [--socket PATH] [--workers N] [--map ID=FILE]...\n"
+              << "       [--shm NAME [--shm-slots N] [--shm-threads N] [--shm-path-capacity N]]\n"
+              << "       [--metrics-port N] [--metrics-file PATH [--metrics-interval SECONDS]]\n"
+              << "       [--landmarks K]\n";
+}
+
+int main(int argc, char **argv)
+{
+    ServerOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--socket" && hasValue)
+            options.socketPath = argv[++i];
+        else if (arg == "--workers" && hasValue)
+            options.workers = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        else if (arg == "--shm" && hasValue)
+            options.shmName = argv[++i];
+        else if (arg == "--shm-slots" && hasValue)
+            options.shmSlots = static_cast<std::uint32_t>(std::max(1, std::atoi(argv[++i])));
+        else if (arg == "--shm-threads" && hasValue)
+            options.shmThreads = static_cast<std::uint32_t>(std::max(1, std::atoi(argv[++i])));
+        else if (arg == "--shm-path-capacity" && hasValue)
+            options.shmPathCapacity = static_cast<std::uint32_t>(std::max(1, std::atoi(argv[++i])));
+        else if (arg == "--metrics-port" && hasValue)
+            options.metricsPort = std::atoi(argv[++i]);
+        else if (arg == "--metrics-file" && hasValue)
+            options.metricsFile = argv[++i];
+        else if (arg == "--metrics-interval" && hasValue)
+            options.metricsInterval = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--landmarks" && hasValue)
+            options.landmarks = std::min(std::max(0, std::atoi(argv[++i])), MAX_LANDMARKS);
+        else if (arg == "--map" && hasValue)
+        {
+            std::string spec = argv[++i];
+            std::size_t eq = spec.find('=');
+            if (eq == std::string::npos)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            options.maps.emplace_back(static_cast<std::uint32_t>(std::stoul(spec.substr(0, eq))), spec.substr(eq + 1));
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    // Block before the worker pool starts so its threads inherit the mask
+    sigset_t signals = shutdownSignals();
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    Server server(options);
+    if (!server.start())
+        return 1;
+    server.run();
+    return 0;
+}
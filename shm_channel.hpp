@@ -0,0 +1,259 @@
+// Shared-memory query channel for callers on the same machine as the query server.
+// Queries and paths live in a shm_open() region: a client fills a slot, the server writes
+// the path back into the same slot, and futexes provide wakeups only when a side is asleep.
+// No socket syscalls and no copies are involved on the query path.
+//
+// Region layout: ShmChannelHeader, then slotCount slots of slotBytes each. A slot is a
+// ShmSlot followed by pathCapacity u32 cell ids. Slot states move
+//   Free -> Writing (client) -> Submitted (client) -> Processing (server) -> Done (server) -> Free (client)
+#pragma once
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+const std::uint32_t SHM_CHANNEL_MAGIC = 0x48534650; // "PFSH"
+const int SHM_SPIN_LIMIT = 2000;                    // Polls before a side goes to sleep on a futex
+
+enum ShmSlotState : std::uint32_t
+{
+    SlotFree = 0,
+    SlotWriting = 1,
+    SlotSubmitted = 2,
+    SlotProcessing = 3,
+    SlotDone = 4
+};
+
+enum class ShmStatus : std::uint8_t
+{
+    Ok = 0,
+    BadRequest = 1,
+    UnknownMap = 2,
+    PathTruncated = 3 // Path longer than pathCapacity; length holds the full size, no cells written
+};
+
+struct alignas(64) ShmChannelHeader
+{
+    std::uint32_t magic;
+    std::uint32_t slotCount;
+    std::uint32_t pathCapacity; // Cell ids that fit in each slot
+    std::uint32_t slotBytes;
+    alignas(64) std::atomic<std::uint32_t> submitted; // Futex word, bumped on every submission
+    std::atomic<std::uint32_t> serverSleepers;         // Server threads blocked on submitted
+};
+
+struct alignas(64) ShmSlot
+{
+    std::atomic<std::uint32_t> state;          // ShmSlotState, futex word for the client
+    std::atomic<std::uint32_t> clientSleeping; // Client blocked on state
+    // Query, written by the client
+    std::uint32_t mapId;
+    std::uint8_t algorithm;
+    std::uint8_t status; // ShmStatus, written by the server
+    std::uint8_t movement;
+    std::uint8_t reserved;
+    std::uint32_t start;
+    std::uint32_t goal;
+    // Result, written by the server
+    std::uint32_t found;
+    float cost;
+    std::uint32_t length;
+
+    std::uint32_t *cells() { return reinterpret_cast<std::uint32_t *>(this + 1); }
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "futex words must be plain 32-bit integers");
+
+inline void futexWait(std::atomic<std::uint32_t> &word, std::uint32_t expected)
+{
+    // Not FUTEX_PRIVATE: the word is shared between processes
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+}
+
+inline void futexWake(std::atomic<std::uint32_t> &word, int count)
+{
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&word), FUTEX_WAKE, count, nullptr, nullptr, 0);
+}
+
+// Spinning only pays off when the other side runs on another core; on one CPU it just delays it
+inline int shmSpinLimit()
+{
+    static const int limit = std::thread::hardware_concurrency() > 1 ? SHM_SPIN_LIMIT : 0;
+    return limit;
+}
+
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Mapping of a channel region. The server creates it, clients open it by name.
+class ShmChannel
+{
+public:
+    ShmChannel() = default;
+    ShmChannel(const ShmChannel &) = delete;
+    ShmChannel &operator=(const ShmChannel &) = delete;
+
+    ~ShmChannel()
+    {
+        if (base)
+            ::munmap(base, mappedBytes);
+        if (owner)
+            ::shm_unlink(name.c_str());
+    }
+
+    bool create(const std::string &channelName, std::uint32_t slotCount, std::uint32_t pathCapacity)
+    {
+        std::size_t slotBytes = (sizeof(ShmSlot) + pathCapacity * sizeof(std::uint32_t) + 63) / 64 * 64;
+        std::size_t bytes = sizeof(ShmChannelHeader) + slotCount * slotBytes;
+        ::shm_unlink(channelName.c_str());
+        int fd = ::shm_open(channelName.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+        if (fd < 0)
+            return false;
+        bool ok = ::ftruncate(fd, static_cast<off_t>(bytes)) == 0 && map(fd, bytes);
+        ::close(fd);
+        if (!ok)
+        {
+            ::shm_unlink(channelName.c_str());
+            return false;
+        }
+        name = channelName;
+        owner = true;
+        layoutSlotCount = slotCount;
+        layoutPathCapacity = pathCapacity;
+        layoutSlotBytes = slotBytes;
+        // ftruncate zero-fills, so every slot starts Free
+        ShmChannelHeader &h = header();
+        h.slotCount = slotCount;
+        h.pathCapacity = pathCapacity;
+        h.slotBytes = static_cast<std::uint32_t>(slotBytes);
+        std::atomic_thread_fence(std::memory_order_release);
+        h.magic = SHM_CHANNEL_MAGIC;
+        return true;
+    }
+
+    bool open(const std::string &channelName)
+    {
+        int fd = ::shm_open(channelName.c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        bool ok = ::fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= sizeof(ShmChannelHeader) &&
+                  map(fd, static_cast<std::size_t>(info.st_size));
+        ::close(fd);
+        if (!ok || header().magic != SHM_CHANNEL_MAGIC)
+            return false;
+        // Validated once; the header stays writable by every process mapping the channel
+        const std::uint32_t slotCount = header().slotCount, pathCapacity = header().pathCapacity;
+        const std::size_t slotBytes = header().slotBytes;
+        if (slotCount == 0 || slotBytes < sizeof(ShmSlot) + static_cast<std::size_t>(pathCapacity) * sizeof(std::uint32_t) ||
+            sizeof(ShmChannelHeader) + slotCount * slotBytes > mappedBytes)
+            return false;
+        layoutSlotCount = slotCount;
+        layoutPathCapacity = pathCapacity;
+        layoutSlotBytes = slotBytes;
+        name = channelName;
+        return true;
+    }
+
+    ShmChannelHeader &header() { return *static_cast<ShmChannelHeader *>(base); }
+
+    // Layout as created or validated on open. Never re-read from the header, which any process
+    // mapping the channel can overwrite.
+    std::uint32_t slotCount() const { return layoutSlotCount; }
+    std::uint32_t pathCapacity() const { return layoutPathCapacity; }
+
+    ShmSlot &slot(std::uint32_t index)
+    {
+        char *slots = static_cast<char *>(base) + sizeof(ShmChannelHeader);
+        return *reinterpret_cast<ShmSlot *>(slots + static_cast<std::size_t>(index) * layoutSlotBytes);
+    }
+
+    // Client side: claims a free slot for writing a query, starting the scan at hint
+    std::uint32_t acquire(std::uint32_t hint = 0)
+    {
+        const std::uint32_t count = layoutSlotCount;
+        for (std::uint32_t i = hint % count;; i = (i + 1) % count)
+        {
+            std::uint32_t expected = SlotFree;
+            if (slot(i).state.load(std::memory_order_relaxed) == SlotFree &&
+                slot(i).state.compare_exchange_strong(expected, SlotWriting, std::memory_order_acquire))
+                return i;
+            if (i + 1 == count)
+                std::this_thread::yield(); // Every slot busy: let the server catch up
+        }
+    }
+
+    // Client side: publishes a filled slot and wakes the server if it is asleep
+    void submit(std::uint32_t index)
+    {
+        slot(index).state.store(SlotSubmitted, std::memory_order_release);
+        header().submitted.fetch_add(1, std::memory_order_seq_cst);
+        if (header().serverSleepers.load(std::memory_order_seq_cst) > 0)
+            futexWake(header().submitted, INT_MAX);
+    }
+
+    // Client side: waits until the server has written the slot's result
+    void wait(std::uint32_t index)
+    {
+        ShmSlot &s = slot(index);
+        for (int spin = 0; spin < shmSpinLimit(); ++spin)
+        {
+            if (s.state.load(std::memory_order_acquire) == SlotDone)
+                return;
+            cpuRelax();
+        }
+        s.clientSleeping.store(1, std::memory_order_seq_cst);
+        std::uint32_t state;
+        while ((state = s.state.load(std::memory_order_seq_cst)) != SlotDone)
+            futexWait(s.state, state);
+        s.clientSleeping.store(0, std::memory_order_relaxed);
+    }
+
+    // Client side: hands a consumed slot back
+    void release(std::uint32_t index)
+    {
+        slot(index).state.store(SlotFree, std::memory_order_release);
+    }
+
+    // Server side: publishes a result and wakes the client if it is asleep
+    void complete(std::uint32_t index)
+    {
+        ShmSlot &s = slot(index);
+        s.state.store(SlotDone, std::memory_order_seq_cst);
+        if (s.clientSleeping.load(std::memory_order_seq_cst))
+            futexWake(s.state, 1);
+    }
+
+private:
+    bool map(int fd, std::size_t bytes)
+    {
+        void *address = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED)
+            return false;
+        base = address;
+        mappedBytes = bytes;
+        return true;
+    }
+
+    void *base = nullptr;
+    std::size_t mappedBytes = 0;
+    std::uint32_t layoutSlotCount = 0;
+    std::uint32_t layoutPathCapacity = 0;
+    std::size_t layoutSlotBytes = 0;
+    std::string name;
+    bool owner = false;
+};
@@ -0,0 +1,167 @@
+#include "simd_kernels.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PF_HAVE_AVX2_KERNELS 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define PF_HAVE_NEON_KERNELS 1
+#endif
+
+#if defined(PF_HAVE_AVX2_KERNELS)
+
+// Gathers the 8 neighbor costs, adds the step costs and compares in one pass.
+// Masked gathers skip impassable lanes, so out-of-grid neighbors are never loaded.
+__attribute__((target("avx2"))) static unsigned relaxAvx2(const RelaxInput &input, float *candidates)
+{
+    const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i passable = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(input.passable)), laneBits), laneBits);
+    const __m256i index = _mm256_add_epi32(_mm256_set1_epi32(input.cell),
+                                           _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input.offsets)));
+    const __m256 unreached = _mm256_set1_ps(std::numeric_limits<float>::max());
+
+    __m256 g = _mm256_mask_i32gather_ps(unreached, input.g, index, _mm256_castsi256_ps(passable), 4);
+    __m256i stamp = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), reinterpret_cast<const int *>(input.stamp), index, passable, 4);
+    __m256i fresh = _mm256_cmpeq_epi32(stamp, _mm256_set1_epi32(static_cast<int>(input.generation)));
+    g = _mm256_blendv_ps(unreached, g, _mm256_castsi256_ps(fresh));
+
+    __m256 candidate = _mm256_add_ps(_mm256_set1_ps(input.cost), _mm256_loadu_ps(DIRECTION_COSTS));
+    _mm256_storeu_ps(candidates, candidate);
+    __m256 better = _mm256_and_ps(_mm256_cmp_ps(candidate, g, _CMP_LT_OQ), _mm256_castsi256_ps(passable));
+    return static_cast<unsigned>(_mm256_movemask_ps(better));
+}
+
+__attribute__((target("avx2"))) static void octileAvx2(int x, int y, int goalX, int goalY, float *out)
+{
+    __m256i dx = _mm256_abs_epi32(_mm256_add_epi32(_mm256_set1_epi32(x - goalX), _mm256_loadu_si256(reinterpret_cast<const __m256i *>(DIRECTION_DX))));
+    __m256i dy = _mm256_abs_epi32(_mm256_add_epi32(_mm256_set1_epi32(y - goalY), _mm256_loadu_si256(reinterpret_cast<const __m256i *>(DIRECTION_DY))));
+    __m256i low = _mm256_min_epi32(dx, dy);
+    __m256i high = _mm256_max_epi32(dx, dy);
+    __m256 straight = _mm256_cvtepi32_ps(_mm256_sub_epi32(high, low));
+    __m256 diagonal = _mm256_mul_ps(_mm256_cvtepi32_ps(low), _mm256_set1_ps(DIRECTION_COSTS[4]));
+    _mm256_storeu_ps(out, _mm256_add_ps(straight, diagonal));
+}
+
+// One masked gather per landmark table covers all 8 neighbors
+__attribute__((target("avx2"))) static void landmarkAvx2(const LandmarkInput &input, unsigned mask, float *out)
+{
+    const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i lanes = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(mask)), laneBits), laneBits);
+    const __m256i index = _mm256_add_epi32(_mm256_set1_epi32(input.cell),
+                                           _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input.offsets)));
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    const __m256 initial = _mm256_loadu_ps(out);
+    __m256 bound = initial;
+    for (int k = 0; k < input.count; ++k)
+    {
+        __m256 distance = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), input.distances + k * input.stride, index,
+                                                   _mm256_castsi256_ps(lanes), 4);
+        __m256 difference = _mm256_sub_ps(_mm256_set1_ps(input.goalDistances[k]), distance);
+        bound = _mm256_max_ps(bound, _mm256_andnot_ps(signBit, difference));
+    }
+    _mm256_storeu_ps(out, _mm256_blendv_ps(initial, bound, _mm256_castsi256_ps(lanes)));
+}
+
+#endif
+
+#if defined(PF_HAVE_NEON_KERNELS)
+
+// NEON has no gather, so the neighbor costs are loaded per lane and compared four at a time
+static unsigned relaxNeon(const RelaxInput &input, float *candidates)
+{
+    float current[8];
+    for (int d = 0; d < 8; ++d)
+    {
+        int next = input.cell + input.offsets[d];
+        bool fresh = (input.passable & (1u << d)) && input.stamp[next] == input.generation;
+        current[d] = fresh ? input.g[next] : std::numeric_limits<float>::max();
+    }
+    const float32x4_t cost = vdupq_n_f32(input.cost);
+    const uint32x4_t laneBits = {1, 2, 4, 8};
+    float32x4_t low = vaddq_f32(cost, vld1q_f32(DIRECTION_COSTS));
+    float32x4_t high = vaddq_f32(cost, vld1q_f32(DIRECTION_COSTS + 4));
+    vst1q_f32(candidates, low);
+    vst1q_f32(candidates + 4, high);
+    unsigned lowBits = vaddvq_u32(vandq_u32(vcltq_f32(low, vld1q_f32(current)), laneBits));
+    unsigned highBits = vaddvq_u32(vandq_u32(vcltq_f32(high, vld1q_f32(current + 4)), laneBits));
+    return (lowBits | (highBits << 4)) & input.passable;
+}
+
+static void octileNeon(int x, int y, int goalX, int goalY, float *out)
+{
+    const float32x4_t diagonalCost = vdupq_n_f32(DIRECTION_COSTS[4]);
+    for (int half = 0; half < 8; half += 4)
+    {
+        int32x4_t dx = vabsq_s32(vaddq_s32(vdupq_n_s32(x - goalX), vld1q_s32(DIRECTION_DX + half)));
+        int32x4_t dy = vabsq_s32(vaddq_s32(vdupq_n_s32(y - goalY), vld1q_s32(DIRECTION_DY + half)));
+        int32x4_t low = vminq_s32(dx, dy);
+        float32x4_t straight = vcvtq_f32_s32(vsubq_s32(vmaxq_s32(dx, dy), low));
+        vst1q_f32(out + half, vaddq_f32(straight, vmulq_f32(vcvtq_f32_s32(low), diagonalCost)));
+    }
+}
+
+// Lanes outside the mask read the expanded cell itself, which is always in range
+static void landmarkNeon(const LandmarkInput &input, unsigned mask, float *out)
+{
+    std::size_t index[8];
+    for (int d = 0; d < 8; ++d)
+        index[d] = static_cast<std::size_t>(input.cell + ((mask & (1u << d)) ? input.offsets[d] : 0));
+    float32x4_t low = vld1q_f32(out), high = vld1q_f32(out + 4);
+    for (int k = 0; k < input.count; ++k)
+    {
+        const float *table = input.distances + k * input.stride;
+        float distance[8];
+        for (int d = 0; d < 8; ++d)
+            distance[d] = table[index[d]];
+        float32x4_t goal = vdupq_n_f32(input.goalDistances[k]);
+        low = vmaxq_f32(low, vabdq_f32(goal, vld1q_f32(distance)));
+        high = vmaxq_f32(high, vabdq_f32(goal, vld1q_f32(distance + 4)));
+    }
+    float bound[8];
+    vst1q_f32(bound, low);
+    vst1q_f32(bound + 4, high);
+    for (int d = 0; d < 8; ++d)
+    {
+        if (mask & (1u << d))
+            out[d] = bound[d];
+    }
+}
+
+#endif
+
+static bool forceScalar()
+{
+    const char *value = std::getenv("PATHFINDING_SIMD");
+    return value && std::strcmp(value, "scalar") == 0;
+}
+
+static const char *selectedKernel()
+{
+    if (forceScalar())
+        return "scalar";
+#if defined(PF_HAVE_AVX2_KERNELS)
+    if (__builtin_cpu_supports("avx2"))
+        return "avx2";
+#elif defined(PF_HAVE_NEON_KERNELS)
+    return "neon";
+#endif
+    return "scalar";
+}
+
+static KernelTable selectKernels()
+{
+    const char *name = selectedKernel();
+#if defined(PF_HAVE_AVX2_KERNELS)
+    if (std::strcmp(name, "avx2") == 0)
+        return {relaxAvx2, octileAvx2, landmarkAvx2, name};
+#elif defined(PF_HAVE_NEON_KERNELS)
+    if (std::strcmp(name, "neon") == 0)
+        return {relaxNeon, octileNeon, landmarkNeon, name};
+#endif
+    return {relaxScalar, octileScalar, landmarkScalar, name};
+}
+
+const KernelTable simdKernels = selectKernels();
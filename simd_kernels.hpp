@@ -0,0 +1,104 @@
+// Vectorized kernels for the search's expansion loop, selected once at startup by CPU
+// dispatch: AVX2 on x86-64 when available, NEON on AArch64, portable scalar code otherwise.
+// Setting PATHFINDING_SIMD=scalar forces the portable kernels (for benchmarking and checks).
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+// Step cost per entry of `directions`: four straight moves, then four diagonals
+const float DIRECTION_COSTS[8] = {1.0f, 1.0f, 1.0f, 1.0f, 1.41421356f, 1.41421356f, 1.41421356f, 1.41421356f};
+const int DIRECTION_DX[8] = {1, 0, -1, 0, 1, -1, 1, -1};
+const int DIRECTION_DY[8] = {0, 1, 0, -1, 1, 1, -1, -1};
+
+// Everything the relaxation of one expanded cell needs
+struct RelaxInput
+{
+    const float *g;               // Search cost per cell
+    const std::uint32_t *stamp;   // g is valid only where stamp == generation
+    std::uint32_t generation;
+    int cell;                     // Expanded cell id
+    const int *offsets;           // Cell id delta of each of the 8 directions
+    unsigned passable;            // Bit d set if the neighbor in direction d may be entered
+    float cost;                   // g of the expanded cell
+};
+
+// Writes cost + DIRECTION_COSTS[d] to candidates[d] for all 8 directions and returns the bitmask
+// of directions whose neighbor is passable and would improve (candidate < current g).
+// Neighbors outside the passable mask are never read.
+using RelaxKernel = unsigned (*)(const RelaxInput &input, float *candidates);
+
+// Writes the octile distance from each of the 8 neighbors of (x, y) to the goal into out
+using OctileKernel = void (*)(int x, int y, int goalX, int goalY, float *out);
+
+// Landmark distance tables for one query
+struct LandmarkInput
+{
+    const float *distances;      // count tables of `stride` floats, landmark-major
+    std::size_t stride;
+    int count;
+    const float *goalDistances;  // Distance from each landmark to the goal
+    int cell;
+    const int *offsets;
+};
+
+// Raises out[d] to max over landmarks k of |goalDistances[k] - table_k[neighbor d]| for every
+// direction in mask (the triangle-inequality bound). Tables of other directions are not read.
+using LandmarkKernel = void (*)(const LandmarkInput &input, unsigned mask, float *out);
+
+inline unsigned relaxScalar(const RelaxInput &input, float *candidates)
+{
+    unsigned improved = 0;
+    for (int d = 0; d < 8; ++d)
+    {
+        candidates[d] = input.cost + DIRECTION_COSTS[d];
+        if (input.passable & (1u << d))
+        {
+            int next = input.cell + input.offsets[d];
+            float current = input.stamp[next] == input.generation ? input.g[next] : std::numeric_limits<float>::max();
+            improved |= static_cast<unsigned>(candidates[d] < current) << d;
+        }
+    }
+    return improved;
+}
+
+// Octile distance for a displacement of (dx, dy) cells
+inline float octileDistance(int dx, int dy)
+{
+    int low = std::min(std::abs(dx), std::abs(dy));
+    int high = std::max(std::abs(dx), std::abs(dy));
+    return static_cast<float>(high - low) + static_cast<float>(low) * DIRECTION_COSTS[4];
+}
+
+inline void octileScalar(int x, int y, int goalX, int goalY, float *out)
+{
+    for (int d = 0; d < 8; ++d)
+        out[d] = octileDistance(x + DIRECTION_DX[d] - goalX, y + DIRECTION_DY[d] - goalY);
+}
+
+inline void landmarkScalar(const LandmarkInput &input, unsigned mask, float *out)
+{
+    for (; mask != 0; mask &= mask - 1)
+    {
+        int d = __builtin_ctz(mask);
+        std::size_t next = static_cast<std::size_t>(input.cell + input.offsets[d]);
+        float bound = out[d];
+        for (int k = 0; k < input.count; ++k)
+            bound = std::max(bound, std::abs(input.goalDistances[k] - input.distances[k * input.stride + next]));
+        out[d] = bound;
+    }
+}
+
+// Kernels chosen for this CPU
+struct KernelTable
+{
+    RelaxKernel relax;
+    OctileKernel octile;
+    LandmarkKernel landmark;
+    const char *name;
+};
+
+extern const KernelTable simdKernels;
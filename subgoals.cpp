@@ -0,0 +1,380 @@
+#include "subgoals.hpp"
+
+#include "thread_pool.hpp"
+
+static bool freeCell(const Grid &grid, int x, int y)
+{
+    return grid.inBounds(x, y) && !grid.isWall(x, y);
+}
+
+static bool wallCell(const Grid &grid, int x, int y)
+{
+    return grid.inBounds(x, y) && grid.isWall(x, y);
+}
+
+// Free cells where optimal paths may have to turn. Without corner cutting these are the convex
+// corners of obstacles: a diagonal neighbor is a wall while both cells beside it are free. With
+// corner cutting a wall only blocks its own cell, so paths turn in front of the end of a wall run:
+// at a free cell beside a wall whose neighbor across the run is free on at least one side.
+template <typename Movement>
+static bool isSubgoalCell(const Grid &grid, int x, int y)
+{
+    if (!freeCell(grid, x, y))
+        return false;
+    if (std::is_same<Movement, CornerCutting>::value)
+    {
+        for (int d = 0; d < 4; ++d)
+        {
+            const int wx = x + directions[static_cast<std::size_t>(d)].x, wy = y + directions[static_cast<std::size_t>(d)].y;
+            const int px = directions[static_cast<std::size_t>(d)].y, py = directions[static_cast<std::size_t>(d)].x;
+            if (wallCell(grid, wx, wy) && (freeCell(grid, wx + px, wy + py) || freeCell(grid, wx - px, wy - py)))
+                return true;
+        }
+        return false;
+    }
+    for (int d = 4; d < 8; ++d)
+    {
+        const int dx = directions[static_cast<std::size_t>(d)].x, dy = directions[static_cast<std::size_t>(d)].y;
+        if (wallCell(grid, x + dx, y + dy) && freeCell(grid, x + dx, y) && freeCell(grid, x, y + dy))
+            return true;
+    }
+    return false;
+}
+
+// Links subgoal s to every subgoal it reaches without passing another one
+template <typename Movement>
+static void connectSubgoal(const Grid &grid, SubgoalGraph &graph, int s)
+{
+    const int origin = graph.cells[static_cast<std::size_t>(s)];
+    const int ox = origin % grid.width, oy = origin / grid.width;
+    std::vector<SubgoalEdge> &edges = graph.edges[static_cast<std::size_t>(s)];
+    CellBox box{ox, oy, ox, oy};
+    edges.clear();
+    scanHReachable<Movement>(grid, origin, [&](int cell)
+                             {
+                                 const int x = cell % grid.width, y = cell / grid.width;
+                                 box.include(x, y);
+                                 const int t = graph.subgoalOf[static_cast<std::size_t>(cell)];
+                                 if (t < 0)
+                                     return true;
+                                 if (std::none_of(edges.begin(), edges.end(), [t](const SubgoalEdge &edge) { return edge.to == t; }))
+                                     edges.push_back({t, rectangleDistance<Movement>(x - ox, y - oy)});
+                                 return false; });
+    graph.explored[static_cast<std::size_t>(s)] = box;
+}
+
+// Bounded Dijkstra over the subgoal graph used by the two-level pass
+struct LevelSearch
+{
+    std::vector<float> distance;
+    std::vector<std::uint32_t> stamp;  // Search in which distance was set
+    std::vector<std::uint32_t> target; // Set to the excluded subgoal + 1 for its neighbors
+    std::vector<std::pair<float, int>> open;
+    std::uint32_t generation = 0;
+
+    explicit LevelSearch(std::size_t count) : distance(count, 0.0f), stamp(count, 0), target(count, 0) {}
+
+    bool reached(int s) const { return stamp[static_cast<std::size_t>(s)] == generation; }
+
+    // Costs from p of paths whose inner subgoals are global and not excluded, up to limit. Global
+    // subgoals are passed through; marked neighbors of excluded are only reached, and the search
+    // ends once the targets of them are settled.
+    void run(const SubgoalGraph &graph, int p, int excluded, float limit, int targets)
+    {
+        auto greater = std::greater<std::pair<float, int>>();
+        const std::uint32_t mark = static_cast<std::uint32_t>(excluded) + 1;
+        ++generation;
+        distance[static_cast<std::size_t>(p)] = 0.0f;
+        stamp[static_cast<std::size_t>(p)] = generation;
+        open.assign(1, {0.0f, p});
+        while (!open.empty())
+        {
+            std::pop_heap(open.begin(), open.end(), greater);
+            const auto [g, s] = open.back();
+            open.pop_back();
+            if (g > distance[static_cast<std::size_t>(s)])
+                continue;
+            if (s != p && target[static_cast<std::size_t>(s)] == mark && --targets == 0)
+                return;
+            if (s != p && !graph.global[static_cast<std::size_t>(s)])
+                continue;
+            for (const auto *list : {&graph.edges[static_cast<std::size_t>(s)], &graph.shortcuts[static_cast<std::size_t>(s)]})
+            {
+                for (const SubgoalEdge &edge : *list)
+                {
+                    const std::size_t t = static_cast<std::size_t>(edge.to);
+                    const float ng = g + edge.cost;
+                    if (edge.to == excluded || graph.cells[t] < 0 || ng > limit || (!graph.global[t] && target[t] != mark))
+                        continue;
+                    if (stamp[t] != generation || ng < distance[t])
+                    {
+                        stamp[t] = generation;
+                        distance[t] = ng;
+                        open.push_back({ng, edge.to});
+                        std::push_heap(open.begin(), open.end(), greater);
+                    }
+                }
+            }
+        }
+    }
+};
+
+// Makes subgoal s local when each pair of its neighbors (local ones included) stays connected as
+// cheaply through global subgoals other than it, adding a direct edge for pairs that are
+// h-reachable but would otherwise only connect through it. Taken in any order over the graph,
+// every two subgoals stay connected optimally by a path whose inner subgoals are all global,
+// which queries rely on.
+template <typename Movement>
+static void tryMakeLocal(const Grid &grid, SubgoalGraph &graph, LevelSearch &search, std::size_t s)
+{
+    const float epsilon = 1e-4f;
+    const int W = grid.width;
+    if (graph.edges[s].size() > static_cast<std::size_t>(MAX_LOCAL_SUBGOAL_DEGREE))
+        return; // Scanned edges lead to distinct subgoals already
+    std::vector<SubgoalEdge> neighbors, added; // added packs a neighbor pair (i, j) into to
+    for (const auto *list : {&graph.edges[s], &graph.shortcuts[s]})
+    {
+        for (const SubgoalEdge &edge : *list)
+        {
+            if (graph.cells[static_cast<std::size_t>(edge.to)] >= 0 &&
+                std::none_of(neighbors.begin(), neighbors.end(), [&](const SubgoalEdge &n) { return n.to == edge.to; }))
+                neighbors.push_back(edge);
+        }
+    }
+    if (neighbors.size() > static_cast<std::size_t>(MAX_LOCAL_SUBGOAL_DEGREE))
+        return;
+
+    float farthest = 0.0f;
+    for (const SubgoalEdge &neighbor : neighbors)
+    {
+        search.target[static_cast<std::size_t>(neighbor.to)] = static_cast<std::uint32_t>(s) + 1;
+        farthest = std::max(farthest, neighbor.cost);
+    }
+    added.clear();
+    for (std::size_t i = 0; i + 1 < neighbors.size(); ++i)
+    {
+        const int p = neighbors[i].to;
+        search.run(graph, p, static_cast<int>(s), neighbors[i].cost + farthest + epsilon, static_cast<int>(neighbors.size()) - 1);
+        for (std::size_t j = i + 1; j < neighbors.size(); ++j)
+        {
+            const int q = neighbors[j].to;
+            const float through = neighbors[i].cost + neighbors[j].cost;
+            if (search.reached(q) && search.distance[static_cast<std::size_t>(q)] <= through + epsilon)
+                continue;
+            const int pc = graph.cells[static_cast<std::size_t>(p)], qc = graph.cells[static_cast<std::size_t>(q)];
+            const float direct = rectangleDistance<Movement>(qc % W - pc % W, qc / W - pc / W);
+            if (direct <= through + epsilon && hReachablePath<Movement>(grid, pc, qc, nullptr))
+                added.push_back({static_cast<int>(i) * MAX_LOCAL_SUBGOAL_DEGREE + static_cast<int>(j), direct});
+            else
+                return;
+        }
+    }
+    graph.global[s] = 0;
+    // Every path the check relied on starts at a neighbor and costs at most twice the farthest
+    // neighbor, and each cost is at least the Chebyshev distance it covers
+    graph.localReach[s] = 3.0f * farthest + epsilon;
+    for (const SubgoalEdge &pair : added)
+    {
+        const int p = neighbors[static_cast<std::size_t>(pair.to / MAX_LOCAL_SUBGOAL_DEGREE)].to;
+        const int q = neighbors[static_cast<std::size_t>(pair.to % MAX_LOCAL_SUBGOAL_DEGREE)].to;
+        graph.shortcuts[static_cast<std::size_t>(p)].push_back({q, pair.cost, static_cast<int>(s)});
+        graph.shortcuts[static_cast<std::size_t>(q)].push_back({p, pair.cost, static_cast<int>(s)});
+    }
+}
+
+template <typename Movement>
+static void makeTwoLevel(const Grid &grid, SubgoalGraph &graph)
+{
+    const std::size_t count = graph.cells.size();
+    graph.global.assign(count, 1);
+    graph.localReach.assign(count, 0.0f);
+    for (auto &list : graph.shortcuts)
+        list.clear();
+    LevelSearch search(count);
+    for (std::size_t s = 0; s < count; ++s)
+    {
+        if (graph.cells[s] >= 0)
+            tryMakeLocal<Movement>(grid, graph, search, s);
+    }
+}
+
+// Redoes the two-level pass around an edit at (x, y). changed holds the subgoals whose edges
+// were rescanned or that appeared or vanished. A local subgoal stays local if its check looked
+// nowhere near the edit: the edges and shortcuts it relied on lie within its reach and only
+// change within two cells of an edit. The changed subgoals and the ones losing their check are
+// made global with the shortcuts they added, then tried again in index order.
+template <typename Movement>
+static void repairTwoLevel(const Grid &grid, SubgoalGraph &graph, int x, int y, const std::vector<int> &changed)
+{
+    const std::size_t count = graph.cells.size();
+    std::vector<std::uint8_t> retry(count, 0);
+    for (int s : changed)
+        retry[static_cast<std::size_t>(s)] = 1;
+    for (std::size_t s = 0; s < count; ++s)
+    {
+        const int cell = graph.cells[s];
+        if (cell >= 0 && !graph.global[s] &&
+            static_cast<float>(std::max(std::abs(cell % grid.width - x), std::abs(cell / grid.width - y))) <= graph.localReach[s] + 2.0f)
+            retry[s] = 1;
+    }
+
+    // Shortcuts to a vanished subgoal take the local subgoal that added them along
+    for (std::size_t s = 0; s < count; ++s)
+    {
+        for (const SubgoalEdge &edge : graph.shortcuts[s])
+        {
+            if (graph.cells[s] < 0 || graph.cells[static_cast<std::size_t>(edge.to)] < 0)
+                retry[static_cast<std::size_t>(edge.via)] = 1;
+        }
+    }
+    for (std::size_t s = 0; s < count; ++s)
+    {
+        auto &list = graph.shortcuts[s];
+        list.erase(std::remove_if(list.begin(), list.end(), [&](const SubgoalEdge &edge)
+                                  { return retry[static_cast<std::size_t>(edge.via)] != 0; }),
+                   list.end());
+    }
+
+    LevelSearch search(count);
+    for (std::size_t s = 0; s < count; ++s)
+    {
+        if (!retry[s])
+            continue;
+        graph.global[s] = 1;
+        graph.localReach[s] = 0.0f;
+    }
+    for (std::size_t s = 0; s < count; ++s)
+    {
+        if (retry[s] && graph.cells[s] >= 0)
+            tryMakeLocal<Movement>(grid, graph, search, s);
+    }
+}
+
+template <typename Movement>
+static SubgoalGraph buildWith(const Grid &grid, MovementModel movement, bool twoLevel, unsigned threads)
+{
+    SubgoalGraph graph;
+    graph.movement = movement;
+    graph.twoLevel = twoLevel;
+    graph.width = grid.width;
+    graph.height = grid.height;
+    graph.subgoalOf.assign(static_cast<std::size_t>(grid.cellCount()), -1);
+    for (int y = 0; y < grid.height; ++y)
+    {
+        for (int x = 0; x < grid.width; ++x)
+        {
+            if (!isSubgoalCell<Movement>(grid, x, y))
+                continue;
+            graph.subgoalOf[static_cast<std::size_t>(grid.cellId(x, y))] = static_cast<int>(graph.cells.size());
+            graph.cells.push_back(grid.cellId(x, y));
+        }
+    }
+    const int count = static_cast<int>(graph.cells.size());
+    graph.edges.resize(static_cast<std::size_t>(count));
+    graph.shortcuts.resize(static_cast<std::size_t>(count));
+    graph.global.assign(static_cast<std::size_t>(count), 1);
+    graph.localReach.assign(static_cast<std::size_t>(count), 0.0f);
+    graph.explored.resize(static_cast<std::size_t>(count));
+
+    // Each worker scans a contiguous block of subgoals and writes only their slots
+    {
+        const int blocks = std::max(1, std::min(count, static_cast<int>(threads) * 4));
+        ThreadPool pool(std::max(1u, threads));
+        for (int block = 0; block < blocks; ++block)
+        {
+            pool.submit([&, block]()
+                        {
+                            for (int s = count * block / blocks; s < count * (block + 1) / blocks; ++s)
+                                connectSubgoal<Movement>(grid, graph, s); });
+        }
+        pool.wait();
+    }
+    if (twoLevel)
+        makeTwoLevel<Movement>(grid, graph);
+    return graph;
+}
+
+SubgoalGraph buildSubgoalGraph(const Grid &grid, MovementModel movement, bool twoLevel, unsigned threads)
+{
+    return withMovement(movement, [&](auto policy)
+                        { return buildWith<decltype(policy)>(grid, movement, twoLevel, threads); });
+}
+
+template <typename Movement>
+static void updateWith(const Grid &grid, SubgoalGraph &graph, int x, int y)
+{
+    // Subgoal status depends on cells at most one step away. Slots freed here are only reused by
+    // later updates, after the repair has dropped every reference to them.
+    std::vector<int> rescan, removed;
+    for (int cy = y - 1; cy <= y + 1; ++cy)
+    {
+        for (int cx = x - 1; cx <= x + 1; ++cx)
+        {
+            if (!grid.inBounds(cx, cy))
+                continue;
+            const int cell = grid.cellId(cx, cy);
+            int &s = graph.subgoalOf[static_cast<std::size_t>(cell)];
+            const bool subgoal = isSubgoalCell<Movement>(grid, cx, cy);
+            if (subgoal && s < 0)
+            {
+                if (graph.freeSlots.empty())
+                {
+                    s = static_cast<int>(graph.cells.size());
+                    graph.cells.push_back(cell);
+                    graph.edges.emplace_back();
+                    graph.shortcuts.emplace_back();
+                    graph.global.push_back(1);
+                    graph.localReach.push_back(0.0f);
+                    graph.explored.push_back({cx, cy, cx, cy});
+                }
+                else
+                {
+                    s = graph.freeSlots.back();
+                    graph.freeSlots.pop_back();
+                    graph.cells[static_cast<std::size_t>(s)] = cell;
+                    graph.global[static_cast<std::size_t>(s)] = 1;
+                    graph.localReach[static_cast<std::size_t>(s)] = 0.0f;
+                    graph.explored[static_cast<std::size_t>(s)] = {cx, cy, cx, cy};
+                }
+                rescan.push_back(s);
+            }
+            else if (!subgoal && s >= 0)
+            {
+                graph.cells[static_cast<std::size_t>(s)] = -1;
+                graph.edges[static_cast<std::size_t>(s)].clear();
+                graph.explored[static_cast<std::size_t>(s)] = {cx, cy, cx, cy};
+                removed.push_back(s);
+                s = -1;
+            }
+        }
+    }
+
+    // A scan can only change if it reached a cell next to the edit: the edited cell itself,
+    // the cells whose moves depend on it and the subgoals that appeared or vanished
+    for (int s = 0; s < static_cast<int>(graph.cells.size()); ++s)
+    {
+        if (graph.cells[static_cast<std::size_t>(s)] >= 0 && graph.explored[static_cast<std::size_t>(s)].near(x, y, 2) &&
+            std::find(rescan.begin(), rescan.end(), s) == rescan.end())
+            rescan.push_back(s);
+    }
+    for (int s : rescan)
+        connectSubgoal<Movement>(grid, graph, s);
+    if (graph.twoLevel)
+    {
+        std::vector<int> changed(rescan);
+        changed.insert(changed.end(), removed.begin(), removed.end());
+        repairTwoLevel<Movement>(grid, graph, x, y, changed);
+    }
+    for (int s : removed)
+    {
+        graph.shortcuts[static_cast<std::size_t>(s)].clear();
+        graph.global[static_cast<std::size_t>(s)] = 1;
+        graph.freeSlots.push_back(s);
+    }
+}
+
+void updateSubgoalGraph(const Grid &grid, SubgoalGraph &graph, int x, int y)
+{
+    withMovement(graph.movement, [&](auto policy)
+                 { updateWith<decltype(policy)>(grid, graph, x, y); });
+}
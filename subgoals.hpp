@@ -0,0 +1,331 @@
+// Subgoal graphs: exact shortest grid paths from a small graph of obstacle corners.
+// Optimal paths only need to turn at subgoals (free cells at convex obstacle corners; under
+// corner cutting, the free cells in front of the ends of wall runs). Two cells are h-reachable when a path
+// as short as the movement model's distance heuristic connects them, which a scan over the two
+// move types of each cone decides. The graph links each subgoal to the subgoals it reaches
+// this way without passing another, and a query links start and goal in the same way, searches
+// the graph and refines each edge back to grid cells.
+//
+// The two-level variant makes a subgoal local when every pair of its neighbors is connected as
+// cheaply through the remaining global subgoals, adding a direct edge where needed. Queries only
+// search global subgoals plus the local ones linked to their start or goal.
+#pragma once
+
+#include <vector>
+
+#include "pathfinding.hpp"
+#include "rsr.hpp"
+
+// Direction pairs whose moves make up every optimal path into one cone around a cell
+const int DIAGONAL_CONES[8][2] = {{0, 4}, {1, 4}, {2, 5}, {1, 5}, {0, 6}, {3, 6}, {2, 7}, {3, 7}};
+const int QUADRANT_CONES[4][2] = {{0, 1}, {2, 1}, {0, 3}, {2, 3}};
+
+// Most neighbors a subgoal may have for the two-level pass to try making it local
+const int MAX_LOCAL_SUBGOAL_DEGREE = 16;
+
+struct SubgoalEdge
+{
+    int to; // Subgoal index
+    float cost;
+    int via = -1; // Shortcuts only: the local subgoal whose two-level pass added the edge
+};
+
+// Inclusive cell bounds
+struct CellBox
+{
+    int x0, y0, x1, y1;
+
+    void include(int x, int y)
+    {
+        x0 = std::min(x0, x);
+        y0 = std::min(y0, y);
+        x1 = std::max(x1, x);
+        y1 = std::max(y1, y);
+    }
+    bool near(int x, int y, int margin) const { return x >= x0 - margin && x <= x1 + margin && y >= y0 - margin && y <= y1 + margin; }
+};
+
+struct SubgoalGraph
+{
+    MovementModel movement = MovementModel::CornerCutting;
+    bool twoLevel = false;
+    int width = 0, height = 0;
+    std::vector<int> subgoalOf;                      // Subgoal index per cell, -1 if none
+    std::vector<int> cells;                          // Cell per subgoal, -1 for slots freed by updates
+    std::vector<std::vector<SubgoalEdge>> edges;     // To the subgoals each one reaches directly
+    std::vector<std::vector<SubgoalEdge>> shortcuts; // Added by the two-level pass around local subgoals
+    std::vector<std::uint8_t> global;                // 0 for subgoals the two-level pass made local
+    std::vector<CellBox> explored;                   // Cells each subgoal's edge scan reached
+    std::vector<float> localReach;                   // Per local subgoal, the distance its locality check looked
+    std::vector<int> freeSlots;                      // Indices of removed subgoals, reused by later updates
+
+    bool valid(const Grid &grid, MovementModel model) const { return width == grid.width && height == grid.height && movement == model; }
+
+    int subgoalCount() const { return static_cast<int>(std::count_if(cells.begin(), cells.end(), [](int cell) { return cell >= 0; })); }
+    int globalCount() const
+    {
+        int count = 0;
+        for (std::size_t s = 0; s < cells.size(); ++s)
+            count += cells[s] >= 0 && global[s] ? 1 : 0;
+        return count;
+    }
+};
+
+// Finds subgoals and their edges on threads workers; twoLevel also runs the two-level pass
+SubgoalGraph buildSubgoalGraph(const Grid &grid, MovementModel movement, bool twoLevel, unsigned threads);
+
+// Repairs the graph after the wall at (x, y) changed (grid already updated): subgoals around the
+// cell are re-derived and only subgoals whose earlier scans came near it are rescanned. The
+// two-level pass is redone only for the rescanned subgoals and for local subgoals whose
+// locality check looked as far as the edit.
+void updateSubgoalGraph(const Grid &grid, SubgoalGraph &graph, int x, int y);
+
+// Calls visit(cell) on every cell h-reachable from origin, cone by cone (cells on a cone's
+// border are visited twice). A false return marks the cell as a stop that the scan does not
+// continue through.
+template <typename Movement, typename Visit>
+void scanHReachable(const Grid &grid, int origin, Visit &&visit)
+{
+    enum : std::uint8_t
+    {
+        Unreached,
+        Open,
+        Stop
+    };
+    const bool diagonal = !std::is_same<Movement, FourConnected>::value;
+    const int(*cones)[2] = diagonal ? DIAGONAL_CONES : QUADRANT_CONES;
+    const int coneCount = diagonal ? 8 : 4;
+    const std::array<int, 8> offsets = neighborOffsets(grid.width);
+    const int ox = origin % grid.width, oy = origin / grid.width;
+    thread_local std::vector<std::uint8_t> previous, row;
+
+    for (int c = 0; c < coneCount; ++c)
+    {
+        const int a = cones[c][0], b = cones[c][1];
+        const GridOffset stepA = directions[static_cast<std::size_t>(a)], stepB = directions[static_cast<std::size_t>(b)];
+        previous.clear();
+        for (int j = 0;; ++j)
+        {
+            row.clear();
+            bool open = false;
+            for (int i = 0;; ++i)
+            {
+                const int x = ox + i * stepA.x + j * stepB.x, y = oy + i * stepA.y + j * stepB.y;
+                if (!grid.inBounds(x, y))
+                    break;
+                const int cell = grid.cellId(x, y);
+                const bool fromA = i > 0 && row[static_cast<std::size_t>(i) - 1] == Open &&
+                                   ((Movement::moves(grid.neighborMask(cell - offsets[static_cast<std::size_t>(a)])) >> a) & 1u);
+                const bool fromB = i < static_cast<int>(previous.size()) && previous[static_cast<std::size_t>(i)] == Open &&
+                                   ((Movement::moves(grid.neighborMask(cell - offsets[static_cast<std::size_t>(b)])) >> b) & 1u);
+                std::uint8_t state = Open;
+                if (i > 0 || j > 0)
+                {
+                    if (!fromA && !fromB)
+                    {
+                        if (i >= static_cast<int>(previous.size()))
+                            break; // Nothing further along this row can be reached
+                        state = Unreached;
+                    }
+                    else
+                    {
+                        state = visit(cell) ? Open : Stop;
+                    }
+                }
+                row.push_back(state);
+                open = open || state == Open;
+            }
+            if (!open)
+                break;
+            previous.swap(row);
+        }
+    }
+}
+
+// Whether to is h-reachable from from; appends the cells of one such path (to included,
+// from excluded) to path if given
+template <typename Movement>
+bool hReachablePath(const Grid &grid, int from, int to, std::vector<int> *path)
+{
+    const int W = grid.width;
+    const int dx = to % W - from % W, dy = to / W - from / W;
+    const int sx = (dx > 0) - (dx < 0), sy = (dy > 0) - (dy < 0);
+    const bool diagonal = !std::is_same<Movement, FourConnected>::value;
+
+    // Moves of type a (count na) and b (count nb) in any order reach to
+    int a, b, na, nb;
+    auto directionOf = [](int x, int y)
+    {
+        for (int d = 0; d < 8; ++d)
+        {
+            if (directions[static_cast<std::size_t>(d)].x == x && directions[static_cast<std::size_t>(d)].y == y)
+                return d;
+        }
+        return 0;
+    };
+    if (diagonal)
+    {
+        const bool alongX = std::abs(dx) >= std::abs(dy);
+        a = alongX ? directionOf(sx == 0 ? 1 : sx, 0) : directionOf(0, sy);
+        b = directionOf(sx == 0 ? 1 : sx, sy == 0 ? 1 : sy);
+        nb = std::min(std::abs(dx), std::abs(dy));
+        na = std::max(std::abs(dx), std::abs(dy)) - nb;
+    }
+    else
+    {
+        a = directionOf(sx == 0 ? 1 : sx, 0);
+        b = directionOf(0, sy == 0 ? 1 : sy);
+        na = std::abs(dx);
+        nb = std::abs(dy);
+    }
+
+    const std::array<int, 8> offsets = neighborOffsets(W);
+    const int columns = na + 1;
+    thread_local std::vector<std::uint8_t> reached;
+    reached.assign(static_cast<std::size_t>(columns) * static_cast<std::size_t>(nb + 1), 0);
+    reached[0] = 1;
+    for (int j = 0; j <= nb; ++j)
+    {
+        for (int i = 0; i <= na; ++i)
+        {
+            if (i == 0 && j == 0)
+                continue;
+            const int cell = from + i * offsets[static_cast<std::size_t>(a)] + j * offsets[static_cast<std::size_t>(b)];
+            const bool fromA = i > 0 && reached[static_cast<std::size_t>(j * columns + i - 1)] &&
+                               ((Movement::moves(grid.neighborMask(cell - offsets[static_cast<std::size_t>(a)])) >> a) & 1u);
+            const bool fromB = j > 0 && reached[static_cast<std::size_t>((j - 1) * columns + i)] &&
+                               ((Movement::moves(grid.neighborMask(cell - offsets[static_cast<std::size_t>(b)])) >> b) & 1u);
+            reached[static_cast<std::size_t>(j * columns + i)] = fromA || fromB;
+        }
+    }
+    if (!reached.back())
+        return false;
+    if (path)
+    {
+        // Walk back from to, then append in forward order
+        const std::size_t first = path->size();
+        for (int i = na, j = nb; i > 0 || j > 0;)
+        {
+            path->push_back(from + i * offsets[static_cast<std::size_t>(a)] + j * offsets[static_cast<std::size_t>(b)]);
+            const int cell = path->back();
+            if (i > 0 && reached[static_cast<std::size_t>(j * columns + i - 1)] &&
+                ((Movement::moves(grid.neighborMask(cell - offsets[static_cast<std::size_t>(a)])) >> a) & 1u))
+                --i;
+            else
+                --j;
+        }
+        std::reverse(path->begin() + static_cast<std::ptrdiff_t>(first), path->end());
+    }
+    return true;
+}
+
+// A* over the subgoal graph with start and goal linked in for this query, skipping subgoals the
+// pruning policy does not keep. The search tree in context holds subgoal-level steps;
+// refineSubgoalPath() expands it to cells.
+template <typename Movement, typename Pruning, typename Trace = NullSearchTrace>
+SearchResult searchSubgoalGraphPruned(const Grid &grid, const SubgoalGraph &graph, int start, int goal, SearchContext &context,
+                                      const Pruning &pruning, Trace &&trace = Trace())
+{
+    const int W = grid.width;
+    const int goalX = goal % W, goalY = goal / W;
+    auto distance = [&](int from, int to) { return rectangleDistance<Movement>(to % W - from % W, to / W - from / W); };
+    SearchResult result;
+
+    // Subgoals (and the goal) the start reaches directly, and subgoals that reach the goal directly
+    std::vector<int> startLinks, goalLinks;
+    scanHReachable<Movement>(grid, start, [&](int cell)
+                             {
+                                 if (cell != goal && graph.subgoalOf[static_cast<std::size_t>(cell)] < 0)
+                                     return true;
+                                 startLinks.push_back(cell);
+                                 return false; });
+    scanHReachable<Movement>(grid, goal, [&](int cell)
+                             {
+                                 if (graph.subgoalOf[static_cast<std::size_t>(cell)] < 0)
+                                     return true;
+                                 goalLinks.push_back(cell);
+                                 return false; });
+    std::sort(startLinks.begin(), startLinks.end());
+    startLinks.erase(std::unique(startLinks.begin(), startLinks.end()), startLinks.end());
+    std::sort(goalLinks.begin(), goalLinks.end());
+    goalLinks.erase(std::unique(goalLinks.begin(), goalLinks.end()), goalLinks.end());
+    auto linked = [&](int cell)
+    { return std::binary_search(startLinks.begin(), startLinks.end(), cell) || std::binary_search(goalLinks.begin(), goalLinks.end(), cell); };
+
+    context.begin(grid.cellCount());
+    context.set(start, 0.0f, -1);
+    context.push(distance(start, goal), start);
+    trace.opened(start);
+
+    auto relax = [&](int from, int next, float cost)
+    {
+        if (!pruning.keeps(next))
+            return;
+        float ng = context.g[static_cast<std::size_t>(from)] + cost;
+        if (ng < context.cost(next))
+        {
+            context.set(next, ng, from);
+            context.push(ng + rectangleDistance<Movement>(goalX - next % W, goalY - next / W), next);
+            trace.opened(next);
+        }
+    };
+
+    while (!context.open.empty())
+    {
+        int cell = openEntryCell(context.pop());
+        if (!context.close(cell))
+            continue;
+        ++result.expanded;
+        trace.visited(cell);
+        if (cell == goal)
+            break;
+
+        if (cell == start)
+        {
+            for (int next : startLinks)
+                relax(cell, next, distance(cell, next));
+            continue;
+        }
+        if (std::binary_search(goalLinks.begin(), goalLinks.end(), cell))
+            relax(cell, goal, distance(cell, goal));
+        const int s = graph.subgoalOf[static_cast<std::size_t>(cell)];
+        for (const auto *list : {&graph.edges[static_cast<std::size_t>(s)], &graph.shortcuts[static_cast<std::size_t>(s)]})
+        {
+            for (const SubgoalEdge &edge : *list)
+            {
+                const int next = graph.cells[static_cast<std::size_t>(edge.to)];
+                if (next >= 0 && (graph.global[static_cast<std::size_t>(edge.to)] || linked(next)))
+                    relax(cell, next, edge.cost);
+            }
+        }
+    }
+
+    if (context.cost(goal) != std::numeric_limits<float>::max())
+    {
+        result.found = true;
+        result.cost = context.cost(goal);
+    }
+    return result;
+}
+
+// Unpruned subgoal graph search; see searchSubgoalGraphPruned
+template <typename Movement = CornerCutting, typename Trace = NullSearchTrace>
+SearchResult searchSubgoalGraph(const Grid &grid, const SubgoalGraph &graph, int start, int goal, SearchContext &context,
+                                Trace &&trace = Trace())
+{
+    return searchSubgoalGraphPruned<Movement>(grid, graph, start, goal, context, NoPruning(), std::forward<Trace>(trace));
+}
+
+// Expands the subgoal-level steps ending at goal into grid cells, start to goal inclusive
+template <typename Movement>
+void refineSubgoalPath(const Grid &grid, const SearchContext &context, int goal, std::vector<int> &path)
+{
+    std::vector<int> waypoints(static_cast<std::size_t>(pathLength(context, goal)));
+    writePath(context, goal, waypoints.data(), static_cast<int>(waypoints.size()));
+    path.clear();
+    if (waypoints.empty())
+        return;
+    path.push_back(waypoints[0]);
+    for (std::size_t i = 1; i < waypoints.size(); ++i)
+        hReachablePath<Movement>(grid, waypoints[i - 1], waypoints[i], &path);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Small fixed-size worker pool used to keep slow work (PNG encoding, queries) off latency-sensitive threads
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned threadCount)
+    {
+        if (threadCount == 0)
+            threadCount = 1;
+        for (unsigned i = 0; i < threadCount; ++i)
+        {
+            workers.emplace_back([this]()
+                                 { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeWorkers.notify_all();
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void submit(std::function<void()> job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push(std::move(job));
+            ++pending;
+        }
+        wakeWorkers.notify_one();
+    }
+
+    // Blocks until every submitted job has finished
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        allDone.wait(lock, [this]()
+                     { return pending == 0; });
+    }
+
+private:
+    void workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeWorkers.wait(lock, [this]()
+                                 { return stopping || !jobs.empty(); });
+                if (jobs.empty())
+                    return; // Stopping and nothing left to do
+                job = std::move(jobs.front());
+                jobs.pop();
+            }
+            job();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--pending == 0)
+                    allDone.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable allDone;
+    std::size_t pending = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,30 @@
+#include "time_costs.hpp"
+
+int TimeCosts::addSchedule(float period, std::vector<ScheduleStep> scheduleSteps)
+{
+    if (scheduleSteps.empty() || !(period > 0.0f) || schedules.size() > 0xFFFFu)
+        return 0;
+    for (ScheduleStep &step : scheduleSteps)
+    {
+        step.begin = std::fmod(std::max(0.0f, step.begin), period);
+        step.factor = std::max(1.0f, step.factor);
+    }
+    std::sort(scheduleSteps.begin(), scheduleSteps.end(), [](const ScheduleStep &a, const ScheduleStep &b)
+              { return a.begin < b.begin; });
+    if (scheduleSteps.front().begin > 0.0f)
+        scheduleSteps.insert(scheduleSteps.begin(), ScheduleStep{0.0f, scheduleSteps.back().factor});
+
+    schedules.push_back({period, static_cast<std::uint32_t>(steps.size()), static_cast<std::uint32_t>(scheduleSteps.size())});
+    steps.insert(steps.end(), scheduleSteps.begin(), scheduleSteps.end());
+    return static_cast<int>(schedules.size()) - 1;
+}
+
+bool TimeCosts::assign(int cell, int schedule)
+{
+    if (schedule < 0 || static_cast<std::size_t>(schedule) >= schedules.size())
+        return false;
+    std::uint16_t &current = scheduleOf[static_cast<std::size_t>(cell)];
+    timedCells += (schedule != 0) - (current != 0);
+    current = static_cast<std::uint16_t>(schedule);
+    return true;
+}
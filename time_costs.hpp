@@ -0,0 +1,136 @@
+// Time-dependent step costs for cells such as doors and traffic lights. A cell may carry a
+// periodic piecewise-constant schedule of factors applied to the cost of moves into it; a move
+// that starts at time t into a cell with factor f(t) takes step * f(t). Agents may wait before
+// a move, so the arrival time of a move started no earlier than t is
+//
+//     arrival(t) = min over t' >= t of t' + step * f(t')
+//
+// which never decreases with t (FIFO: leaving later never arrives earlier). Dijkstra and A*
+// over arrival times therefore stay exact, and factors >= 1 keep the static distance
+// heuristics admissible. A factor of infinity closes the cell for that part of the period.
+//
+// Cells without a schedule cost the same at any time; when no cell has one, the search is the
+// static engine itself.
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "pathfinding.hpp"
+
+// Factor from begin (time within the period) until the next step's begin
+struct ScheduleStep
+{
+    float begin;
+    float factor;
+};
+
+struct CostSchedule
+{
+    float period;
+    std::uint32_t first, count; // Range in TimeCosts::steps, sorted by begin, the first at 0
+};
+
+struct TimeCosts
+{
+    int width = 0, height = 0;
+    std::vector<std::uint16_t> scheduleOf; // Per cell, 0 for constant cost
+    std::vector<CostSchedule> schedules;   // Index 0 is the constant schedule
+    std::vector<ScheduleStep> steps;
+    int timedCells = 0;
+
+    TimeCosts() = default;
+    explicit TimeCosts(const Grid &grid)
+        : width(grid.width), height(grid.height), scheduleOf(static_cast<std::size_t>(grid.cellCount()), 0), schedules(1, CostSchedule{1.0f, 0, 0})
+    {
+    }
+
+    bool valid(const Grid &grid) const { return width == grid.width && height == grid.height; }
+    bool empty() const { return timedCells == 0; }
+
+    // Adds a schedule and returns its id, or 0 if the schedule is not usable (no steps or a
+    // period <= 0) or 65535 schedules exist. Steps are sorted, factors below 1 are raised to 1,
+    // and if the first step begins after 0 the last one wraps around to cover the gap.
+    int addSchedule(float period, std::vector<ScheduleStep> scheduleSteps);
+
+    // Gives cell the schedule (0 makes its cost constant again); false and no change for ids
+    // addSchedule did not return
+    bool assign(int cell, int schedule);
+
+    // Earliest arrival in cell for a move of the given static cost that may start at time
+    float arrival(int cell, float time, float stepCost) const
+    {
+        const CostSchedule &schedule = schedules[scheduleOf[static_cast<std::size_t>(cell)]];
+        const ScheduleStep *first = steps.data() + schedule.first;
+        const float phase = std::fmod(time, schedule.period);
+        const float base = time - phase;
+        std::uint32_t current = 0;
+        while (current + 1 < schedule.count && first[current + 1].begin <= phase)
+            ++current;
+
+        // Start now, or wait for any later step within one period
+        float best = time + stepCost * first[current].factor;
+        for (std::uint32_t i = current + 1; i < schedule.count + current; ++i)
+        {
+            const std::uint32_t step = i % schedule.count;
+            const float begin = base + first[step].begin + (i >= schedule.count ? schedule.period : 0.0f);
+            best = std::min(best, begin + stepCost * first[step].factor);
+        }
+        return best;
+    }
+};
+
+// Cost policy for the shared engine: g is the travel time since departure, and moves into cells
+// with a schedule cost the arrival time minus the time they may start
+struct TimeDependentCosts
+{
+    const TimeCosts &costs;
+    std::array<int, 8> offsets;
+    float departure;
+
+    TimeDependentCosts(const Grid &grid, const TimeCosts &costs, float departure)
+        : costs(costs), offsets(neighborOffsets(grid.width)), departure(departure)
+    {
+    }
+
+    unsigned varying(int cell, unsigned moves) const
+    {
+        unsigned timed = 0;
+        for (; moves != 0; moves &= moves - 1)
+        {
+            const int d = __builtin_ctz(moves);
+            if (costs.scheduleOf[static_cast<std::size_t>(cell + offsets[static_cast<std::size_t>(d)])] != 0)
+                timed |= 1u << d;
+        }
+        return timed;
+    }
+
+    float cost(int next, float g, float step) const { return costs.arrival(next, departure + g, step) - departure; }
+};
+
+template <typename Movement, typename Heuristic, typename Trace = NullSearchTrace>
+SearchResult searchTimeDependentWith(const Grid &grid, const TimeCosts &costs, int start, int goal, float departure, SearchContext &context,
+                                     const Heuristic &heuristic, Trace &&trace = Trace())
+{
+    int reached;
+    return searchGridUntil<Movement>(grid, start, SingleGoal{goal}, reached, context, heuristic, NoPruning(),
+                                     TimeDependentCosts(grid, costs, departure), std::forward<Trace>(trace));
+}
+
+// Dijkstra or A* leaving start at time departure; the result's cost is the travel time. Without
+// timed cells this is searchGrid.
+template <typename Trace = NullSearchTrace>
+SearchResult searchTimeDependent(const Grid &grid, const TimeCosts &costs, Algorithm algorithm, MovementModel movement, int start, int goal,
+                                 float departure, SearchContext &context, Trace &&trace = Trace())
+{
+    if (costs.empty())
+        return searchGrid(grid, algorithm, movement, start, goal, context, std::forward<Trace>(trace));
+    return withMovement(movement, [&](auto policy)
+                        {
+                            using Movement = decltype(policy);
+                            if (algorithm == Algorithm::AStar)
+                                return searchTimeDependentWith<Movement>(grid, costs, start, goal, departure, context, typename Movement::Distance(grid, goal), trace);
+                            return searchTimeDependentWith<Movement>(grid, costs, start, goal, departure, context, ZeroHeuristic(), trace); });
+}
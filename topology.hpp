@@ -0,0 +1,252 @@
+// Cell topologies as compile-time policies, so one search loop serves square and hexagonal
+// maps with every neighbor visit inlined. A topology is built per query from the grid and
+// provides:
+//   neighbors(cell, visit)  calls visit(next, cost) for every legal move out of cell
+//   distance(from, to)      exact distance on an empty map (consistent heuristic)
+// and, statically, the geometry used for drawing, in cell units:
+//   center(x, y), corners(x, y, out) with cornerCount points, and cellAt(px, py, ...).
+//
+// Square topologies wrap the movement policies and read the grid's cached neighbor masks;
+// hexagonal maps use pointy-top hexes in odd-r offset coordinates (odd rows shifted right by
+// half a cell) over the same Grid storage, where only the meaning of the neighbors changes.
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+#include "pathfinding.hpp"
+
+struct PlanePoint
+{
+    float x, y;
+};
+
+template <typename Movement>
+struct SquareTopology
+{
+    static constexpr int cornerCount = 4;
+
+    const Grid &grid;
+    std::array<int, 8> offsets;
+
+    explicit SquareTopology(const Grid &grid) : grid(grid), offsets(neighborOffsets(grid.width)) {}
+
+    template <typename Visit>
+    void neighbors(int cell, Visit &&visit) const
+    {
+        for (unsigned moves = Movement::moves(grid.neighborMask(cell)); moves != 0; moves &= moves - 1)
+        {
+            const int d = __builtin_ctz(moves);
+            visit(cell + offsets[static_cast<std::size_t>(d)], DIRECTION_COSTS[d]);
+        }
+    }
+
+    float distance(int from, int to) const
+    {
+        return Movement::Distance::between(to % grid.width - from % grid.width, to / grid.width - from / grid.width);
+    }
+
+    static PlanePoint center(int x, int y) { return {static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f}; }
+
+    static void corners(int x, int y, PlanePoint *out)
+    {
+        out[0] = {static_cast<float>(x), static_cast<float>(y)};
+        out[1] = {static_cast<float>(x + 1), static_cast<float>(y)};
+        out[2] = {static_cast<float>(x + 1), static_cast<float>(y + 1)};
+        out[3] = {static_cast<float>(x), static_cast<float>(y + 1)};
+    }
+
+    // Cell containing the point on a width x height map; false outside the map
+    static bool cellAt(float px, float py, int width, int height, int &x, int &y)
+    {
+        x = static_cast<int>(std::floor(px));
+        y = static_cast<int>(std::floor(py));
+        return x >= 0 && x < width && y >= 0 && y < height;
+    }
+};
+
+using SquareFour = SquareTopology<FourConnected>;
+using SquareEight = SquareTopology<CornerCutting>;
+
+// Pointy-top hexes one cell wide; rows are sqrt(3) / 2 apart
+struct HexSix
+{
+    static constexpr int cornerCount = 6;
+    static constexpr float ROW_HEIGHT = 0.8660254f; // sqrt(3) / 2
+    static constexpr float RADIUS = 0.5773503f;     // Center to corner, 1 / sqrt(3)
+
+    // Neighbor offsets for even and odd rows: east, west, then the two above and the two below
+    static constexpr int DX[2][6] = {{1, -1, -1, 0, -1, 0}, {1, -1, 0, 1, 0, 1}};
+    static constexpr int DY[6] = {0, 0, -1, -1, 1, 1};
+
+    const Grid &grid;
+
+    explicit HexSix(const Grid &grid) : grid(grid) {}
+
+    template <typename Visit>
+    void neighbors(int cell, Visit &&visit) const
+    {
+        const int x = cell % grid.width, y = cell / grid.width;
+        const int *dx = DX[y & 1];
+        for (int d = 0; d < 6; ++d)
+        {
+            const int nx = x + dx[d], ny = y + DY[d];
+            if (grid.inBounds(nx, ny) && !grid.isWall(nx, ny))
+                visit(grid.cellId(nx, ny), 1.0f);
+        }
+    }
+
+    // Hex steps between the cells: offset coordinates to axial ones, then the cube distance
+    float distance(int from, int to) const
+    {
+        const int fy = from / grid.width, ty = to / grid.width;
+        const int fq = from % grid.width - (fy - (fy & 1)) / 2, tq = to % grid.width - (ty - (ty & 1)) / 2;
+        const int dq = tq - fq, dr = ty - fy;
+        return static_cast<float>((std::abs(dq) + std::abs(dr) + std::abs(dq + dr)) / 2);
+    }
+
+    static PlanePoint center(int x, int y)
+    {
+        return {static_cast<float>(x) + 0.5f + 0.5f * static_cast<float>(y & 1), static_cast<float>(y) * ROW_HEIGHT + RADIUS};
+    }
+
+    static void corners(int x, int y, PlanePoint *out)
+    {
+        const PlanePoint middle = center(x, y);
+        for (int i = 0; i < 6; ++i)
+        {
+            const float angle = (60.0f * static_cast<float>(i) - 30.0f) * 3.14159265f / 180.0f;
+            out[i] = {middle.x + RADIUS * std::cos(angle), middle.y + RADIUS * std::sin(angle)};
+        }
+    }
+
+    // Hexes are the Voronoi cells of their centers, so the nearest center among the rows around
+    // the point wins; points farther than a corner from every center are outside the map
+    static bool cellAt(float px, float py, int width, int height, int &x, int &y)
+    {
+        const int row = static_cast<int>(std::floor(py / ROW_HEIGHT));
+        float best = RADIUS * RADIUS;
+        bool found = false;
+        for (int r = row - 1; r <= row + 1; ++r)
+        {
+            const int column = static_cast<int>(std::floor(px - 0.5f * static_cast<float>(r & 1)));
+            for (int c = column - 1; c <= column + 1; ++c)
+            {
+                if (c < 0 || c >= width || r < 0 || r >= height)
+                    continue;
+                const PlanePoint middle = center(c, r);
+                const float distance = (middle.x - px) * (middle.x - px) + (middle.y - py) * (middle.y - py);
+                if (distance <= best)
+                {
+                    best = distance;
+                    x = c;
+                    y = r;
+                    found = true;
+                }
+            }
+        }
+        return found;
+    }
+};
+
+enum class GridTopology : std::uint8_t
+{
+    SquareFour = 0,
+    SquareEight = 1,
+    HexSix = 2
+};
+
+// Calls function with a null pointer to the topology type selected at runtime; topologies are
+// built from a grid, so the type is passed rather than an instance
+template <typename Function>
+auto withTopology(GridTopology topology, Function &&function)
+{
+    switch (topology)
+    {
+    case GridTopology::SquareFour:
+        return function(static_cast<SquareFour *>(nullptr));
+    case GridTopology::HexSix:
+        return function(static_cast<HexSix *>(nullptr));
+    default:
+        return function(static_cast<SquareEight *>(nullptr));
+    }
+}
+
+inline const char *topologyName(GridTopology topology)
+{
+    switch (topology)
+    {
+    case GridTopology::SquareFour:
+        return "square 4";
+    case GridTopology::HexSix:
+        return "hex 6";
+    default:
+        return "square 8";
+    }
+}
+
+// Dijkstra or A* from start to goal (cell ids) under the Topology; the tree is left in context
+// like searchGridWith, so pathLength and writePath apply
+template <typename Topology, typename Trace = NullSearchTrace>
+SearchResult searchTopology(const Grid &grid, Algorithm algorithm, int start, int goal, SearchContext &context, Trace &&trace = Trace())
+{
+    SearchResult result;
+    const Topology topology(grid);
+    const bool informed = algorithm == Algorithm::AStar;
+
+    context.begin(grid.cellCount());
+    context.set(start, 0.0f, -1);
+    context.push(informed ? topology.distance(start, goal) : 0.0f, start);
+    trace.opened(start);
+
+    while (!context.open.empty())
+    {
+        const int cell = openEntryCell(context.pop());
+        if (!context.close(cell))
+            continue;
+        const float cg = context.g[static_cast<std::size_t>(cell)];
+        ++result.expanded;
+        trace.visited(cell);
+        if (cell == goal)
+        {
+            result.found = true;
+            result.cost = cg;
+            break;
+        }
+        topology.neighbors(cell, [&](int next, float step)
+                           {
+                               const float ng = cg + step;
+                               if (ng < context.cost(next))
+                               {
+                                   context.set(next, ng, cell);
+                                   context.push(ng + (informed ? topology.distance(next, goal) : 0.0f), next);
+                                   trace.opened(next);
+                               } });
+    }
+    return result;
+}
+
+template <typename Trace = NullSearchTrace>
+SearchResult searchGridTopology(const Grid &grid, Algorithm algorithm, GridTopology topology, int start, int goal, SearchContext &context,
+                                Trace &&trace = Trace())
+{
+    return withTopology(topology, [&](auto tag)
+                        { return searchTopology<std::remove_pointer_t<decltype(tag)>>(grid, algorithm, start, goal, context, trace); });
+}
+
+// findPath under a topology: on success path holds the cell ids from start to goal inclusive
+template <typename Trace = NullSearchTrace>
+SearchResult findTopologyPath(const Grid &grid, Algorithm algorithm, GridTopology topology, int start, int goal, std::vector<int> &path,
+                              SearchContext &context, Trace &&trace = Trace())
+{
+    SearchResult result = searchGridTopology(grid, algorithm, topology, start, goal, context, std::forward<Trace>(trace));
+    path.clear();
+    if (result.found)
+    {
+        path.resize(static_cast<std::size_t>(pathLength(context, goal)));
+        writePath(context, goal, path.data(), static_cast<int>(path.size()));
+    }
+    return result;
+}
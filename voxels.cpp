@@ -0,0 +1,52 @@
+#include "voxels.hpp"
+
+const std::array<std::uint32_t, 26> VOXEL_MOVE_NEEDS = []()
+{
+    // A move needs every direction whose nonzero components are a subset of its own
+    std::array<std::uint32_t, 26> needs{};
+    auto within = [](int part, int whole)
+    { return part == 0 || part == whole; };
+    for (std::size_t d = 0; d < needs.size(); ++d)
+    {
+        for (std::size_t other = 0; other < needs.size(); ++other)
+        {
+            const VoxelOffset &a = VOXEL_DIRECTIONS[other], &b = VOXEL_DIRECTIONS[d];
+            if (within(a.x, b.x) && within(a.y, b.y) && within(a.z, b.z))
+                needs[d] |= 1u << other;
+        }
+    }
+    return needs;
+}();
+
+VoxelGrid::VoxelGrid(int width, int height, int depth)
+    : width(width), height(height), depth(depth), bricksX((width + 3) / 4), bricksY((height + 3) / 4), bricksZ((depth + 3) / 4),
+      bricks(static_cast<std::size_t>(bricksX) * static_cast<std::size_t>(bricksY) * static_cast<std::size_t>(bricksZ), ~0ull)
+{
+    for (int z = 0; z < depth; ++z)
+    {
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+                setSolid(x, y, z, false);
+        }
+    }
+}
+
+void writeVoxelPath(const VoxelGrid &grid, const VoxelContext &context, int goal, std::vector<int> &path)
+{
+    path.clear();
+    if (context.cost(goal) == std::numeric_limits<float>::max())
+        return;
+    for (int id = goal;;)
+    {
+        path.push_back(id);
+        const std::uint8_t code = context.parent(id);
+        if (code == VOXEL_START)
+            break;
+        int x, y, z;
+        grid.coordinates(id, x, y, z);
+        const VoxelOffset &offset = VOXEL_DIRECTIONS[code];
+        id = grid.voxelId(x - offset.x, y - offset.y, z - offset.z);
+    }
+    std::reverse(path.begin(), path.end());
+}
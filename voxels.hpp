@@ -0,0 +1,215 @@
+// 3D voxel maps for flying agents. Occupancy is one bit per voxel, stored in 4x4x4 bricks of
+// one 64-bit word each; voxel ids follow the bricks (brick index * 64 + position in the brick),
+// so a voxel's 26 neighbors span at most 8 words and nearby voxels share cache lines in
+// every axis, not just along rows.
+//
+// Moves follow 6-, 18- or 26-connectivity with geometric costs 1, sqrt(2) and sqrt(3). A move
+// may not cut corners: every voxel in the box it spans has to be free. The search keeps g, a
+// stamp and a 5-bit parent code (the direction of the move into the voxel) per voxel.
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "pathfinding.hpp"
+
+struct VoxelOffset
+{
+    int x, y, z;
+};
+
+// 6 face moves, then 12 edge moves, then 8 corner moves: N-connectivity uses the first N
+const std::array<VoxelOffset, 26> VOXEL_DIRECTIONS = {{{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1},
+                                                        {1, 1, 0}, {1, -1, 0}, {-1, 1, 0}, {-1, -1, 0}, {1, 0, 1}, {1, 0, -1},
+                                                        {-1, 0, 1}, {-1, 0, -1}, {0, 1, 1}, {0, 1, -1}, {0, -1, 1}, {0, -1, -1},
+                                                        {1, 1, 1}, {1, 1, -1}, {1, -1, 1}, {1, -1, -1}, {-1, 1, 1}, {-1, 1, -1},
+                                                        {-1, -1, 1}, {-1, -1, -1}}};
+
+// Per direction, the neighbors (as direction bits) that must be free for the move: the target
+// and every face and edge neighbor inside the box it spans
+extern const std::array<std::uint32_t, 26> VOXEL_MOVE_NEEDS;
+
+inline float voxelMoveCost(int direction)
+{
+    return direction < 6 ? 1.0f : direction < 18 ? DIAGONAL_COST : std::sqrt(3.0f);
+}
+
+// Parent code of the start voxel
+const std::uint8_t VOXEL_START = 31;
+
+struct VoxelGrid
+{
+    int width = 0, height = 0, depth = 0;
+    int bricksX = 0, bricksY = 0, bricksZ = 0;
+    std::vector<std::uint64_t> bricks; // Bit set = solid; the padding beyond the map is solid
+
+    VoxelGrid() = default;
+    VoxelGrid(int width, int height, int depth);
+
+    int idCount() const { return static_cast<int>(bricks.size()) * 64; }
+    std::size_t memoryBytes() const { return bricks.size() * sizeof(std::uint64_t); }
+
+    bool inBounds(int x, int y, int z) const { return x >= 0 && x < width && y >= 0 && y < height && z >= 0 && z < depth; }
+
+    int voxelId(int x, int y, int z) const
+    {
+        const int brick = ((z >> 2) * bricksY + (y >> 2)) * bricksX + (x >> 2);
+        return brick << 6 | (z & 3) << 4 | (y & 3) << 2 | (x & 3);
+    }
+
+    void coordinates(int id, int &x, int &y, int &z) const
+    {
+        const int brick = id >> 6;
+        x = (brick % bricksX) << 2 | (id & 3);
+        y = (brick / bricksX % bricksY) << 2 | (id >> 2 & 3);
+        z = (brick / bricksX / bricksY) << 2 | (id >> 4 & 3);
+    }
+
+    bool isSolid(int id) const { return bricks[static_cast<std::size_t>(id >> 6)] >> (id & 63) & 1u; }
+    bool isSolid(int x, int y, int z) const { return !inBounds(x, y, z) || isSolid(voxelId(x, y, z)); }
+
+    void setSolid(int x, int y, int z, bool solid)
+    {
+        const int id = voxelId(x, y, z);
+        std::uint64_t &word = bricks[static_cast<std::size_t>(id >> 6)];
+        word = solid ? word | 1ull << (id & 63) : word & ~(1ull << (id & 63));
+    }
+
+    // Direction bits of the first count neighbors of (x, y, z) that are inside and free
+    std::uint32_t freeNeighbors(int x, int y, int z, int count) const
+    {
+        std::uint32_t mask = 0;
+        for (int d = 0; d < count; ++d)
+        {
+            const VoxelOffset &offset = VOXEL_DIRECTIONS[static_cast<std::size_t>(d)];
+            mask |= isSolid(x + offset.x, y + offset.y, z + offset.z) ? 0u : 1u << d;
+        }
+        return mask;
+    }
+};
+
+// Connectivity policies: the number of directions used and the exact distance on an empty map
+enum class VoxelConnectivity : std::uint8_t
+{
+    Six = 6,
+    Eighteen = 18,
+    TwentySix = 26
+};
+
+struct SixConnected
+{
+    static constexpr int count = 6;
+    static float distance(int dx, int dy, int dz) { return static_cast<float>(std::abs(dx) + std::abs(dy) + std::abs(dz)); }
+};
+
+struct EighteenConnected
+{
+    static constexpr int count = 18;
+    static float distance(int dx, int dy, int dz)
+    {
+        // Each edge move covers two axes, and the longest axis can pair with the others at most
+        // as often as their sum
+        const int a = std::abs(dx), b = std::abs(dy), c = std::abs(dz);
+        const int total = a + b + c;
+        const int edges = std::min(total / 2, total - std::max({a, b, c}));
+        return static_cast<float>(edges) * DIAGONAL_COST + static_cast<float>(total - 2 * edges);
+    }
+};
+
+struct TwentySixConnected
+{
+    static constexpr int count = 26;
+    static float distance(int dx, int dy, int dz)
+    {
+        // 3D octile: corner moves along the shortest axis, edge moves along the middle one
+        int axes[3] = {std::abs(dx), std::abs(dy), std::abs(dz)};
+        std::sort(axes, axes + 3);
+        return static_cast<float>(axes[0]) * std::sqrt(3.0f) + static_cast<float>(axes[1] - axes[0]) * DIAGONAL_COST +
+               static_cast<float>(axes[2] - axes[1]);
+    }
+};
+
+template <typename Function>
+auto withConnectivity(VoxelConnectivity connectivity, Function &&function)
+{
+    switch (connectivity)
+    {
+    case VoxelConnectivity::Six:
+        return function(SixConnected());
+    case VoxelConnectivity::Eighteen:
+        return function(EighteenConnected());
+    default:
+        return function(TwentySixConnected());
+    }
+}
+
+// Search state for voxel queries, reused across queries like SearchContext: per voxel g, a
+// stamp and a 5-bit parent code packed 12 to a 64-bit word, about 8.7 bytes per voxel
+using VoxelContext = PackedParentContext<5>;
+
+// Dijkstra or A* between two voxel ids under the Connectivity policy
+template <typename Connectivity, typename Trace = NullSearchTrace>
+SearchResult searchVoxelsWith(const VoxelGrid &grid, Algorithm algorithm, int start, int goal, VoxelContext &context, Trace &&trace = Trace())
+{
+    SearchResult result;
+    int gx, gy, gz;
+    grid.coordinates(goal, gx, gy, gz);
+    const bool informed = algorithm == Algorithm::AStar;
+    auto heuristic = [&](int x, int y, int z)
+    { return informed ? Connectivity::distance(gx - x, gy - y, gz - z) : 0.0f; };
+
+    context.begin(grid.idCount());
+    int sx, sy, sz;
+    grid.coordinates(start, sx, sy, sz);
+    context.set(start, 0.0f, VOXEL_START);
+    context.push(heuristic(sx, sy, sz), start);
+    trace.opened(start);
+
+    while (!context.open.empty())
+    {
+        const int id = openEntryCell(context.pop());
+        if (!context.close(id))
+            continue;
+        const float cg = context.g[static_cast<std::size_t>(id)];
+        ++result.expanded;
+        trace.visited(id);
+        if (id == goal)
+        {
+            result.found = true;
+            result.cost = cg;
+            break;
+        }
+
+        int x, y, z;
+        grid.coordinates(id, x, y, z);
+        const std::uint32_t free = grid.freeNeighbors(x, y, z, Connectivity::count);
+        for (int d = 0; d < Connectivity::count; ++d)
+        {
+            if ((free & VOXEL_MOVE_NEEDS[static_cast<std::size_t>(d)]) != VOXEL_MOVE_NEEDS[static_cast<std::size_t>(d)])
+                continue;
+            const VoxelOffset &offset = VOXEL_DIRECTIONS[static_cast<std::size_t>(d)];
+            const int nx = x + offset.x, ny = y + offset.y, nz = z + offset.z;
+            const int next = grid.voxelId(nx, ny, nz);
+            const float ng = cg + voxelMoveCost(d);
+            if (ng < context.cost(next))
+            {
+                context.set(next, ng, static_cast<std::uint8_t>(d));
+                context.push(ng + heuristic(nx, ny, nz), next);
+                trace.opened(next);
+            }
+        }
+    }
+    return result;
+}
+
+template <typename Trace = NullSearchTrace>
+SearchResult searchVoxels(const VoxelGrid &grid, Algorithm algorithm, VoxelConnectivity connectivity, int start, int goal, VoxelContext &context,
+                          Trace &&trace = Trace())
+{
+    return withConnectivity(connectivity, [&](auto policy)
+                            { return searchVoxelsWith<decltype(policy)>(grid, algorithm, start, goal, context, trace); });
+}
+
+// Writes the voxel ids of the path to goal found by the last search, start to goal inclusive
+void writeVoxelPath(const VoxelGrid &grid, const VoxelContext &context, int goal, std::vector<int> &path);